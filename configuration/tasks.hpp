@@ -10,21 +10,53 @@ namespace configuration {
                 
         constexpr size_t max_running_tasks = 0;
         constexpr size_t max_planned_tasks = 0;
+        constexpr bool enable_work_stealing = true;
+        constexpr bool enable_metrics = true;//ready, mutex and condition wait histograms, when disabled scheduler does not read clock for them
+        constexpr size_t priority_aging_step = 20;//milliseconds, waiting task gains one priority level per step, 0 disables aging
+        namespace numa {
+            constexpr bool pin_workers = false;//each regular and binded worker pinned to own processor in round robin order
+            constexpr bool task_affinity = false;//task resumed by other thread queued to worker that executed it last time
+            constexpr size_t max_nodes = 8;//compile time only, stacks pooled per node, higher nodes share last pool
+            constexpr bool node_local_stacks = true;//compile time only, stacks memory prefers node of allocating thread
+        }
+        namespace blocking {
+            constexpr size_t stuck_threshold = 100;//milliseconds, worker executing one task longer counted as blocked by executor manager, 0 disables detection
+            constexpr size_t max_compensating_workers = 256;//compile time only, limit of workers started in place of blocked ones
+        }
         namespace light_stack {
             constexpr size_t inital_buffer_size = 1;//compile time only
             constexpr bool flush_used_stacks = false;
-            constexpr size_t max_buffer_size = 20;//0 for unlimited, -1 for disabled
+            constexpr size_t max_buffer_size = 20;//0 for unlimited, -1 for disabled, applied to each size class of each numa node
+            constexpr size_t size_classes[] = {16384, 65536, 262144, 1048576};//compile time only, each class has own buffer
+            constexpr size_t default_size = 1048576;//compile time only, used when function has no stack hint
+            constexpr size_t max_growable_stacks = 65536;//compile time only, linux, live stacks that commit pages on demand, stacks created above limit committed whole
+            constexpr size_t recycle_keep_size = 65536;//compile time only, committed bytes kept by stack returned to buffer, deeper pages released
+            constexpr bool learn_stack_size = false;//select class by recorded stack usage of function
+            constexpr size_t learn_margin = 2;//compile time only, recorded usage multiplied by this, class selected for result
+            constexpr size_t learn_min_headroom = 16384;//compile time only, bytes always left above recorded usage, for small usage where margin gives few pages
 
             static_assert(inital_buffer_size <= max_buffer_size || !max_buffer_size, "inital_buffer_size must be less or equal max_buffer_size");
         }
+        namespace task_pool {
+            constexpr bool enable = true;//compile time only
+            constexpr size_t thread_cache_size = 256;//compile time only, blocks kept by each thread
+            constexpr size_t depot_size = 8192;//compile time only, blocks shared between threads
+        }
     }
 }
 
 #define _configuration_tasks_enable_task_naming_modifable true
 #define _configuration_tasks_max_running_tasks_modifable true
 #define _configuration_tasks_max_planned_tasks_modifable true
+#define _configuration_tasks_enable_work_stealing_modifable true
+#define _configuration_tasks_priority_aging_step_modifable true
+#define _configuration_tasks_numa_pin_workers_modifable true
+#define _configuration_tasks_numa_task_affinity_modifable true
+#define _configuration_tasks_blocking_stuck_threshold_modifable true
+#define _configuration_tasks_enable_metrics_modifable true
 #define _configuration_tasks_light_stack_flush_used_stacks_modifable false
 #define _configuration_tasks_light_stack_max_buffer_size_modifable true
+#define _configuration_tasks_light_stack_learn_stack_size_modifable true
 
 #define _configuration_tasks_enable_debug_mode true
 #endif /* CONFIGURATION_TASKS */
@@ -393,6 +393,8 @@ bool need_restore_stack_fault() {
 #else
 #include <unistd.h>
 size_t page_size = sysconf(_SC_PAGESIZE);
+unsigned long fault_reserved_stack_size = 0;
+unsigned long fault_reserved_pages = 0;
 
 
 
@@ -518,6 +520,70 @@ void modify_run_time_config(const std::string& name, const std::string& value){
 		}
 #else
 		throw AttachARuntimeException("max_planned_tasks is not modifable");
+#endif
+	}else if(name == "enable_work_stealing"){
+#if _configuration_tasks_enable_work_stealing_modifable
+		if(value == "true" || value == "1")
+			Task::enable_work_stealing = true;
+		else if(value == "false" || value == "0")
+			Task::enable_work_stealing = false;
+		else
+			throw InvalidArguments("unrecognized value for enable_work_stealing");
+#else
+		throw AttachARuntimeException("enable_work_stealing is not modifable");
+#endif
+	}else if(name == "priority_aging_step"){
+#if _configuration_tasks_priority_aging_step_modifable
+		try{
+			Task::priority_aging_step = std::stoull(value);
+		}catch(...){
+			throw InvalidArguments("unrecognized value for priority_aging_step");
+		}
+#else
+		throw AttachARuntimeException("priority_aging_step is not modifable");
+#endif
+	}else if(name == "numa_pin_workers"){
+#if _configuration_tasks_numa_pin_workers_modifable
+		if(value == "true" || value == "1")
+			Task::pin_workers = true;
+		else if(value == "false" || value == "0")
+			Task::pin_workers = false;
+		else
+			throw InvalidArguments("unrecognized value for numa_pin_workers");
+#else
+		throw AttachARuntimeException("numa_pin_workers is not modifable");
+#endif
+	}else if(name == "numa_task_affinity"){
+#if _configuration_tasks_numa_task_affinity_modifable
+		if(value == "true" || value == "1")
+			Task::enable_task_affinity = true;
+		else if(value == "false" || value == "0")
+			Task::enable_task_affinity = false;
+		else
+			throw InvalidArguments("unrecognized value for numa_task_affinity");
+#else
+		throw AttachARuntimeException("numa_task_affinity is not modifable");
+#endif
+	}else if(name == "blocking_stuck_threshold"){
+#if _configuration_tasks_blocking_stuck_threshold_modifable
+		try{
+			Task::blocking_stuck_threshold = std::stoull(value);
+		}catch(...){
+			throw InvalidArguments("unrecognized value for blocking_stuck_threshold");
+		}
+#else
+		throw AttachARuntimeException("blocking_stuck_threshold is not modifable");
+#endif
+	}else if(name == "enable_metrics"){
+#if _configuration_tasks_enable_metrics_modifable
+		if(value == "true" || value == "1")
+			Task::enable_metrics = true;
+		else if(value == "false" || value == "0")
+			Task::enable_metrics = false;
+		else
+			throw InvalidArguments("unrecognized value for enable_metrics");
+#else
+		throw AttachARuntimeException("enable_metrics is not modifable");
 #endif
 	}else if(name == "light_stack_max_buffer_size"){
 #if _configuration_tasks_light_stack_max_buffer_size_modifable
@@ -543,6 +609,17 @@ void modify_run_time_config(const std::string& name, const std::string& value){
 			throw InvalidArguments("unrecognized value for light_stack_flush_used_stacks");
 #else
 		throw AttachARuntimeException("light_stack_flush_used_stacks is not modifable");
+#endif
+	}else if(name == "light_stack_learn_stack_size"){
+#if _configuration_tasks_light_stack_learn_stack_size_modifable
+		if(value == "true" || value == "1")
+			light_stack::learn_stack_size = true;
+		else if(value == "false" || value == "0")
+			light_stack::learn_stack_size = false;
+		else
+			throw InvalidArguments("unrecognized value for light_stack_learn_stack_size");
+#else
+		throw AttachARuntimeException("light_stack_learn_stack_size is not modifable");
 #endif
 	}else{
 		if(value.empty())
@@ -569,10 +646,24 @@ std::string get_run_time_config(const std::string& name){
 		return std::to_string(Task::max_running_tasks);
 	else if(name == "max_planned_tasks")
 		return std::to_string(Task::max_planned_tasks);
+	else if(name == "enable_work_stealing")
+		return Task::enable_work_stealing ? "true" : "false";
+	else if(name == "priority_aging_step")
+		return std::to_string(Task::priority_aging_step);
+	else if(name == "numa_pin_workers")
+		return Task::pin_workers ? "true" : "false";
+	else if(name == "numa_task_affinity")
+		return Task::enable_task_affinity ? "true" : "false";
+	else if(name == "blocking_stuck_threshold")
+		return std::to_string(Task::blocking_stuck_threshold);
+	else if(name == "enable_metrics")
+		return Task::enable_metrics ? "true" : "false";
 	else if(name == "light_stack_max_buffer_size")
 		return std::to_string(light_stack::max_buffer_size);
 	else if(name == "light_stack_flush_used_stacks")
 		return light_stack::flush_used_stacks ? "true" : "false";
+	else if(name == "light_stack_learn_stack_size")
+		return light_stack::learn_stack_size ? "true" : "false";
 	else{
 		auto it = run_time_configuration.find(name);
 		if(it == run_time_configuration.end())
@@ -280,17 +280,9 @@ EXCEPTION_DISPOSITION handle_s(
 }
 
 void* __casm_test_handle = (void*)handle_s;
-void* FrameResult::init(uint8_t*& frame,CodeHolder* code, asmjit::JitRuntime& runtime, const char* symbol_name, const char* file_path) {
-	std::vector<uint16_t> unwindInfo = convert(*this);
+//unwind info placed right after code, allocation must have space for it
+void* register_frame(FrameResult& res, uint8_t*& frame, uint8_t* baseaddr, size_t fun_size, const std::vector<uint16_t>& unwindInfo, asmjit::JitRuntime& runtime, const char* symbol_name, const char* file_path) {
 	size_t unwindInfoSize = unwindInfo.size() * sizeof(uint16_t);
-
-	uint8_t* baseaddr;
-	size_t fun_size = alocate_and_prepare_code(baseaddr, code, runtime.allocator(), unwindInfoSize + sizeof(RUNTIME_FUNCTION));
-	if(!baseaddr){
-		const char* err = asmjit::DebugUtils::errorAsString(asmjit::Error(fun_size));
-		throw CompileTimeException(err);
-	}
-	
 	uint8_t* startaddr = baseaddr;
 	uint8_t* unwindptr = baseaddr + (((fun_size + 15) >> 4) << 4);
 	memcpy(unwindptr, unwindInfo.data(), unwindInfoSize);
@@ -298,7 +290,7 @@ void* FrameResult::init(uint8_t*& frame,CodeHolder* code, asmjit::JitRuntime& ru
 	RUNTIME_FUNCTION* table = (RUNTIME_FUNCTION*)(unwindptr + unwindInfoSize);
 	frame = (uint8_t*)table;
 	table[0].BeginAddress = (DWORD)(ptrdiff_t)(startaddr - baseaddr);
-	table[0].EndAddress = (DWORD)(ptrdiff_t)(use_handle ? exHandleOff : fun_size);
+	table[0].EndAddress = (DWORD)(ptrdiff_t)(res.use_handle ? res.exHandleOff : fun_size);
 	table[0].UnwindData = (DWORD)(ptrdiff_t)(unwindptr - baseaddr);
 	BOOLEAN result = RtlAddFunctionTable(table, 1, (DWORD64)baseaddr);
 
@@ -312,6 +304,30 @@ void* FrameResult::init(uint8_t*& frame,CodeHolder* code, asmjit::JitRuntime& ru
 	tmp.file = file_path;
 	return baseaddr;
 }
+void* FrameResult::init(uint8_t*& frame,CodeHolder* code, asmjit::JitRuntime& runtime, const char* symbol_name, const char* file_path) {
+	std::vector<uint16_t> unwindInfo = convert(*this);
+	size_t unwindInfoSize = unwindInfo.size() * sizeof(uint16_t);
+
+	uint8_t* baseaddr;
+	size_t fun_size = alocate_and_prepare_code(baseaddr, code, runtime.allocator(), unwindInfoSize + 16 + sizeof(RUNTIME_FUNCTION));
+	if(!baseaddr){
+		const char* err = asmjit::DebugUtils::errorAsString(asmjit::Error(fun_size));
+		throw CompileTimeException(err);
+	}
+	return register_frame(*this, frame, baseaddr, fun_size, unwindInfo, runtime, symbol_name, file_path);
+}
+void* FrameResult::init(uint8_t*& frame, const std::vector<uint8_t>& image, const std::vector<std::pair<size_t, const void*>>& slots, asmjit::JitRuntime& runtime, const char* symbol_name, const char* file_path) {
+	std::vector<uint16_t> unwindInfo = convert(*this);
+	size_t unwindInfoSize = unwindInfo.size() * sizeof(uint16_t);
+
+	uint8_t* rx;
+	uint8_t* rw;
+	CONV_ASMJIT(runtime.allocator()->alloc((void**)&rx, (void**)&rw, image.size() + unwindInfoSize + 16 + sizeof(RUNTIME_FUNCTION)));
+	memcpy(rw, image.data(), image.size());
+	for (auto& [offset, address] : slots)
+		memcpy(rw + offset, &address, sizeof(address));
+	return register_frame(*this, frame, rx, image.size(), unwindInfo, runtime, symbol_name, file_path);
+}
 bool FrameResult::deinit(uint8_t* frame, void* funct, asmjit::JitRuntime& runtime){
 	if (frame) {
 		BOOLEAN result = RtlDeleteFunctionTable((RUNTIME_FUNCTION*)frame);
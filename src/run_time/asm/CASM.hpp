@@ -195,8 +195,30 @@ class CASM {
 	asmjit::Section* text;
 	asmjit::Section* data = nullptr;
 	casm_stack_align_check_v;
+	std::unordered_map<const void*, asmjit::Label> helper_labels;
+	//values in this range can be heap or module address, they would be invalid in other process
+	void track_imm(uint64_t value) {
+		if (value >= 0x10000 && value < 0x800000000000)
+			relocatable = false;
+	}
+	void track_imm(const asmjit::Imm& value) {
+		track_imm(uint64_t(value.value()));
+	}
+	asmjit::Label helper_slot(const void* target) {
+		auto& label = helper_labels[target];
+		if (!label.isValid()) {
+			label = add_data((char*)&target, sizeof(target));
+			helper_slots.push_back({ label, target });
+		}
+		return label;
+	}
 public:
 	bool resr_used = false;
+	//code would be stored in persistent cache, calls of runtime helpers go through data slots patched on load
+	bool relocatable_mode = false;
+	//false when code embeds address that can not be patched, like pointer to constant
+	bool relocatable = true;
+	std::vector<std::pair<asmjit::Label, const void*>> helper_slots;
 	CASM(asmjit::CodeHolder& holder) :a(&holder) {
 		text = holder.textSection();
 		Error err = holder.newSection(&data, ".data",SIZE_MAX, asmjit::SectionFlags::kNone, 8);
@@ -483,6 +505,7 @@ public:
 #pragma endregion
 #pragma region mov reg imm
 	void mov(creg128 res, const asmjit::Imm& set) {
+		track_imm(set);
 		if (resr_used)
 			a.push(resr);
 
@@ -496,6 +519,7 @@ public:
 	void mov(creg res, const asmjit::Imm& set) {
 		if (res.isVec())
 			throw CompileTimeException("Invalid operation");
+		track_imm(set);
 		a.mov(res, set);
 	}
 #pragma endregion
@@ -515,6 +539,9 @@ public:
 	void mov_vector(creg128 res, creg64 get, int32_t get_off) {
 		a.movdqu(res, asmjit::x86::ptr_128(get, get_off));
 	}
+	void mov_double(creg128 res, creg64 get, int32_t get_off) {
+		a.movsd(res, asmjit::x86::ptr_64(get, get_off));
+	}
 	void mov_default(creg res, creg64 get, int32_t get_off, uint32_t v_siz) {
 		a.mov(res, asmjit::x86::ptr(get, get_off, v_siz));
 	}
@@ -581,6 +608,9 @@ public:
 	void mov(creg64 res, int32_t res_off, creg128 set) {
 		a.movdqu(asmjit::x86::ptr(res, res_off, 16), set);
 	}
+	void mov_double(creg64 res, int32_t res_off, creg128 set) {
+		a.movsd(asmjit::x86::ptr_64(res, res_off), set);
+	}
 	void mov(creg64 res, int32_t res_off, creg64 set) {
 		a.mov(asmjit::x86::ptr(res, res_off, 8), set);
 	}
@@ -597,6 +627,7 @@ public:
 		a.mov(asmjit::x86::ptr(res, res_off, set_size), set);
 	}
 	void mov(creg64 res, int32_t res_off, int32_t set_size, const asmjit::Imm& set) {
+		track_imm(set);
 		a.mov(asmjit::x86::ptr(res, res_off, set_size), set);
 	}
 #pragma endregion
@@ -669,9 +700,11 @@ public:
 	void test(creg reg, const asmjit::Imm& v) {
 		if (reg.isVec())
 			throw CompileTimeException("Invalid operation");
+		track_imm(v);
 		a.test(reg, v);
 	}
 	void test(creg64 res, int32_t res_off, int32_t vsize, const asmjit::Imm& v) {
+		track_imm(v);
 		a.test(asmjit::x86::ptr(res, res_off, vsize), v);
 	}
 
@@ -690,9 +723,11 @@ public:
 	void cmp(creg reg, const asmjit::Imm& v) {
 		if (reg.isVec())
 			throw CompileTimeException("Invalid operation");
+		track_imm(v);
 		a.cmp(reg, v);
 	}
 	void cmp(creg64 res, int32_t res_off, int32_t set_size, const asmjit::Imm& set) {
+		track_imm(set);
 		a.cmp(asmjit::x86::ptr(res, res_off, set_size), set);
 	}
 
@@ -708,6 +743,7 @@ public:
 	}
 
 	void push(const asmjit::Imm& val) {
+		track_imm(val);
 		casm_stack_align_check_add(8);
 		a.push(val);
 	}
@@ -731,10 +767,20 @@ public:
 	template<class FUNC>
 	void call(FUNC fun) {
 		casm_stack_align_check;
-		a.call((*(void**)(&fun)));
+		if (relocatable_mode)
+			a.call(asmjit::x86::qword_ptr(helper_slot(*(void**)(&fun))));
+		else
+			a.call((*(void**)(&fun)));
+	}
+	void call(creg64 fun) {
+		casm_stack_align_check;
+		a.call(fun);
 	}
 	void jmp(const asmjit::Imm& pos) {
-		a.jmp(pos);
+		if (relocatable_mode)
+			a.jmp(asmjit::x86::qword_ptr(helper_slot((const void*)(uintptr_t)pos.value())));
+		else
+			a.jmp(pos);
 	}
 	void jmp(creg64 pos) {
 		a.jmp(pos);
@@ -842,9 +888,11 @@ public:
 		a.xor_(res, asmjit::x86::ptr_64(base, off));
 	}
 	void xor_(creg res, const asmjit::Imm& v) {
+		track_imm(v);
 		a.xor_(res, v);
 	}
 	void xor_(creg64 res, int32_t res_off, int32_t vsize, const asmjit::Imm& v) {
+		track_imm(v);
 		a.xor_(asmjit::x86::ptr(res, res_off, vsize), v);
 	}
 
@@ -877,9 +925,11 @@ public:
 		a.or_(res, asmjit::x86::ptr_64(base, off));
 	}
 	void or_(creg res, const asmjit::Imm& v) {
+		track_imm(v);
 		a.or_(res, v);
 	}
 	void or_(creg64 res, int32_t res_off, int32_t vsize, const asmjit::Imm& v) {
+		track_imm(v);
 		a.or_(asmjit::x86::ptr(res, res_off, vsize), v);
 	}
 
@@ -913,9 +963,11 @@ public:
 		a.and_(res, asmjit::x86::ptr_64(res, off));
 	}
 	void and_(creg res, const asmjit::Imm& v) {
+		track_imm(v);
 		a.and_(res, v);
 	}
 	void and_(creg64 res, int32_t res_off, int32_t vsize, const asmjit::Imm& v) {
+		track_imm(v);
 		a.and_(asmjit::x86::ptr(res, res_off, vsize), v);
 	}
 
@@ -967,12 +1019,14 @@ public:
 		a.sub(res, val);
 	}
 	void sub(creg res, uint64_t val) {
+		track_imm(val);
 		a.sub(res, val);
 	}
 	void sub(creg64 res, int32_t off, creg val, uint8_t vsize = 0) {
 		a.sub(asmjit::x86::ptr(res, off, vsize), val);
 	}
 	void sub(creg64 res, int32_t off, uint64_t val, uint8_t vsize = 0) {
+		track_imm(val);
 		a.sub(asmjit::x86::ptr(res, off, vsize), val);
 	}
 
@@ -984,12 +1038,14 @@ public:
 		a.add(res, val);
 	}
 	void add(creg res, uint64_t val) {
+		track_imm(val);
 		a.add(res, val);
 	}
 	void add(creg64 res, int32_t off, creg val, uint8_t vsize = 0) {
 		a.add(asmjit::x86::ptr(res, off, vsize), val);
 	}
 	void add(creg64 res, int32_t off, uint64_t val, uint8_t vsize = 0) {
+		track_imm(val);
 		a.add(asmjit::x86::ptr(res, off, vsize), val);
 	}
 
@@ -999,6 +1055,9 @@ public:
 	void imul(creg res, creg val, creg val2) {
 		a.imul(res, val, val2);
 	}
+	void imul(creg res, creg val) {
+		a.imul(res, val);
+	}
 	void div(creg res, creg val, creg val2) {
 		a.div(res, val, val2);
 	}
@@ -1010,6 +1069,19 @@ public:
 	void add(creg res, creg64 val, int32_t off, uint8_t vsize = 0) {
 		a.add(asmjit::x86::ptr(res, off, vsize), val);
 	}
+
+	void add_double(creg128 res, creg64 get, int32_t get_off) {
+		a.addsd(res, asmjit::x86::ptr_64(get, get_off));
+	}
+	void sub_double(creg128 res, creg64 get, int32_t get_off) {
+		a.subsd(res, asmjit::x86::ptr_64(get, get_off));
+	}
+	void mul_double(creg128 res, creg64 get, int32_t get_off) {
+		a.mulsd(res, asmjit::x86::ptr_64(get, get_off));
+	}
+	void div_double(creg128 res, creg64 get, int32_t get_off) {
+		a.divsd(res, asmjit::x86::ptr_64(get, get_off));
+	}
 	void insertNative(uint8_t* opcodes,uint32_t len){
 		a.embed(opcodes, len);
 	}
@@ -1135,6 +1207,8 @@ struct FrameResult {
 
 	//return uwind_info_ptr
 	void* init(uint8_t*& frame, CodeHolder* code, asmjit::JitRuntime& runtime, const char* symbol_name="AttachA unnamed_symbol", const char* file_path ="");
+	//installs code image without relocations, slots are offsets in image that receive absolute addresses
+	void* init(uint8_t*& frame, const std::vector<uint8_t>& image, const std::vector<std::pair<size_t, const void*>>& slots, asmjit::JitRuntime& runtime, const char* symbol_name="AttachA unnamed_symbol", const char* file_path ="");
 	static bool deinit(uint8_t* frame, void* funct, asmjit::JitRuntime& runtime);
 	static std::vector<void*> JitCaptureStackChainTrace(uint32_t framesToSkip = 0, bool includeNativeFrames = true, uint32_t max_frames = 32);
 	static std::vector<StackTraceItem> JitCaptureStackTrace(uint32_t framesToSkip = 0, bool includeNativeFrames = true, uint32_t max_frames = 32);
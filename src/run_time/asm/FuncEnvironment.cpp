@@ -8,6 +8,7 @@
 #include "../../run_time.hpp"
 #include "../attacha_abi.hpp"
 #include "CASM.hpp"
+#include "code_cache.hpp"
 #include "../tools.hpp"
 #include "../AttachA_CXX.hpp"
 #include "../tasks.hpp"
@@ -18,15 +19,113 @@
 
 using namespace run_time;
 asmjit::JitRuntime jrt;
-std::unordered_map<std::string, typed_lgr<FuncEnvironment>> enviropments;
-TaskMutex enviropments_lock;
+//symbols split to shards by name hash, so readers and reloads of different symbols never share lock
+//reverse index maps function to symbol name, used to name jit frames without scanning all symbols
+class symbol_table {
+	static constexpr size_t shards_count = 64;
+	struct shard {
+		art::rw_mutex lock;
+		std::unordered_map<std::string, typed_lgr<FuncEnvironment>> symbols;
+		std::unordered_map<std::string, FuncSymbolCell*> cells;//never freed, jit code holds them
+	};
+	struct reverse_shard {
+		art::rw_mutex lock;
+		std::unordered_map<FuncEnvironment*, std::string> names;
+	};
+	shard shards[shards_count];
+	reverse_shard reverse[shards_count];
+
+	shard& shard_of(const std::string& name) {
+		return shards[std::hash<std::string>()(name) % shards_count];
+	}
+	reverse_shard& reverse_of(FuncEnvironment* fn) {
+		return reverse[(size_t(fn) >> 4) % shards_count];
+	}
+	void index(const std::string& name, FuncEnvironment* fn) {
+		auto& rev = reverse_of(fn);
+		art::lock_guard guard(rev.lock);
+		rev.names[fn] = name;
+	}
+	//function can be loaded under several names, index keeps last one
+	void unindex(const std::string& name, FuncEnvironment* fn) {
+		auto& rev = reverse_of(fn);
+		art::lock_guard guard(rev.lock);
+		auto it = rev.names.find(fn);
+		if (it != rev.names.end() && it->second == name)
+			rev.names.erase(it);
+	}
+public:
+	typed_lgr<FuncEnvironment> find(const std::string& name) {
+		auto& sh = shard_of(name);
+		art::shared_lock guard(sh.lock);
+		auto it = sh.symbols.find(name);
+		return it != sh.symbols.end() ? it->second : nullptr;
+	}
+	bool contains(const std::string& name) {
+		auto& sh = shard_of(name);
+		art::shared_lock guard(sh.lock);
+		return sh.symbols.contains(name);
+	}
+	//modify receives current function of symbol or nullptr, leaving nullptr removes symbol
+	//runs under shard lock, so check and replace are atomic and symbol cell always follows table
+	template<class F>
+	void modify(const std::string& name, F&& modify) {
+		typed_lgr<FuncEnvironment> old;//released after lock, destructor can be heavy
+		auto& sh = shard_of(name);
+		art::lock_guard guard(sh.lock);
+		auto it = sh.symbols.find(name);
+		if (it != sh.symbols.end())
+			old = it->second;
+		typed_lgr<FuncEnvironment> slot = old;
+		modify(slot);
+		if (slot.getPtr() == old.getPtr())
+			return;
+		if (slot)
+			sh.symbols[name] = slot;
+		else
+			sh.symbols.erase(name);
+		if (old)
+			unindex(name, old.getPtr());
+		if (slot)
+			index(name, slot.getPtr());
+		auto cell = sh.cells.find(name);
+		if (cell != sh.cells.end())
+			cell->second->set(slot);
+	}
+	FuncSymbolCell* cell(const std::string& name) {
+		auto& sh = shard_of(name);
+		art::lock_guard guard(sh.lock);
+		auto& res = sh.cells[name];
+		if (!res) {
+			res = new FuncSymbolCell();
+			auto it = sh.symbols.find(name);
+			if (it != sh.symbols.end())
+				res->set(it->second);
+		}
+		return res;
+	}
+	list_array<typed_lgr<FuncEnvironment>> all() {
+		list_array<typed_lgr<FuncEnvironment>> res;
+		for (auto& sh : shards) {
+			art::shared_lock guard(sh.lock);
+			for (auto& it : sh.symbols)
+				res.push_back(it.second);
+		}
+		return res;
+	}
+	//empty string when function not loaded as symbol
+	std::string name_of(FuncEnvironment* fn) {
+		auto& rev = reverse_of(fn);
+		art::shared_lock guard(rev.lock);
+		auto it = rev.names.find(fn);
+		return it != rev.names.end() ? it->second : std::string();
+	}
+} enviropments;
 
 
-const char* try_resolve_frame(FuncEnvironment* env){
-	for(auto& it : enviropments)
-		if(it.second.getPtr() == env)
-			return it.first.data();
-	return "unresolved_attach_a_symbol";
+std::string try_resolve_frame(FuncEnvironment* env){
+	std::string res = enviropments.name_of(env);
+	return res.empty() ? "unresolved_attach_a_symbol" : res;
 }
 
 FuncEnvironment::~FuncEnvironment() {
@@ -148,16 +247,39 @@ void compilerFabric_call(CASM& a, const std::vector<uint8_t>& data, size_t data_
 		std::string fnn = readString(data, data_len, i);
 		typed_lgr<FuncEnvironment> fn = FuncEnvironment::enviropment(fnn);
 		if (fn->canBeUnloaded() || flags.async_mode) {
-			values.push_back(fnn);
-			b.addArg(((std::string*)values.back().val)->c_str());
+			b.addArg(FuncEnvironment::symbolCell(fnn));
 			b.addArg(arg_ptr);
 			b.addArg(arg_len_32);
 			b.addArg(flags.async_mode);
-			b.finalize(&FuncEnvironment::callFunc);
+			b.finalize(&FuncEnvironment::callCell);
 		}
 		else {
 			switch (fn->type()) {
 			case FuncEnvironment::FuncType::own: {
+				if (!fn->compiled()) {
+					//callee code not exists yet, call site reads entry slot and switches to direct call when background queue sets it
+					FuncEnvironment::enqueueCompile(fn);
+					Label not_compiled = a.newLabel();
+					Label called = a.newLabel();
+					a.mov(resr, (uint64_t)fn->entrySlot());
+					a.mov_long(resr, resr, 0);
+					a.test(resr, resr);
+					a.jmp_zero(not_compiled);
+					{
+						BuildCall direct(a, 0);
+						direct.addArg(arg_ptr);
+						direct.addArg(arg_len_32);
+						direct.finalize(resr);
+					}
+					a.jmp(called);
+					a.label_bind(not_compiled);
+					b.addArg(fn.getPtr());
+					b.addArg(arg_ptr);
+					b.addArg(arg_len_32);
+					b.finalize(&FuncEnvironment::syncWrapper);
+					a.label_bind(called);
+					break;
+				}
 				b.addArg(arg_ptr);
 				b.addArg(arg_len_32);
 				b.finalize(fn->get_func_ptr());
@@ -1786,29 +1908,85 @@ struct CompilerFabric{
 	}
 #pragma endregion
 #pragma region dynamic math
-	void dynamic_sum(){
+	enum class inline_math { sum, minus, mul, div };
+	//low meta word is vtype | use_gc << 8 | allow_edit << 9 | as_ref << 10
+	static constexpr uint16_t meta_guard_mask = 0x5FF;
+	static constexpr uint16_t meta_allow_edit = 0x200;
+	void inline_integer(inline_math op, creg res, creg val) {
+		switch (op) {
+		case inline_math::sum: a.add(res, val); break;
+		case inline_math::minus: a.sub(res, val); break;
+		case inline_math::mul: a.imul(res, val); break;
+		default: break;
+		}
+	}
+	//same typed i32, i64 and doub values calculated inline, other types, references and gc values go to helper
+	//integer division stays in helper, it keeps helper behavior on zero divisor
+	void dynamic_math(inline_math op, void(*helper)(void**, void**)) {
+		ValueIndexPos val0 = readIndexPos(data, data_len, i);
+		ValueIndexPos val1 = readIndexPos(data, data_len, i);
+		Label fallback = a.newLabel();
+		Label done = a.newLabel();
+		a.lea_valindex({static_map, values}, val0, argr0);
+		a.lea_valindex({static_map, values}, val1, argr1);
+		//helper throws when second value is not editable, guard requires it
+		a.mov_short(resr_16, argr0, 8);
+		a.and_(resr_16, meta_guard_mask);
+		a.mov_short(argr2_16, argr1, 8);
+		a.and_(argr2_16, meta_guard_mask | meta_allow_edit);
+		a.xor_(argr2_16, meta_allow_edit);
+		a.cmp(resr_16, argr2_16);
+		a.jmp_not_equal(fallback);
+		if (op != inline_math::div) {
+			Label not_i64 = a.newLabel();
+			Label not_i32 = a.newLabel();
+			a.cmp(resr_16, uint16_t(VType::i64));
+			a.jmp_not_equal(not_i64);
+			a.mov_long(resr, argr0, 0);
+			a.mov_long(argr2, argr1, 0);
+			inline_integer(op, resr, argr2);
+			a.mov(argr0, 0, resr);
+			a.jmp(done);
+			a.label_bind(not_i64);
+			a.cmp(resr_16, uint16_t(VType::i32));
+			a.jmp_not_equal(not_i32);
+			a.mov_int(resr_32, argr0, 0);
+			a.mov_int(argr2_32, argr1, 0);
+			inline_integer(op, resr_32, argr2_32);
+			a.mov(argr0, 0, resr_32);
+			a.jmp(done);
+			a.label_bind(not_i32);
+		}
+		a.cmp(resr_16, uint16_t(VType::doub));
+		a.jmp_not_equal(fallback);
+		a.mov_double(vec0, argr0, 0);
+		switch (op) {
+		case inline_math::sum: a.add_double(vec0, argr1, 0); break;
+		case inline_math::minus: a.sub_double(vec0, argr1, 0); break;
+		case inline_math::mul: a.mul_double(vec0, argr1, 0); break;
+		case inline_math::div: a.div_double(vec0, argr1, 0); break;
+		}
+		a.mov_double(argr0, 0, vec0);
+		a.jmp(done);
+
+		a.label_bind(fallback);
 		BuildCall b(a, 2);
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
-		b.finalize(DynSum);
+		b.lea_valindex({static_map, values}, val0);
+		b.lea_valindex({static_map, values}, val1);
+		b.finalize(helper);
+		a.label_bind(done);
+	}
+	void dynamic_sum(){
+		dynamic_math(inline_math::sum, DynSum);
 	}
 	void dynamic_minus(){
-		BuildCall b(a, 2);
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
-		b.finalize(DynMinus);
+		dynamic_math(inline_math::minus, DynMinus);
 	}
 	void dynamic_div(){
-		BuildCall b(a, 2);
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
-		b.finalize(DynDiv);
+		dynamic_math(inline_math::div, DynDiv);
 	}
 	void dynamic_mul(){
-		BuildCall b(a, 2);
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
-		b.finalize(DynMul);
+		dynamic_math(inline_math::mul, DynMul);
 	}
 	void dynamic_rest(){
 		BuildCall b(a, 2);
@@ -1861,17 +2039,48 @@ struct CompilerFabric{
 		a.xor_(resr_8h, RFLAGS::bit::zero & RFLAGS::bit::carry);
 		a.store_flag8h();
 	}
+	//two i64 values compared inline, result flags same as from compare helper
 	void dynamic_compare(){
+		ValueIndexPos val0 = readIndexPos(data, data_len, i);
+		ValueIndexPos val1 = readIndexPos(data, data_len, i);
+		Label fallback = a.newLabel();
+		Label done = a.newLabel();
+		//helper overwrites all arithmetic flags, so guard can change them
+		a.lea_valindex({static_map, values}, val0, argr0);
+		a.lea_valindex({static_map, values}, val1, argr1);
+		a.mov_short(resr_16, argr0, 8);
+		a.and_(resr_16, meta_guard_mask);
+		a.cmp(resr_16, uint16_t(VType::i64));
+		a.jmp_not_equal(fallback);
+		a.mov_short(resr_16, argr1, 8);
+		a.and_(resr_16, meta_guard_mask);
+		a.cmp(resr_16, uint16_t(VType::i64));
+		a.jmp_not_equal(fallback);
+		//flipped sign bit makes unsigned compare signed, carry is set for lower value
+		a.mov(argr3, 0x8000000000000000ull);
+		a.mov_long(resr, argr0, 0);
+		a.mov_long(argr2, argr1, 0);
+		a.xor_(resr, argr3);
+		a.xor_(argr2, argr3);
+		a.cmp(resr, argr2);
 		a.push_flags();
-		a.pop(argr0_16);
+		a.pop(resr_16);
+		a.and_(resr_16, uint16_t(~(RFLAGS::bit::parity | RFLAGS::bit::auxiliary_carry | RFLAGS::bit::sign_f | RFLAGS::bit::overflow)));
+		a.push(resr_16);
+		a.pop_flags();
+		a.jmp(done);
 
+		a.label_bind(fallback);
+		a.push_flags();
+		a.pop(argr0_16);
 		BuildCall b(a, 3);
 		b.addArg(argr0_16);
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
-		b.lea_valindex({static_map, values}, readIndexPos(data, data_len, i));
+		b.lea_valindex({static_map, values}, val0);
+		b.lea_valindex({static_map, values}, val1);
 		b.finalize(compare);
 		a.push(resr_16);
 		a.pop_flags();
+		a.label_bind(done);
 	}
 	void dynamic_jump(){
 		auto& label = resolve_label(readData<uint64_t>(data, data_len, i));
@@ -3205,10 +3414,143 @@ public:
 	}
 };
 
+#ifdef _WIN64
+//statics, local functions and run time computable values are bound to this environment
+bool can_be_cached(const std::vector<uint8_t>& cross_code) {
+	size_t i = 0;
+	FunctionMetaFlags flags = readData<FunctionMetaFlags>(cross_code, cross_code.size(), i);
+	return !flags.used_static && !flags.has_local_functions && !flags.run_time_computable;
+}
+void* load_cached_function(const std::vector<uint8_t>& cross_code, uint8_t*& frame, asmjit::JitRuntime& jrt, const char* symbol_name) {
+	code_cache::entry cached;
+	if (!code_cache::load(cross_code, cached))
+		return nullptr;
+	if (cached.head.size() != sizeof(UWINFO_head)) {
+		code_cache::invalidate(cross_code);
+		return nullptr;
+	}
+	FrameResult res;
+	res.prolog = std::move(cached.prolog);
+	memcpy(&res.head, cached.head.data(), sizeof(UWINFO_head));
+	res.exHandleOff = cached.ex_handle_off;
+	res.use_handle = cached.use_handle;
+	for (auto& it : cached.actions) {
+		ScopeAction action;
+		action.action = (ScopeAction::Action)it.kind;
+		action.destruct = nullptr;
+		if (it.function != UINT64_MAX) {
+			const void* destruct;
+			if (!code_cache::from_module_offset(it.function, destruct)) {
+				code_cache::invalidate(cross_code);
+				return nullptr;
+			}
+			action.destruct = (void(*)(void**))destruct;
+		}
+		switch (action.action) {
+		case ScopeAction::Action::destruct_stack:
+			action.stack_offset = it.value;
+			break;
+		case ScopeAction::Action::destruct_register:
+			action.register_value = (uint32_t)it.value;
+			break;
+		case ScopeAction::Action::filter:
+		case ScopeAction::Action::converter:
+			//convert copies data to unwind info, entry outlives init
+			action.filter_data = it.data.data();
+			action.filter_data_len = it.data.size();
+			break;
+		default:
+			break;
+		}
+		action.function_begin_off = it.begin_off;
+		action.function_end_off = it.end_off;
+		res.scope_actions.push_back(action);
+	}
+	std::vector<std::pair<size_t, const void*>> slots;
+	slots.reserve(cached.slots.size());
+	for (auto& [offset, target] : cached.slots) {
+		const void* address;
+		if (!code_cache::from_module_offset(target, address)) {
+			code_cache::invalidate(cross_code);
+			return nullptr;
+		}
+		slots.push_back({ offset, address });
+	}
+	//entry that passed checks but can not be installed compiled again and replaced
+	try {
+		return res.init(frame, cached.image, slots, jrt, symbol_name);
+	}
+	catch (...) {
+		code_cache::invalidate(cross_code);
+		return nullptr;
+	}
+}
+void store_cached_function(const std::vector<uint8_t>& cross_code, CASM& a, CodeHolder& code, FrameResult& frame_result, void* function) {
+	if (!a.relocatable || !code.relocEntries().empty()) {
+		code_cache::count_not_relocatable();
+		return;
+	}
+	code_cache::entry entry;
+	for (auto& [label, target] : a.helper_slots) {
+		uint64_t offset;
+		if (!code_cache::to_module_offset(target, offset)) {
+			code_cache::count_not_relocatable();
+			return;
+		}
+		entry.slots.push_back({ (size_t)code.labelOffsetFromBase(label), offset });
+	}
+	for (size_t i = 0; i < frame_result.scope_actions.size(); i++) {
+		auto& action = frame_result.scope_actions[i];
+		code_cache::entry::action it;
+		it.kind = (uint8_t)action.action;
+		it.value = 0;
+		if (!action.destruct)
+			it.function = UINT64_MAX;
+		else if (!code_cache::to_module_offset((const void*)action.destruct, it.function)) {
+			code_cache::count_not_relocatable();
+			return;
+		}
+		switch (action.action) {
+		case ScopeAction::Action::destruct_stack:
+			it.value = action.stack_offset;
+			break;
+		case ScopeAction::Action::destruct_register:
+			it.value = action.register_value;
+			break;
+		case ScopeAction::Action::filter:
+		case ScopeAction::Action::converter:
+			it.data.assign((uint8_t*)action.filter_data, (uint8_t*)action.filter_data + action.filter_data_len);
+			break;
+		default:
+			break;
+		}
+		it.begin_off = action.function_begin_off;
+		it.end_off = action.function_end_off;
+		entry.actions.push_back(std::move(it));
+	}
+	entry.image.assign((uint8_t*)function, (uint8_t*)function + code.codeSize());
+	entry.prolog = frame_result.prolog;
+	entry.head.assign((uint8_t*)&frame_result.head, (uint8_t*)&frame_result.head + sizeof(UWINFO_head));
+	entry.ex_handle_off = frame_result.exHandleOff;
+	entry.use_handle = frame_result.use_handle;
+	code_cache::store(cross_code, entry);
+}
+#endif
+
 void FuncEnvironment::RuntimeCompile() {
 	if (curr_func != nullptr)
 		FrameResult::deinit(frame, curr_func, jrt);
 	values.clear();
+	std::string symbol_name = try_resolve_frame(this);
+#ifdef _WIN64
+	bool cacheable = code_cache::enabled() && can_be_cached(cross_code);
+	if (cacheable) {
+		if (void* cached = load_cached_function(cross_code, frame, jrt, symbol_name.c_str())) {
+			curr_func = (Enviropment)cached;
+			return;
+		}
+	}
+#endif
 	RuntimeCompileException error_handler;
 	CodeHolder code;
 	code.setErrorHandler(&error_handler);
@@ -3232,6 +3574,9 @@ void FuncEnvironment::RuntimeCompile() {
 	constants_values += to_alloc_statics;
 	values.reserve_push_back(std::clamp<uint32_t>(constants_values, 0, UINT32_MAX));
 	uint32_t max_values = flags.used_enviro_vals ? uint32_t(used_enviro_vals) + 1 : 0;
+#ifdef _WIN64
+	a.relocatable_mode = cacheable;
+#endif
 
 
 	//OS dependent prolog begin
@@ -3310,14 +3655,18 @@ void FuncEnvironment::RuntimeCompile() {
 	tmp.exHandleOff = a.offset() <= UINT32_MAX ? (uint32_t)a.offset() : throw InvalidFunction("Too big function");
 	a.jmp((uint64_t)__attacha_handle);
 	a.finalize();
-	curr_func = (Enviropment)tmp.init(frame, a.code(), jrt, try_resolve_frame(this));
+	curr_func = (Enviropment)tmp.init(frame, a.code(), jrt, symbol_name.c_str());
+#ifdef _WIN64
+	if (cacheable)
+		store_cached_function(cross_code, a, code, tmp, (void*)curr_func);
+#endif
 }
 #pragma endregion
 #pragma region FuncEnvironment
 ValueItem* FuncEnvironment::async_call(typed_lgr<FuncEnvironment> f, ValueItem* args, uint32_t args_len) {
 	ValueItem* res = new ValueItem();
 	res->meta = ValueMeta(VType::async_res, false, false).encoded;
-	res->val = new typed_lgr(new Task(f, ValueItem(args, ValueMeta(VType::saarr, false, true, args_len), no_copy)));
+	res->val = new typed_lgr(make_lgr<Task>(f, ValueItem(args, ValueMeta(VType::saarr, false, true, args_len), no_copy)));
 	Task::start(*(typed_lgr<Task>*)res->val);
 	return res;
 }
@@ -3768,89 +4117,246 @@ ValueItem* FuncEnvironment::NativeProxy_DynamicToStatic(ValueItem* arguments, ui
 std::string FuncEnvironment::to_string(){
 	if(!curr_func)
 		return "fn(unknown)@0";
-	for(auto& it : enviropments)
-		if(it.second.getPtr() == this)
-			return "fn(" + it.first + ")@" + string_help::hexstr((ptrdiff_t)curr_func);
+	std::string name = enviropments.name_of(this);
+	if(!name.empty())
+		return "fn(" + name + ")@" + string_help::hexstr((ptrdiff_t)curr_func);
 	return "fn(" + FrameResult::JitResolveFrame(curr_func,true).fn_name + ")@" + string_help::hexstr((ptrdiff_t)curr_func);
 }
 const std::vector<uint8_t>& FuncEnvironment::get_cross_code(){
 	return cross_code;
 }
 
-void FuncEnvironment::fastHotPath(const std::string& func_name, const std::vector<uint8_t>& new_cross_code) {
-	auto& tmp = enviropments[func_name];
-	if (tmp) {
-		if (!tmp->can_be_unloaded)
-			throw HotPathException("Path fail cause this symbol is cannon't be unloaded for path");
-		tmp->force_unload = true;
+typed_lgr<FuncEnvironment> FuncSymbolCell::get() {
+	while (lock.test_and_set(std::memory_order_acquire))
+		run_time::tasks::util::cpu_relax();
+	typed_lgr<FuncEnvironment> res = fn;
+	lock.clear(std::memory_order_release);
+	return res;
+}
+void FuncSymbolCell::set(const typed_lgr<FuncEnvironment>& new_fn) {
+	typed_lgr<FuncEnvironment> old = new_fn;
+	while (lock.test_and_set(std::memory_order_acquire))
+		run_time::tasks::util::cpu_relax();
+	std::swap(fn, old);
+	lock.clear(std::memory_order_release);
+	//old function released outside of lock, destructor can be heavy
+}
+FuncSymbolCell* FuncEnvironment::symbolCell(const std::string& func_name) {
+	return enviropments.cell(func_name);
+}
+ValueItem* FuncEnvironment::callCell(FuncSymbolCell* cell, ValueItem* arguments, uint32_t arguments_size, bool run_async) {
+	typed_lgr<FuncEnvironment> fn = cell->get();
+	if (!fn)
+		throw NotImplementedException();
+	if (run_async)
+		return async_call(fn, arguments, arguments_size);
+	else
+		return fn->syncWrapper(arguments, arguments_size);
+}
+
+struct background_compile_queue {
+	static constexpr size_t max_stats = 4096;
+	TaskMutex lock;
+	uint16_t executor = -1;
+	bool compile_on_load = false;
+	size_t pending = 0;//started and not finished compile tasks
+	TaskConditionVariable pending_done;
+	//ring of last compilations, stats_next is oldest record when ring full
+	std::vector<FuncEnvironment::CompileStat> stats;
+	size_t stats_next = 0;
+	typed_lgr<FuncEnvironment> compile_func;
+	void add_stat(FuncEnvironment::CompileStat&& stat) {
+		if (stats.size() < max_stats)
+			stats.push_back(std::move(stat));
+		else {
+			stats[stats_next] = std::move(stat);
+			stats_next = (stats_next + 1) % max_stats;
+		}
+	}
+} compile_queue;
+
+void FuncEnvironment::funcComp(bool in_background) {
+	std::lock_guard<TaskMutex> lguard(compile_lock);
+	if (need_compile) {
+		auto started = std::chrono::high_resolution_clock::now();
+		RuntimeCompile();
+		need_compile = false;
+		uint64_t compile_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		art::lock_guard guard(compile_queue.lock);
+		compile_queue.add_stat({try_resolve_frame(this), compile_ns, in_background});
 	}
-	tmp = new FuncEnvironment(new_cross_code);
-	
 }
-void FuncEnvironment::fastHotPath(const std::string& func_name, typed_lgr<FuncEnvironment>& new_enviro) {
-	auto& tmp = enviropments[func_name];
-	if (tmp) {
-		if (!tmp->can_be_unloaded)
-			throw HotPathException("Path fail cause this symbol is cannon't be unloaded for path");
-		tmp->force_unload = true;
+//argument is typed_lgr from enqueueCompile or raw pointer from preCompile, preCompile waits for task so function alive
+ValueItem* FuncEnvironment::backgroundCompile(ValueItem* args, uint32_t len) {
+	FuncEnvironment* fn = args[0].meta.vtype == VType::function ? ((typed_lgr<FuncEnvironment>&)args[0]).getPtr() : (FuncEnvironment*)args[0].val;
+	auto done = [fn]() {
+		//failed compile may be queued again
+		fn->compile_queued = false;
+		art::lock_guard guard(compile_queue.lock);
+		if (!--compile_queue.pending)
+			compile_queue.pending_done.notify_all();
+	};
+	try {
+		if (fn->need_compile)
+			fn->funcComp(true);
+	}
+	catch (...) {
+		done();
+		throw;
+	}
+	done();
+	return nullptr;
+}
+typed_lgr<Task> FuncEnvironment::startCompileTask(const ValueItem& arg) {
+	typed_lgr<Task> task;
+	{
+		art::lock_guard guard(compile_queue.lock);
+		if (compile_queue.executor == (uint16_t)-1) {
+			compile_queue.compile_func = new FuncEnvironment(backgroundCompile, false);
+			compile_queue.executor = Task::create_bind_only_executor(1, false);
+		}
+		task = make_lgr<Task>(compile_queue.compile_func, arg);
+		task->bind_to_worker_id = compile_queue.executor;
+		compile_queue.pending++;
+	}
+	Task::start(task);
+	return task;
+}
+void FuncEnvironment::enqueueCompile(const typed_lgr<FuncEnvironment>& fn) {
+	if (!fn || fn->compiled() || fn->compile_queued.exchange(true))
+		return;
+	startCompileTask(ValueItem(fn));
+}
+void FuncEnvironment::preCompile() {
+	if (compiled())
+		return;
+	//already queued, compile lock waits for running compile or compiles here and queued task skips
+	if (compile_queued.exchange(true)) {
+		funcComp();
+		return;
 	}
-	tmp = new_enviro;
+	typed_lgr<Task> task = startCompileTask(ValueItem((void*)this));
+	Task::await_task(task);
+	//failed in background, compiled here again so caller receives exception
+	if (!compiled())
+		funcComp();
+}
+void FuncEnvironment::enqueueCompile(const std::vector<std::string>& symbols) {
+	for (auto& symbol : symbols)
+		enqueueCompile(enviropments.find(symbol));
+}
+void FuncEnvironment::enqueueCompileAll() {
+	for (auto& fn : enviropments.all())
+		enqueueCompile(fn);
+}
+void FuncEnvironment::setCompileOnLoad(bool enable) {
+	art::lock_guard guard(compile_queue.lock);
+	compile_queue.compile_on_load = enable;
+}
+void FuncEnvironment::awaitCompileQueue() {
+	MutexUnify unify(compile_queue.lock);
+	art::unique_lock lock(unify);
+	while (compile_queue.pending)
+		compile_queue.pending_done.wait(lock);
+}
+list_array<FuncEnvironment::CompileStat> FuncEnvironment::compileStats() {
+	art::lock_guard guard(compile_queue.lock);
+	list_array<FuncEnvironment::CompileStat> res;
+	res.reserve_push_back(compile_queue.stats.size());
+	for (size_t i = 0; i < compile_queue.stats.size(); i++)
+		res.push_back(compile_queue.stats[(compile_queue.stats_next + i) % compile_queue.stats.size()]);
+	return res;
+}
+void compileOnLoad(const typed_lgr<FuncEnvironment>& fn) {
+	bool enabled;
+	{
+		art::lock_guard guard(compile_queue.lock);
+		enabled = compile_queue.compile_on_load;
+	}
+	if (enabled)
+		FuncEnvironment::enqueueCompile(fn);
+}
+
+void FuncEnvironment::fastHotPath(const std::string& func_name, const std::vector<uint8_t>& new_cross_code) {
+	typed_lgr<FuncEnvironment> new_enviro = new FuncEnvironment(new_cross_code);
+	fastHotPath(func_name, new_enviro);
+}
+void FuncEnvironment::fastHotPath(const std::string& func_name, typed_lgr<FuncEnvironment>& new_enviro) {
+	enviropments.modify(func_name, [&](typed_lgr<FuncEnvironment>& tmp) {
+		if (tmp) {
+			if (!tmp->can_be_unloaded)
+				throw HotPathException("Path fail cause this symbol is cannon't be unloaded for path");
+			tmp->force_unload = true;
+		}
+		tmp = new_enviro;
+	});
+	compileOnLoad(new_enviro);
 }
 typed_lgr<FuncEnvironment> FuncEnvironment::enviropment(const std::string& func_name) {
-	return enviropments[func_name];
+	return enviropments.find(func_name);
 }
 ValueItem* FuncEnvironment::callFunc(const std::string& func_name, ValueItem* arguments, uint32_t arguments_size, bool run_async) {
-	if (enviropments.contains(func_name)) {
+	typed_lgr<FuncEnvironment> fn = enviropments.find(func_name);
+	if (fn) {
 		if (run_async)
-			return async_call(enviropments[func_name], arguments, arguments_size);
+			return async_call(fn, arguments, arguments_size);
 		else
-			return enviropments[func_name]->syncWrapper(arguments, arguments_size);
+			return fn->syncWrapper(arguments, arguments_size);
 	}
 	throw NotImplementedException();
 }
 void FuncEnvironment::AddNative(Enviropment function, const std::string& symbol_name, bool can_be_unloaded, bool is_cheap) {
-	if (enviropments.contains(symbol_name))
-		throw SymbolException("Fail alocate symbol: \"" + symbol_name + "\" cause them already exists");
-	enviropments[symbol_name] = typed_lgr(new FuncEnvironment(function, can_be_unloaded, is_cheap));
+	typed_lgr<FuncEnvironment> fn = new FuncEnvironment(function, can_be_unloaded, is_cheap);
+	enviropments.modify(symbol_name, [&](typed_lgr<FuncEnvironment>& tmp) {
+		if (tmp)
+			throw SymbolException("Fail alocate symbol: \"" + symbol_name + "\" cause them already exists");
+		tmp = fn;
+	});
 }
 
 void FuncEnvironment::AddNative(DynamicCall::PROC proc, const DynamicCall::FunctionTemplate& templ, const std::string& symbol_name, bool can_be_unloaded, bool is_cheap) {
-	if (enviropments.contains(symbol_name))
-		throw SymbolException("Fail alocate symbol: \"" + symbol_name + "\" cause them already exists");
-	enviropments[symbol_name] = typed_lgr(new FuncEnvironment(proc, templ, can_be_unloaded, is_cheap));
+	typed_lgr<FuncEnvironment> fn = new FuncEnvironment(proc, templ, can_be_unloaded, is_cheap);
+	enviropments.modify(symbol_name, [&](typed_lgr<FuncEnvironment>& tmp) {
+		if (tmp)
+			throw SymbolException("Fail alocate symbol: \"" + symbol_name + "\" cause them already exists");
+		tmp = fn;
+	});
 }
 
 bool FuncEnvironment::Exists(const std::string& symbol_name) {
 	return enviropments.contains(symbol_name);
 }
 void FuncEnvironment::Load(typed_lgr<FuncEnvironment> fn, const std::string& symbol_name) {
-	if (enviropments.contains(symbol_name))
-		throw SymbolException("Fail load symbol: \"" + symbol_name + "\" cause them already exists");
-	enviropments[symbol_name] = fn;
+	enviropments.modify(symbol_name, [&](typed_lgr<FuncEnvironment>& tmp) {
+		if (tmp)
+			throw SymbolException("Fail load symbol: \"" + symbol_name + "\" cause them already exists");
+		tmp = fn;
+	});
+	compileOnLoad(fn);
 }
 void FuncEnvironment::Load(const std::vector<uint8_t>& func_templ, const std::string& symbol_name) {
-	if (enviropments.contains(symbol_name))
-		throw SymbolException("Fail load symbol: \"" + symbol_name + "\" cause them already exists");
 	if (func_templ.size() < 2)
 		throw SymbolException("Fail load symbol: \"" + symbol_name + "\" cause them emplty");
-	uint16_t max_vals = func_templ[1];
-	max_vals <<= 8;
-	max_vals |= func_templ[0];
-	enviropments[symbol_name] = new FuncEnvironment(func_templ);
+	typed_lgr<FuncEnvironment> fn = new FuncEnvironment(func_templ);
+	Load(fn, symbol_name);
 }
 void FuncEnvironment::Unload(const std::string& func_name) {
-	art::lock_guard guard(enviropments_lock);
-	if (enviropments.contains(func_name))
-		if (enviropments[func_name]->can_be_unloaded)
-			enviropments.erase(func_name);
-		else
-			throw SymbolException("Fail unload symbol: \"" + func_name + "\" cause them cannont be unloaded");
+	enviropments.modify(func_name, [&](typed_lgr<FuncEnvironment>& tmp) {
+		if (tmp) {
+			if (tmp->can_be_unloaded)
+				tmp = nullptr;
+			else
+				throw SymbolException("Fail unload symbol: \"" + func_name + "\" cause them cannont be unloaded");
+		}
+	});
 }
 void FuncEnvironment::ForceUnload(const std::string& func_name) {
-	if (enviropments.contains(func_name)) {
-		enviropments[func_name]->force_unload = true;
-		enviropments.erase(func_name);
-	}
+	enviropments.modify(func_name, [](typed_lgr<FuncEnvironment>& tmp) {
+		if (tmp) {
+			tmp->force_unload = true;
+			tmp = nullptr;
+		}
+	});
 }
 #pragma endregion
 
@@ -11,6 +11,7 @@
 #include "dynamic_call.hpp"
 #include "../library/exceptions.hpp"
 #include "../tasks.hpp"
+class FuncSymbolCell;
 class FuncEnvironment {
 public:
 	enum class FuncType : uint32_t {
@@ -36,7 +37,6 @@ private:
 	DynamicCall::FunctionTemplate nat_templ;
 	TaskMutex compile_lock;//52 bytes
 	FuncType _type : 4;
-	uint32_t need_compile : 1 = true;
 	uint32_t can_be_unloaded : 1 = true;
 	uint32_t force_unload : 1 = false;
 	uint32_t is_cheap : 1 = false;//function without context switchs and with fast code
@@ -46,20 +46,39 @@ private:
 	list_array<ValueItem> values;
 	Enviropment curr_func = nullptr;
 	uint8_t* frame = nullptr;
+	size_t stack_hint = 0;//expected stack usage in bytes, 0 - unknown
+	std::atomic_size_t stack_high_water = 0;//max stack usage recorded in task learning mode
+	std::atomic_bool need_compile = true;//cleared after curr_func set, so readers without compile_lock see entry
+	std::atomic_bool compile_queued = false;//background compile task exists, so function queued once
 	void RuntimeCompile();
-	void funcComp() {
-		sizeof(TaskRecursiveMutex);
-		std::lock_guard<TaskMutex> lguard(compile_lock);
-		if (need_compile) {
-			RuntimeCompile();
-			need_compile = false;
-		}
-	}
+	void funcComp(bool in_background = false);
+	static ValueItem* backgroundCompile(ValueItem* args, uint32_t len);
+	static typed_lgr<Task> startCompileTask(const ValueItem& arg);
 public:
-	void preCompile() {
-		if (need_compile)
-			funcComp();
-	}
+	struct CompileStat {
+		std::string symbol;
+		uint64_t compile_ns;
+		bool in_background;
+	};
+	//compiled by background executor, returns when function compiled
+	void preCompile();
+	bool compiled() {
+		return !need_compile.load(std::memory_order_acquire);
+	}
+	//null until function compiled, jit call sites of not compiled function read entry from it
+	Enviropment* entrySlot() {
+		return &curr_func;
+	}
+	//compiles on dedicated executor ahead of first call, if call comes first it compiles function itself and queued one skips
+	static void enqueueCompile(const typed_lgr<FuncEnvironment>& fn);
+	//manifest of hot symbols, not loaded symbols skipped
+	static void enqueueCompile(const std::vector<std::string>& symbols);
+	static void enqueueCompileAll();
+	//when enabled every loaded or hot pathed symbol queued for compilation
+	static void setCompileOnLoad(bool enable);
+	static void awaitCompileQueue();
+	//last compiled functions in order of completion, older records dropped
+	static list_array<CompileStat> compileStats();
 	FuncEnvironment(const std::vector<uint8_t>& code) {
 		cross_code = code;
 		_type = FuncType::own;
@@ -106,8 +125,10 @@ public:
 		nat_templ = std::move(move.nat_templ);
 		curr_func = move.curr_func;
 		frame = move.frame;
+		stack_hint = move.stack_hint;
+		stack_high_water = move.stack_high_water.load();
 		_type = move._type;
-		need_compile = move.need_compile;
+		need_compile = move.need_compile.load();
 		can_be_unloaded = move.can_be_unloaded;
 		//disable destructor
 		move.can_be_unloaded = false;
@@ -135,6 +156,9 @@ public:
 	static void fastHotPath(const std::string& func_name, typed_lgr<FuncEnvironment>& new_enviro);
 	static typed_lgr<FuncEnvironment> enviropment(const std::string& func_name);
 	static ValueItem* callFunc(const std::string& func_name, ValueItem* arguments, uint32_t arguments_size, bool run_async);
+	//slot created on first request, lives until process exit
+	static FuncSymbolCell* symbolCell(const std::string& func_name);
+	static ValueItem* callCell(FuncSymbolCell* cell, ValueItem* arguments, uint32_t arguments_size, bool run_async);
 
 	template<class Ret>
 	static void AddNative(Ret(*function)(), const std::string& symbol_name, bool can_be_unloaded = true, bool is_cheap = false) {
@@ -173,6 +197,20 @@ public:
 	bool isCheap() {
 		return is_cheap;
 	}
+	//task stack selected by smallest size class fits hint
+	void setStackHint(size_t bytes) {
+		stack_hint = bytes;
+	}
+	size_t stackHint() {
+		return stack_hint;
+	}
+	void recordStackUsage(size_t bytes) {
+		size_t current = stack_high_water.load(std::memory_order_relaxed);
+		while (current < bytes && !stack_high_water.compare_exchange_weak(current, bytes, std::memory_order_relaxed));
+	}
+	size_t stackHighWater() {
+		return stack_high_water.load(std::memory_order_relaxed);
+	}
 	FuncType type() {
 		return _type;
 	}
@@ -185,6 +223,15 @@ public:
 	std::string to_string();
 	const std::vector<uint8_t>& get_cross_code();
 };
+//stable slot of symbol, jit code embeds slot address instead of searching symbol by name on every call
+//Load, Unload and fastHotPath replace function inside slot, so next call through slot uses new function
+class FuncSymbolCell {
+	typed_lgr<FuncEnvironment> fn;
+	std::atomic_flag lock = ATOMIC_FLAG_INIT;
+public:
+	typed_lgr<FuncEnvironment> get();
+	void set(const typed_lgr<FuncEnvironment>& new_fn);
+};
 void NativeProxy_DynamicToStatic_addValue(DynamicCall::FunctionCall& call, ValueMeta meta, void*& arg);
 ValueItem* NativeProxy_DynamicToStatic(DynamicCall::FunctionCall& call, DynamicCall::FunctionTemplate& nat_templ, ValueItem* arguments, uint32_t arguments_size);
 extern "C" void callFunction(const char* symbol_name, bool run_async);
\ No newline at end of file
@@ -0,0 +1,336 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+#include "code_cache.hpp"
+#include <asmjit/asmjit.h>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "../threading.hpp"
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <link.h>
+#include <sys/stat.h>
+#endif
+
+namespace code_cache {
+	constexpr uint32_t magic = 0x434A4141;//AAJC
+	constexpr uint32_t version = 2;
+
+	static uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325) {
+		const uint8_t* bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	//size of module mapped at base, from start to end of last loadable segment
+	static int module_size_callback(dl_phdr_info* info, size_t, void* data) {
+		auto& [base, size] = *(std::pair<const uint8_t*, size_t>*)data;
+		bool found = false;
+		size_t end = 0;
+		for (int i = 0; i < info->dlpi_phnum; i++) {
+			auto& phdr = info->dlpi_phdr[i];
+			if (phdr.p_type != PT_LOAD)
+				continue;
+			const uint8_t* begin = (const uint8_t*)(info->dlpi_addr + phdr.p_vaddr);
+			if (begin == base)
+				found = true;
+			if (begin + phdr.p_memsz > base + end)
+				end = begin + phdr.p_memsz - base;
+		}
+		if (!found)
+			return 0;
+		size = end;
+		return 1;
+	}
+#endif
+	//module that contains runtime helpers, offsets inside it stable while binary not rebuilt
+	struct runtime_module {
+		const uint8_t* base = nullptr;
+		size_t size = 0;
+		uint64_t build_id = 0;
+		uint64_t cpu_id = 0;
+		runtime_module() {
+#if defined(_WIN32) || defined(_WIN64)
+			HMODULE module;
+			if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)&set_directory, &module)) {
+				base = (const uint8_t*)module;
+				auto dos = (const IMAGE_DOS_HEADER*)base;
+				auto nt = (const IMAGE_NT_HEADERS*)(base + dos->e_lfanew);
+				size = nt->OptionalHeader.SizeOfImage;
+				uint32_t id[3] = { nt->FileHeader.TimeDateStamp, nt->OptionalHeader.SizeOfImage, nt->OptionalHeader.CheckSum };
+				build_id = fnv1a(id, sizeof(id));
+			}
+#else
+			Dl_info info;
+			if (dladdr((void*)&set_directory, &info) && info.dli_fname) {
+				base = (const uint8_t*)info.dli_fbase;
+				std::pair<const uint8_t*, size_t> range{ base, 0 };
+				dl_iterate_phdr(module_size_callback, &range);
+				size = range.second;
+				struct stat st;
+				if (stat(info.dli_fname, &st) == 0) {
+					uint64_t id[2] = { uint64_t(st.st_mtime), uint64_t(st.st_size) };
+					build_id = fnv1a(id, sizeof(id));
+				}
+			}
+#endif
+			const asmjit::CpuInfo& cpu = asmjit::CpuInfo::host();
+			cpu_id = fnv1a(cpu.vendor(), strlen(cpu.vendor()));
+			cpu_id = fnv1a(cpu.brand(), strlen(cpu.brand()), cpu_id);
+			uint32_t model[2] = { cpu.familyId(), cpu.modelId() };
+			cpu_id = fnv1a(model, sizeof(model), cpu_id);
+			cpu_id = fnv1a(&cpu.features(), sizeof(cpu.features()), cpu_id);
+		}
+		bool contains(const void* address) {
+			return base && (const uint8_t*)address >= base && (const uint8_t*)address < base + size;
+		}
+	};
+	static runtime_module& module() {
+		static runtime_module instance;
+		return instance;
+	}
+
+	art::mutex directory_lock;
+	std::filesystem::path directory;
+	std::atomic_bool is_enabled = false;
+	struct {
+		std::atomic_size_t hits = 0;
+		std::atomic_size_t misses = 0;
+		std::atomic_size_t stored = 0;
+		std::atomic_size_t not_relocatable = 0;
+		std::atomic_size_t invalidated = 0;
+		std::atomic_size_t store_failed = 0;
+	} counters;
+
+	void set_directory(const std::string& path) {
+		art::lock_guard guard(directory_lock);
+		directory = path;
+		if (!path.empty()) {
+			std::error_code ec;
+			std::filesystem::create_directories(directory, ec);
+		}
+		is_enabled = !path.empty() && module().build_id && module().size;
+	}
+	bool enabled() {
+		return is_enabled;
+	}
+	static std::filesystem::path entry_path(const std::vector<uint8_t>& cross_code) {
+		uint64_t key = fnv1a(cross_code.data(), cross_code.size());
+		key = fnv1a(&module().build_id, sizeof(uint64_t), key);
+		key = fnv1a(&module().cpu_id, sizeof(uint64_t), key);
+		char name[24];
+		snprintf(name, sizeof(name), "%016llx.ajc", (unsigned long long)key);
+		art::lock_guard guard(directory_lock);
+		return directory / name;
+	}
+
+	template<class T>
+	static void write(std::ostream& file, const T& value) {
+		file.write((const char*)&value, sizeof(T));
+	}
+	template<class T>
+	static void write(std::ostream& file, const std::vector<T>& value) {
+		write(file, uint64_t(value.size()));
+		file.write((const char*)value.data(), value.size() * sizeof(T));
+	}
+	template<class T>
+	static bool read(std::istream& file, T& value) {
+		return (bool)file.read((char*)&value, sizeof(T));
+	}
+	template<class T>
+	static bool read(std::istream& file, std::vector<T>& value) {
+		uint64_t size;
+		if (!read(file, size) || size > (uint64_t(1) << 32))
+			return false;
+		value.resize(size);
+		return (bool)file.read((char*)value.data(), size * sizeof(T));
+	}
+	//true when [offset, offset + length) inside of buffer with given size
+	static bool in_range(uint64_t offset, uint64_t length, uint64_t size) {
+		return offset <= size && size - offset >= length;
+	}
+	static bool in_module(uint64_t offset) {
+		return offset < module().size;
+	}
+
+	static bool read_body(std::istream& file, const std::vector<uint8_t>& cross_code, entry& res) {
+		//whole cross code compared, hash collision must not run foreign code
+		std::vector<uint8_t> stored_code;
+		if (!read(file, stored_code) || stored_code != cross_code)
+			return false;
+		uint64_t slots_count;
+		if (!read(file, res.image) || !read(file, slots_count))
+			return false;
+		res.slots.resize(slots_count);
+		for (auto& [offset, target] : res.slots) {
+			uint64_t off;
+			if (!read(file, off) || !read(file, target) || !in_range(off, sizeof(void*), res.image.size()) || !in_module(target))
+				return false;
+			offset = off;
+		}
+		uint8_t use_handle;
+		uint64_t actions_count;
+		if (!read(file, res.prolog) || !read(file, res.head) || !read(file, res.ex_handle_off) || !read(file, use_handle) || !read(file, actions_count))
+			return false;
+		res.use_handle = use_handle;
+		if (res.use_handle && !in_range(res.ex_handle_off, 1, res.image.size()))
+			return false;
+		if (actions_count > res.image.size())
+			return false;
+		res.actions.resize(actions_count);
+		for (auto& action : res.actions) {
+			uint64_t begin_off, end_off;
+			if (!read(file, action.kind) || !read(file, action.function) || !read(file, action.value) || !read(file, begin_off) || !read(file, end_off) || !read(file, action.data))
+				return false;
+			if (begin_off > end_off || end_off > res.image.size())
+				return false;
+			if (action.function != UINT64_MAX && !in_module(action.function))
+				return false;
+			action.begin_off = begin_off;
+			action.end_off = end_off;
+		}
+		return true;
+	}
+	static bool read_entry(std::ifstream& file, const std::vector<uint8_t>& cross_code, entry& res) {
+		uint32_t file_magic, file_version;
+		uint64_t build_id, cpu_id, checksum;
+		if (!read(file, file_magic) || !read(file, file_version) || !read(file, build_id) || !read(file, cpu_id) || !read(file, checksum))
+			return false;
+		if (file_magic != magic || file_version != version || build_id != module().build_id || cpu_id != module().cpu_id)
+			return false;
+		//checked before parse, truncated or damaged entry must not reach executable memory
+		std::string body_data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (fnv1a(body_data.data(), body_data.size()) != checksum)
+			return false;
+		std::istringstream body(std::move(body_data));
+		return read_body(body, cross_code, res);
+	}
+	bool load(const std::vector<uint8_t>& cross_code, entry& res) {
+		if (!enabled())
+			return false;
+		std::filesystem::path path = entry_path(cross_code);
+		bool valid;
+		{
+			std::ifstream file(path, std::ios::binary);
+			if (!file.is_open()) {
+				counters.misses++;
+				return false;
+			}
+			valid = read_entry(file, cross_code, res);
+		}
+		if (!valid) {
+			std::error_code ec;
+			std::filesystem::remove(path, ec);
+			counters.invalidated++;
+			counters.misses++;
+			return false;
+		}
+		counters.hits++;
+		return true;
+	}
+	void invalidate(const std::vector<uint8_t>& cross_code) {
+		if (!enabled())
+			return;
+		std::error_code ec;
+		if (std::filesystem::remove(entry_path(cross_code), ec))
+			counters.invalidated++;
+	}
+	void store(const std::vector<uint8_t>& cross_code, const entry& value) {
+		if (!enabled())
+			return;
+		std::ostringstream body;
+		write(body, cross_code);
+		write(body, value.image);
+		write(body, uint64_t(value.slots.size()));
+		for (auto& [offset, target] : value.slots) {
+			write(body, uint64_t(offset));
+			write(body, target);
+		}
+		write(body, value.prolog);
+		write(body, value.head);
+		write(body, value.ex_handle_off);
+		write(body, uint8_t(value.use_handle));
+		write(body, uint64_t(value.actions.size()));
+		for (auto& action : value.actions) {
+			write(body, action.kind);
+			write(body, action.function);
+			write(body, action.value);
+			write(body, uint64_t(action.begin_off));
+			write(body, uint64_t(action.end_off));
+			write(body, action.data);
+		}
+		std::string body_data = std::move(body).str();
+		std::filesystem::path path = entry_path(cross_code);
+		std::filesystem::path temp = path;
+		temp += ".tmp" + std::to_string(std::random_device()());
+		bool written;
+		{
+			std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				counters.store_failed++;
+				return;
+			}
+			write(file, magic);
+			write(file, version);
+			write(file, module().build_id);
+			write(file, module().cpu_id);
+			write(file, fnv1a(body_data.data(), body_data.size()));
+			file.write(body_data.data(), body_data.size());
+			file.flush();
+			written = (bool)file;
+		}
+		std::error_code ec;
+		if (!written) {
+			//partial temp file never renamed, so remove it here
+			std::filesystem::remove(temp, ec);
+			counters.store_failed++;
+			return;
+		}
+		//rename replaces entry at once, concurrent loader sees old or new file
+		std::filesystem::rename(temp, path, ec);
+		if (ec) {
+			std::filesystem::remove(temp, ec);
+			counters.store_failed++;
+		}
+		else
+			counters.stored++;
+	}
+	void count_not_relocatable() {
+		counters.not_relocatable++;
+	}
+	bool to_module_offset(const void* address, uint64_t& offset) {
+		auto& mod = module();
+		if (!mod.contains(address))
+			return false;
+		offset = (const uint8_t*)address - mod.base;
+		return true;
+	}
+	bool from_module_offset(uint64_t offset, const void*& address) {
+		if (!in_module(offset))
+			return false;
+		address = module().base + offset;
+		return true;
+	}
+	stats get_stats() {
+		stats res;
+		res.hits = counters.hits;
+		res.misses = counters.misses;
+		res.stored = counters.stored;
+		res.not_relocatable = counters.not_relocatable;
+		res.invalidated = counters.invalidated;
+		res.store_failed = counters.store_failed;
+		return res;
+	}
+}
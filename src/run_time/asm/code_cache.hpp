@@ -0,0 +1,53 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+//persistent jit code cache, entry keyed by cross code hash, runtime module build and host cpu
+//only code without embedded addresses stored, runtime helpers called through data slots that patched on load
+//entry that does not match current runtime or cross code removed on load
+namespace code_cache {
+	struct entry {
+		std::vector<uint8_t> image;
+		//offset of slot in image and offset of target from runtime module base
+		std::vector<std::pair<size_t, uint64_t>> slots;
+		std::vector<uint16_t> prolog;
+		std::vector<uint8_t> head;
+		uint32_t ex_handle_off = 0;
+		bool use_handle = false;
+		struct action {
+			uint8_t kind;
+			uint64_t function;//offset from runtime module base
+			uint64_t value;//stack offset or register
+			size_t begin_off;
+			size_t end_off;
+			std::vector<uint8_t> data;
+		};
+		std::vector<action> actions;
+	};
+	struct stats {
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t stored = 0;
+		size_t not_relocatable = 0;
+		size_t invalidated = 0;
+		size_t store_failed = 0;//temp file not created or written, or rename failed
+	};
+	//empty path disables cache, disabled by default
+	void set_directory(const std::string& path);
+	bool enabled();
+	bool load(const std::vector<uint8_t>& cross_code, entry& res);
+	//removes entry that loaded but could not be installed
+	void invalidate(const std::vector<uint8_t>& cross_code);
+	void store(const std::vector<uint8_t>& cross_code, const entry& value);
+	void count_not_relocatable();
+	//false when address is not inside of runtime module
+	bool to_module_offset(const void* address, uint64_t& offset);
+	//false when offset is outside of runtime module
+	bool from_module_offset(uint64_t offset, const void*& address);
+	stats get_stats();
+}
@@ -1,9 +1,18 @@
 #include "files.hpp"
 #include "../library/exceptions.hpp"
 #include "../tasks_util/native_workers_singleton.hpp"
+#if defined(_WIN32) || defined(_WIN64)
 #include <Windows.h>
 #include <winternl.h>
 #include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <cstdlib>
+#endif
 #include "../../../configuration/compatibility.hpp"
 #if CONFIGURATION_COMPATIBILITY_ENABLE_FSTREAM_FROM_BLOCKINGFILEHANDLE
 #include <fstream>
@@ -50,6 +59,7 @@ namespace files {
             default: throw AException("FileException", "Unknown error");
         }
     }
+#if defined(_WIN32) || defined(_WIN64)
     class File_ : public NativeWorkerHandle {
         TaskConditionVariable awaiters;
         TaskMutex mutex;
@@ -217,6 +227,279 @@ namespace files {
             }
         }
     };
+#else
+    //O_DIRECT requires buffer, length and offset aligned to logical block size, page size covers all common devices
+    constexpr size_t direct_io_alignment = 4096;
+    char* alloc_io_buffer(uint64_t size, bool aligned){
+        if(!aligned)
+            return new char[size];
+        void* res = nullptr;
+        if(posix_memalign(&res, direct_io_alignment, size ? size : direct_io_alignment))
+            throw std::bad_alloc();
+        return (char*)res;
+    }
+    void free_io_buffer(char* buffer, bool aligned){
+        if(aligned)
+            free(buffer);
+        else
+            delete[] buffer;
+    }
+    class File_ : public NativeWorkerHandle {
+        //completes independently from operation, owned by manager and deleted on completion
+        struct Cancel_ : public NativeWorkerHandle{
+            Cancel_(NativeWorkerManager* manager) : NativeWorkerHandle(manager) {}
+        };
+        enum class stage : uint8_t {
+            transfer,
+            //unaligned direct write, boundary blocks read before whole blocks written
+            fill_head,
+            fill_tail
+        };
+        TaskConditionVariable awaiters;
+        TaskMutex mutex;
+        NativeWorkerManager* manager;
+        int handle;
+        char* buffer = nullptr;//for direct io covers whole blocks around requested range
+        char* fill_block = nullptr;
+        int32_t fixed_index = -1;//registered buffer used instead of own
+        uint64_t io_offset;
+        uint64_t io_length;
+        uint64_t io_done = 0;
+        uint64_t file_end = UINT64_MAX;//known when boundary block read hits end of file
+        uint32_t head = 0;//requested range offset in buffer
+        stage current = stage::transfer;
+        bool fullifed = false;
+        bool aligned;
+        std::atomic_bool canceled = false;
+    public:
+        static inline const char cancel_key = 0;
+        typed_lgr<Task> awaiter;
+        uint32_t fullifed_bytes = 0;
+        const uint32_t buffer_size;
+        const uint64_t offset;
+        const bool is_read;
+        const bool required_full;
+        File_(NativeWorkerManager* manager, int handle, char* buffer, uint32_t buffer_size, uint64_t offset, bool aligned) : NativeWorkerHandle(manager), manager(manager), handle(handle), is_read(false), buffer_size(buffer_size), offset(offset), required_full(true), aligned(aligned){
+            init_range();
+            memcpy(this->buffer + head, buffer, buffer_size);
+            if(head)
+                current = stage::fill_head;
+            else if(tail_unaligned())
+                current = stage::fill_tail;
+            if(current != stage::transfer)
+                fill_block = alloc_io_buffer(direct_io_alignment, true);
+        }
+
+        File_(NativeWorkerManager* manager, int handle, uint32_t buffer_size, uint64_t offset, bool required_full, bool aligned) : NativeWorkerHandle(manager), manager(manager), handle(handle), is_read(true), buffer_size(buffer_size), offset(offset), required_full(required_full), aligned(aligned){
+            init_range();
+        }
+        ~File_(){
+            if(fixed_index != -1)
+                NativeWorkersSingleton::release_fixed_buffer(fixed_index);
+            else if(buffer)
+                free_io_buffer(buffer, aligned);
+            if(fill_block)
+                free_io_buffer(fill_block, true);
+        }
+        //regular file requests already taken by kernel worker can not be stopped, then cancel only prevents resubmit
+        void cancel(){
+            MutexUnify unify(mutex);
+            art::unique_lock<MutexUnify> lock(unify);
+            if(fullifed)
+                return;
+            canceled = true;
+            Cancel_* request = new Cancel_(manager);
+            if(!NativeWorkersSingleton::submit(request, (void*)&cancel_key, NativeWorkersSingleton::prepare_cancel(this)))
+                delete request;
+        }
+        void await(){
+            MutexUnify unify(mutex);
+            art::unique_lock<MutexUnify> lock(unify);
+            while(!fullifed)
+                awaiters.wait(lock);
+        }
+        void now_fullifed(){
+            MutexUnify unify(mutex);
+            art::unique_lock<MutexUnify> lock(unify);
+            fullifed = true;
+            if(awaiter) {
+                if(is_read)
+                    awaiter->fres.finalResult(ValueItem((uint8_t*)buffer + head, fullifed_bytes), lock);
+                else
+                    awaiter->fres.finalResult(fullifed_bytes, lock);
+            }
+            awaiters.notify_all();
+            awaiter = nullptr;
+        }
+        void now_canceled(){
+            MutexUnify unify(mutex);
+            art::unique_lock<MutexUnify> lock(unify);
+            fullifed = true;
+            if(awaiter)
+                awaiter->fres.finalResult(ValueItem(), lock);
+            awaiters.notify_all();
+            awaiter = nullptr;
+        }
+        void exception(io_errors e){
+            MutexUnify unify(mutex);
+            art::unique_lock<MutexUnify> lock(unify);
+            fullifed = true;
+            if(awaiter) {
+                if(fullifed_bytes){
+                    if(is_read)
+                        awaiter->fres.yieldResult(ValueItem((uint8_t*)buffer + head, fullifed_bytes), lock);
+                    else
+                        awaiter->fres.yieldResult(fullifed_bytes, lock);
+                }
+                awaiter->fres.finalResult((uint8_t)e, lock);
+            }
+            awaiters.notify_all();
+            awaiter = nullptr;
+        }
+        void operation_fullifed(uint32_t len){
+            switch (current) {
+                case stage::fill_head:
+                    block_filled(io_offset, len);
+                    memcpy(buffer, fill_block, head);
+                    if(io_length == direct_io_alignment && tail_unaligned())
+                        copy_tail(0);
+                    current = tail_unaligned() && io_length > direct_io_alignment ? stage::fill_tail : stage::transfer;
+                    break;
+                case stage::fill_tail:
+                    block_filled(io_offset + io_length - direct_io_alignment, len);
+                    copy_tail(io_length - direct_io_alignment);
+                    current = stage::transfer;
+                    break;
+                case stage::transfer:
+                    if(is_read && len == 0){
+                        finish_read();
+                        return;
+                    }
+                    io_done += len;
+                    if(io_length <= io_done){
+                        finish();
+                        return;
+                    }
+                    if(aligned && io_done % direct_io_alignment){
+                        //direct read returns unaligned length only at end of file
+                        if(is_read){
+                            finish_read();
+                            return;
+                        }
+                        //partially written block written again from start, offset must stay aligned
+                        io_done &= ~(uint64_t)(direct_io_alignment - 1);
+                    }
+                    break;
+            }
+            if(canceled){
+                update_fullifed();
+                now_canceled();
+                return;
+            }
+            if(!submit())
+                exception(io_errors::unknown_error);
+        }
+
+        void start(){
+            if(!submit())
+                throw AException("FileException", "Failed submit io request");
+        }
+        void error_filter(){
+            update_fullifed();
+            switch (-result) {
+                case ECANCELED: now_canceled(); break;
+                case ENOMEM: exception(io_errors::no_enough_memory); break;
+                case EFAULT:
+                case EINVAL: exception(io_errors::invalid_user_buffer); break;
+                case EDQUOT:
+                case ENOSPC: exception(io_errors::no_enough_quota); break;
+                default: exception(io_errors::unknown_error); break;
+            }
+        }
+    private:
+        void init_range(){
+            //append offset stays -1, direct append requires aligned size, checked by manager
+            if(aligned && offset != (uint64_t)-1){
+                io_offset = offset & ~(uint64_t)(direct_io_alignment - 1);
+                uint64_t end = (offset + buffer_size + direct_io_alignment - 1) & ~(uint64_t)(direct_io_alignment - 1);
+                io_length = end - io_offset;
+                head = uint32_t(offset - io_offset);
+            }else{
+                io_offset = offset;
+                io_length = buffer_size;
+            }
+            fixed_index = NativeWorkersSingleton::acquire_fixed_buffer(io_length, buffer);
+            if(fixed_index == -1)
+                buffer = alloc_io_buffer(io_length, aligned);
+        }
+        bool tail_unaligned(){
+            return aligned && offset != (uint64_t)-1 && (offset + buffer_size) % direct_io_alignment;
+        }
+        void block_filled(uint64_t block_offset, uint32_t len){
+            if(len < direct_io_alignment)
+                file_end = std::min(file_end, block_offset + len);
+            memset(fill_block + len, 0, direct_io_alignment - len);
+        }
+        //keeps file bytes behind requested range in last block
+        void copy_tail(uint64_t block_in_buffer){
+            uint64_t tail_start = head + buffer_size - block_in_buffer;
+            memcpy(buffer + block_in_buffer + tail_start, fill_block + tail_start, direct_io_alignment - tail_start);
+        }
+        void update_fullifed(){
+            if(is_read)
+                fullifed_bytes = io_done > head ? (uint32_t)std::min<uint64_t>(io_done - head, buffer_size) : 0;
+            else{
+                uint64_t written = (uint64_t)std::max<int64_t>((int64_t)io_done - head, 0);
+                fullifed_bytes = (uint32_t)std::min<uint64_t>(written, buffer_size);
+            }
+        }
+        void finish_read(){
+            update_fullifed();
+            if(required_full && fullifed_bytes < buffer_size)
+                exception(io_errors::eof);
+            else
+                now_fullifed();
+        }
+        void finish(){
+            update_fullifed();
+            //whole blocks written behind old end of file, zero padding cut back
+            if(!is_read && file_end != UINT64_MAX && file_end < io_offset + io_length)
+                if(ftruncate(handle, std::max<uint64_t>(file_end, offset + buffer_size)) == -1){
+                    exception(io_errors::unknown_error);
+                    return;
+                }
+            now_fullifed();
+        }
+        bool submit(){
+            io_uring_sqe sqe;
+            switch (current) {
+                case stage::fill_head:
+                    sqe = NativeWorkersSingleton::prepare_read(handle, fill_block, direct_io_alignment, io_offset);
+                    break;
+                case stage::fill_tail:
+                    sqe = NativeWorkersSingleton::prepare_read(handle, fill_block, direct_io_alignment, io_offset + io_length - direct_io_alignment);
+                    break;
+                case stage::transfer:{
+                    //offset -1 used by append, RWF_APPEND writes to end of file regardless of position
+                    uint64_t position = io_offset == (uint64_t)-1 ? (uint64_t)-1 : io_offset + io_done;
+                    uint32_t len = (uint32_t)std::min<uint64_t>(io_length - io_done, UINT32_MAX & ~(uint32_t)(direct_io_alignment - 1));
+                    if(fixed_index != -1)
+                        sqe = is_read
+                            ? NativeWorkersSingleton::prepare_read_fixed(handle, buffer + io_done, len, position, (uint16_t)fixed_index)
+                            : NativeWorkersSingleton::prepare_write_fixed(handle, buffer + io_done, len, position, (uint16_t)fixed_index);
+                    else
+                        sqe = is_read
+                            ? NativeWorkersSingleton::prepare_read(handle, buffer + io_done, len, position)
+                            : NativeWorkersSingleton::prepare_write(handle, buffer + io_done, len, position);
+                    if(position == (uint64_t)-1)
+                        sqe.rw_flags = RWF_APPEND;
+                    break;
+                }
+            }
+            return NativeWorkersSingleton::submit(this, nullptr, sqe);
+        }
+    };
+#endif
     void file_overlapped_on_await(ValueItem& it){
         ((File_*)(void*)it)->await();
     }
@@ -224,12 +507,16 @@ namespace files {
         ((File_*)(void*)it)->cancel();
     }
     void file_overlapped_on_destruct(ValueItem& it) {
-        if(((File_*)(void*)it)->awaiter)
+        if(((File_*)(void*)it)->awaiter){
 			((File_*)(void*)it)->cancel();
+            //request still can reference handle, completion must arrive before delete
+            ((File_*)(void*)it)->await();
+        }
         delete (File_*)(void*)it;
 	}
 
 
+#if defined(_WIN32) || defined(_WIN64)
     class FileManager : public NativeWorkerManager {
         void* _handle = nullptr;
         uint64_t write_pointer;
@@ -549,10 +836,336 @@ namespace files {
             return _handle;
         }
     };
+#else
+    int open_file(const char* path, size_t path_len, open_mode open, on_open_action action, _sync_flags flags){
+        std::string spath(path, path_len);
+        int oflags = O_CLOEXEC;
+        switch(open){
+            case open_mode::read:
+                oflags |= O_RDONLY;
+                break;
+            case open_mode::write:
+                oflags |= O_WRONLY;
+                break;
+            case open_mode::append:
+                oflags |= O_WRONLY | O_APPEND;
+                break;
+            case open_mode::read_write:
+                oflags |= O_RDWR;
+                break;
+            default:
+                throw InvalidArguments("Invalid open mode, excepted read, write, read_write or append, but got " + std::to_string((int)open));
+        }
+        switch (action) {
+            case on_open_action::open:
+                oflags |= O_CREAT;
+                break;
+            case on_open_action::always_new:
+                oflags |= O_CREAT | O_TRUNC;
+                break;
+            case on_open_action::create_new:
+                oflags |= O_CREAT | O_EXCL;
+                break;
+            case on_open_action::open_exists:
+                break;
+            case on_open_action::truncate_exists:
+                oflags |= O_TRUNC;
+                break;
+            default:
+                throw InvalidArguments("Invalid on open action, excepted open, always_new, create_new, open_exists or truncate_exists, but got " + std::to_string((int)open));
+        }
+        if(flags.no_buffering)
+            oflags |= O_DIRECT;
+        if(flags.write_through)
+            oflags |= O_DSYNC;
+        int fd = ::open(spath.c_str(), oflags, 0644);
+        if(fd == -1){
+            switch(errno){
+                case ENOENT:
+                    throw AException("FileException", "File not found");
+                case EACCES:
+                case EPERM:
+                    throw AException("FileException", "Access denied");
+                case EEXIST:
+                    throw AException("FileException", "File exists");
+                case EFBIG:
+                case EOVERFLOW:
+                    throw AException("FileException", "File too large");
+                case EINVAL:
+                    throw AException("FileException", "Invalid parameter");
+                case ETXTBSY:
+                case EBUSY:
+                    throw AException("FileException", "Sharing violation");
+                default:
+                    throw AException("FileException", "Unknown error");
+            }
+        }
+        if(flags.sequential_scan)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        if(flags.random_access)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+        //file stays accessible by descriptor until close
+        if(flags.delete_on_close)
+            unlink(spath.c_str());
+        return fd;
+    }
+
+    class FileManager : public NativeWorkerManager {
+        struct Sync_ : public NativeWorkerHandle{
+            TaskConditionVariable awaiters;
+            TaskMutex mutex;
+            bool fullifed = false;
+            Sync_(NativeWorkerManager* manager) : NativeWorkerHandle(manager) {}
+        };
+        int _handle = -1;
+        uint64_t write_pointer;
+        uint64_t read_pointer;
+        pointer_mode pointer_mode;
+        bool aligned;
+        friend class File_;
+
+        uint64_t _file_size(){
+            struct stat file_stat;
+            if(fstat(_handle, &file_stat) == -1)
+                return -1;
+            return file_stat.st_size;
+        }
+        ValueItem start(File_* file){
+            ValueItem args((void*)file);
+            try{
+                file->awaiter = Task::callback_dummy(args, file_overlapped_on_await, file_overlapped_on_cancel,nullptr, file_overlapped_on_destruct);
+                file->start();
+            }catch(...){
+                delete file;
+                throw;
+            }
+            return file->awaiter;
+        }
+    public:
+        FileManager(const char* path, size_t path_len, open_mode open, on_open_action action, share_mode share, _sync_flags flags, enum class pointer_mode pointer_mode) noexcept(false) : pointer_mode(pointer_mode), aligned(flags.no_buffering) {
+            read_pointer = 0;
+            write_pointer = 0;
+            _handle = open_file(path, path_len, open, action, flags);
+        }
+        ~FileManager(){
+            if(_handle != -1)
+                close(_handle);
+        }
+        ValueItem read(uint32_t size, bool require_all = true){
+            File_* file = new File_(this, _handle, size, read_pointer, require_all, aligned);
+            switch(pointer_mode){
+                case pointer_mode::seprated:
+                    read_pointer += size;
+                    break;
+                case pointer_mode::combined:
+                    write_pointer = read_pointer = read_pointer + size;
+                    break;
+            }
+            return start(file);
+        }
+        ValueItem read(uint8_t* data, uint32_t size, bool require_all = true) {
+            File_* file = new File_(this, _handle, size, read_pointer, require_all, aligned);
+            switch(pointer_mode){
+                case pointer_mode::seprated:
+                    read_pointer += size;
+                    break;
+                case pointer_mode::combined:
+                    write_pointer = read_pointer = read_pointer + size;
+                    break;
+            }
+            ValueItem args((void*)file);
+            typed_lgr<Task> awaiter;
+            try{
+                awaiter = file->awaiter = Task::callback_dummy(args, file_overlapped_on_await, file_overlapped_on_cancel,nullptr, file_overlapped_on_destruct);
+                file->start();
+            }catch(...){
+                delete file;
+                throw;
+            }
+            auto res = Task::get_result(awaiter);
+            if(res->meta.vtype == VType::ui8) {
+                io_errors err = (io_errors)(uint8_t)*res;
+                delete res;
+                io_error_to_exception(err);
+                return nullptr;
+            }
+            else if (res->meta.vtype == VType::raw_arr_ui8){
+                auto arr = (uint8_t*)res->getSourcePtr();
+                uint32_t len = res->meta.val_len;
+                memcpy(data, arr, len);
+                delete res;
+                return len;
+            }
+            else if(res->meta.vtype == VType::noting){
+                delete res;
+                return 0;
+            }
+            else{
+                delete res;
+                throw InternalException("Caught invalid value type, excepted raw_arr_ui8, noting or except_value, but got " + std::to_string((int)res->meta.vtype));
+            }
+        }
+
+        ValueItem write(uint8_t* data, uint32_t size) {
+            File_* file = new File_(this, _handle, (char*)data, size, write_pointer, aligned);
+            switch(pointer_mode){
+                case pointer_mode::seprated:
+                    write_pointer += size;
+                    break;
+                case pointer_mode::combined:
+                    write_pointer = read_pointer = write_pointer + size;
+                    break;
+            }
+            return start(file);
+        }
+        ValueItem append(uint8_t* data, uint32_t size) {
+            //end of file unknown before write, so boundary block can not be merged
+            if(aligned && size % direct_io_alignment)
+                throw InvalidArguments("Append to file opened with no_buffering requires size aligned to " + std::to_string(direct_io_alignment));
+            return start(new File_(this, _handle, (char*)data, size, (uint64_t)-1, aligned));
+        }
+        ValueItem seek_pos(uint64_t offset, pointer_offset pointer_offset, pointer pointer){
+            switch (pointer_offset) {
+            case pointer_offset::begin:
+                switch(pointer_mode){
+                    case pointer_mode::seprated:
+                       switch(pointer){
+                            case pointer::read:
+                                read_pointer = offset;
+                                break;
+                            case pointer::write:
+                                write_pointer = offset;
+                                break;
+                        }
+                        break;
+                    case pointer_mode::combined:
+                        read_pointer = write_pointer = offset;
+                        break;
+                }
+                break;
+            case pointer_offset::current:
+                switch(pointer_mode){
+                    case pointer_mode::seprated:
+                        switch(pointer){
+                            case pointer::read:
+                                read_pointer += offset;
+                                break;
+                            case pointer::write:
+                                write_pointer += offset;
+                                break;
+                        }
+                        break;
+                    case pointer_mode::combined:
+                        read_pointer = write_pointer += offset;
+                        break;
+                }
+                break;
+            case pointer_offset::end:{
+                auto size = _file_size();
+                if(size != -1){
+                        switch(pointer_mode){
+                            case pointer_mode::seprated:
+                                switch(pointer){
+                                    case pointer::read:
+                                        read_pointer = size + offset;
+                                        break;
+                                    case pointer::write:
+                                        write_pointer = size + offset;
+                                        break;
+                                }
+                                break;
+                            case pointer_mode::combined:
+                                read_pointer = write_pointer = size + offset;
+                                break;
+                        }
+                    }
+                else return false;
+                break;
+            }
+            default:
+                break;
+            }
+            return true;
+        }
+        ValueItem seek_pos(uint64_t offset, pointer_offset pointer_offset) {
+            switch (pointer_offset) {
+            case pointer_offset::begin:
+                read_pointer = write_pointer = offset;
+                break;
+            case pointer_offset::current:
+                read_pointer = write_pointer += offset;
+                break;
+            case pointer_offset::end:{
+                auto size = _file_size();
+                if(size != -1)
+                    read_pointer = write_pointer = size + offset;
+                else return false;
+                break;
+            }
+            default:
+                break;
+            }
+            return true;
+        }
+        ValueItem tell_pos(pointer pointer){
+            switch (pointer) {
+            case pointer::read:
+                return read_pointer;
+            case pointer::write:
+                return write_pointer;
+            default:
+                return nullptr;
+            }
+        }
+
+        ValueItem flush(){
+            Sync_ sync(this);
+            MutexUnify unify(sync.mutex);
+            art::unique_lock<MutexUnify> lock(unify);
+            //completion key marks sync request
+            if(!NativeWorkersSingleton::submit(&sync, &sync, NativeWorkersSingleton::prepare_fsync(_handle)))
+                return false;
+            while(!sync.fullifed)
+                sync.awaiters.wait(lock);
+            return sync.result >= 0;
+        }
+        ValueItem file_size(){
+            auto res = _file_size();
+            if(res == -1)
+                return nullptr;
+            else
+                return res;
+        }
+        void handle(void* data, class NativeWorkerHandle* overlapped, unsigned long dwBytesTransferred, bool status){
+            if(data == &File_::cancel_key){
+                //cancelled request reports own completion
+                delete overlapped;
+                return;
+            }
+            if(data == overlapped){
+                Sync_& sync = *(Sync_*)overlapped;
+                MutexUnify unify(sync.mutex);
+                art::unique_lock<MutexUnify> lock(unify);
+                sync.fullifed = true;
+                sync.awaiters.notify_all();
+                return;
+            }
+            auto file = (File_*)overlapped;
+            if(!status)
+                file->error_filter();
+            else
+                file->operation_fullifed(dwBytesTransferred);
+        }
+        void* get_handle(){
+            return (void*)(intptr_t)_handle;
+        }
+    };
+#endif
     
 
     FileHandle::FileHandle(const char* path, size_t path_len, open_mode open, on_open_action action, _async_flags flags, share_mode share, pointer_mode pointer_mode) noexcept(false){
         _sync_flags sync_flags;
+        sync_flags.value = 0;
         sync_flags.delete_on_close = flags.delete_on_close;
         sync_flags.posix_semantics = flags.posix_semantics;
         sync_flags.random_access = flags.random_access;
@@ -660,6 +1273,7 @@ namespace files {
         return handle->get_handle();
     }
 
+#if defined(_WIN32) || defined(_WIN64)
     BlockingFileHandle::BlockingFileHandle(const char* path, size_t path_len, open_mode open, on_open_action action, _sync_flags flags, share_mode share) noexcept(false) : open(open), flags(flags){
         std::u16string wpath;
         utf8::utf8to16(path, path + path_len, std::back_inserter(wpath));
@@ -752,6 +1366,7 @@ namespace files {
     }
     int64_t BlockingFileHandle::read(uint8_t* data, uint32_t size){
         art::lock_guard<TaskMutex> lock(mutex);
+        TaskBlockingRegion blocking;
         DWORD readed;
         if(!ReadFile(handle, data, size, &readed, NULL)){
             switch(GetLastError()){
@@ -791,6 +1406,7 @@ namespace files {
     }
     int64_t BlockingFileHandle::write(uint8_t* data, uint32_t size){
         art::lock_guard<TaskMutex> lock(mutex);
+        TaskBlockingRegion blocking;
         DWORD written;
         if(!WriteFile(handle, data, size, &written, NULL)){
             switch(GetLastError()){
@@ -844,6 +1460,7 @@ namespace files {
     }
     bool BlockingFileHandle::flush(){
         art::lock_guard<TaskMutex> lock(mutex);
+        TaskBlockingRegion blocking;
         return FlushFileBuffers(handle);
     }
     uint64_t BlockingFileHandle::size(){
@@ -853,6 +1470,110 @@ namespace files {
             return 0;
         return li.QuadPart;
     }
+#else
+    BlockingFileHandle::BlockingFileHandle(const char* path, size_t path_len, open_mode open, on_open_action action, _sync_flags flags, share_mode share) noexcept(false) : open(open), flags(flags){
+        //descriptor stored in handle, share mode not supported by posix
+        handle = (void*)(intptr_t)open_file(path, path_len, open, action, flags);
+    }
+    BlockingFileHandle::~BlockingFileHandle(){
+        if(handle)
+            ::close((int)(intptr_t)handle);
+    }
+    int64_t BlockingFileHandle::read(uint8_t* data, uint32_t size){
+        art::lock_guard<TaskMutex> lock(mutex);
+        TaskBlockingRegion blocking;
+        ssize_t readed = ::read((int)(intptr_t)handle, data, size);
+        if(readed == -1){
+            switch(errno){
+                case EFAULT:
+                case EINVAL:
+                    throw AException("FileException", "Invalid user buffer");
+                case ENOMEM:
+                    throw AException("FileException", "Not enough memory");
+                case EINTR:
+                    throw AException("FileException", "Operation aborted");
+                case EBADF:
+                    throw AException("FileException", "Invalid handle");
+                case EIO:
+                    throw AException("FileException", "IO device error");
+                case EAGAIN:
+                    throw AException("FileException", "IO pending");
+                case EISDIR:
+                    throw AException("FileException", "Not supported");
+                default:
+                    throw AException("FileException", "Unknown error");
+            }
+        }
+        if(readed == 0 && size)
+            eof = true;
+        return readed;
+    }
+    int64_t BlockingFileHandle::write(uint8_t* data, uint32_t size){
+        art::lock_guard<TaskMutex> lock(mutex);
+        TaskBlockingRegion blocking;
+        ssize_t written = ::write((int)(intptr_t)handle, data, size);
+        if(written == -1){
+            switch(errno){
+                case EFAULT:
+                case EINVAL:
+                    throw AException("FileException", "Invalid user buffer");
+                case ENOMEM:
+                    throw AException("FileException", "Not enough memory");
+                case EINTR:
+                    throw AException("FileException", "Operation aborted");
+                case EBADF:
+                    throw AException("FileException", "Invalid handle");
+                case EIO:
+                    throw AException("FileException", "IO device error");
+                case EAGAIN:
+                    throw AException("FileException", "IO pending");
+                case EDQUOT:
+                case ENOSPC:
+                    throw AException("FileException", "No enough quota");
+                case EFBIG:
+                    throw AException("FileException", "File too large");
+                case EPERM:
+                    throw AException("FileException", "Write protect");
+                default:
+                    throw AException("FileException", "Unknown error");
+            }
+        }
+        return written;
+    }
+    bool BlockingFileHandle::seek_pos(uint64_t offset, pointer_offset pointer_offset){
+        art::lock_guard<TaskMutex> lock(mutex);
+        int whence;
+        switch (pointer_offset) {
+            case pointer_offset::begin: whence = SEEK_SET; break;
+            case pointer_offset::current: whence = SEEK_CUR; break;
+            case pointer_offset::end: whence = SEEK_END; break;
+            default: return false;
+        }
+        if(lseek((int)(intptr_t)handle, (off_t)offset, whence) == -1)
+            return false;
+        eof = false;
+        return true;
+    }
+    uint64_t BlockingFileHandle::tell_pos(){
+        art::lock_guard<TaskMutex> lock(mutex);
+        off_t pos = lseek((int)(intptr_t)handle, 0, SEEK_CUR);
+        if(pos == -1)
+            return 0;
+        return pos;
+    }
+    bool BlockingFileHandle::flush(){
+        art::lock_guard<TaskMutex> lock(mutex);
+        TaskBlockingRegion blocking;
+        return fsync((int)(intptr_t)handle) == 0;
+    }
+    uint64_t BlockingFileHandle::size(){
+        art::lock_guard<TaskMutex> lock(mutex);
+        struct stat file_stat;
+        if(fstat((int)(intptr_t)handle, &file_stat) == -1)
+            return 0;
+        return file_stat.st_size;
+    }
+#endif
     void* BlockingFileHandle::internal_get_handle() const noexcept{
         return handle;
     }
@@ -903,6 +1624,241 @@ namespace files {
     }
 #endif
 
+#if defined(_WIN32) || defined(_WIN64)
+    MappedFile::MappedFile(const char* path, size_t path_len, bool writable) noexcept(false) : writable(writable){
+        std::u16string wpath;
+        utf8::utf8to16(path, path + path_len, std::back_inserter(wpath));
+        HANDLE file = CreateFileW((wchar_t*)wpath.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(file == INVALID_HANDLE_VALUE){
+            switch(GetLastError()){
+                case ERROR_FILE_NOT_FOUND:
+                    throw AException("FileException", "File not found");
+                case ERROR_ACCESS_DENIED:
+                    throw AException("FileException", "Access denied");
+                case ERROR_SHARING_VIOLATION:
+                    throw AException("FileException", "Sharing violation");
+                default:
+                    throw AException("FileException", "Unknown error");
+            }
+        }
+        LARGE_INTEGER li;
+        if(!GetFileSizeEx(file, &li)){
+            CloseHandle(file);
+            throw AException("FileException", "Unknown error");
+        }
+        length = li.QuadPart;
+        if(length == 0){
+            //empty file can not be mapped, views of it always empty
+            CloseHandle(file);
+            return;
+        }
+        handle = CreateFileMappingW(file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+        //mapping object holds file, handle not needed anymore
+        CloseHandle(file);
+        if(!handle)
+            throw AException("FileException", "Failed to create file mapping");
+        data = MapViewOfFile(handle, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+        if(!data){
+            CloseHandle(handle);
+            handle = nullptr;
+            throw AException("FileException", "Failed to map file");
+        }
+    }
+    MappedFile::~MappedFile(){
+        if(data)
+            UnmapViewOfFile(data);
+        if(handle)
+            CloseHandle(handle);
+    }
+    bool MappedFile::advise(uint64_t offset, uint64_t length, access_hint hint){
+        if(offset >= this->length)
+            return false;
+        if(length > this->length - offset)
+            length = this->length - offset;
+        switch (hint) {
+            case access_hint::will_need:{
+                WIN32_MEMORY_RANGE_ENTRY entry;
+                entry.VirtualAddress = (char*)data + offset;
+                entry.NumberOfBytes = length;
+                return PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+            }
+            case access_hint::dont_need:{
+                //discard works on whole pages, dirty pages flushed first so file keeps data
+                SYSTEM_INFO info;
+                GetSystemInfo(&info);
+                uint64_t page_size = info.dwPageSize;
+                uint64_t aligned_offset = offset & ~(page_size - 1);
+                length += offset - aligned_offset;
+                if(writable && !FlushViewOfFile((char*)data + aligned_offset, length))
+                    return false;
+                return DiscardVirtualMemory((char*)data + aligned_offset, length) == ERROR_SUCCESS;
+            }
+            default:
+                //windows has no access pattern hints for mapped views
+                return true;
+        }
+    }
+    bool MappedFile::flush(){
+        if(!data)
+            return true;
+        return FlushViewOfFile(data, 0);
+    }
+#else
+    MappedFile::MappedFile(const char* path, size_t path_len, bool writable) noexcept(false) : writable(writable){
+        std::string spath(path, path_len);
+        int file = ::open(spath.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+        if(file == -1){
+            switch(errno){
+                case ENOENT:
+                    throw AException("FileException", "File not found");
+                case EACCES:
+                case EPERM:
+                    throw AException("FileException", "Access denied");
+                default:
+                    throw AException("FileException", "Unknown error");
+            }
+        }
+        struct stat file_stat;
+        if(fstat(file, &file_stat) == -1){
+            ::close(file);
+            throw AException("FileException", "Unknown error");
+        }
+        length = file_stat.st_size;
+        if(length == 0){
+            //empty file can not be mapped, views of it always empty
+            ::close(file);
+            return;
+        }
+        data = mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0);
+        //mapping holds file, descriptor not needed anymore
+        ::close(file);
+        if(data == MAP_FAILED){
+            data = nullptr;
+            throw AException("FileException", "Failed to map file");
+        }
+    }
+    MappedFile::~MappedFile(){
+        if(data)
+            munmap(data, length);
+    }
+    bool MappedFile::advise(uint64_t offset, uint64_t length, access_hint hint){
+        if(offset >= this->length)
+            return false;
+        if(length > this->length - offset)
+            length = this->length - offset;
+        //madvise requires page aligned address
+        uint64_t page_size = sysconf(_SC_PAGESIZE);
+        uint64_t aligned_offset = offset & ~(page_size - 1);
+        length += offset - aligned_offset;
+        int advice;
+        switch (hint) {
+            case access_hint::normal: advice = MADV_NORMAL; break;
+            case access_hint::sequential: advice = MADV_SEQUENTIAL; break;
+            case access_hint::random: advice = MADV_RANDOM; break;
+            case access_hint::will_need: advice = MADV_WILLNEED; break;
+            case access_hint::dont_need: advice = MADV_DONTNEED; break;
+            default: return false;
+        }
+        return madvise((char*)data + aligned_offset, length, advice) == 0;
+    }
+    bool MappedFile::flush(){
+        if(!data)
+            return true;
+        return msync(data, length, MS_SYNC) == 0;
+    }
+#endif
+    typed_lgr<MappedView> MappedFile::view(const typed_lgr<MappedFile>& mapping, uint64_t offset, uint32_t length, VType type){
+        uint64_t element_size;
+        switch (type) {
+            case VType::raw_arr_i8:
+            case VType::raw_arr_ui8:
+                element_size = 1;
+                break;
+            case VType::raw_arr_i16:
+            case VType::raw_arr_ui16:
+                element_size = 2;
+                break;
+            case VType::raw_arr_i32:
+            case VType::raw_arr_ui32:
+            case VType::raw_arr_flo:
+                element_size = 4;
+                break;
+            case VType::raw_arr_i64:
+            case VType::raw_arr_ui64:
+            case VType::raw_arr_doub:
+                element_size = 8;
+                break;
+            default:
+                throw InvalidArguments("Excepted raw_arr_* type, got " + enum_to_string(type));
+        }
+        if(offset % element_size)
+            throw InvalidArguments("Offset must be aligned to element size");
+        if(offset > mapping->length || (mapping->length - offset) / element_size < length)
+            throw OutOfRange("View out of file bounds");
+        void* data = length ? (char*)mapping->data + offset : nullptr;
+        return new MappedView(mapping, data, length, type, mapping->writable);
+    }
+    uint64_t MappedFile::size() const noexcept{
+        return length;
+    }
+    void* MappedFile::internal_get_data() const noexcept{
+        return data;
+    }
+
+    MappedView::MappedView(const typed_lgr<MappedFile>& mapping, void* data, uint32_t length, VType type, bool writable)
+        : mapping(mapping), data(data), length(length), type(type), writable(writable){}
+    ValueItem MappedView::get(uint32_t index) const{
+        if(index >= length)
+            throw OutOfRange("Index out of view bounds");
+        switch (type) {
+            case VType::raw_arr_i8: return ((int8_t*)data)[index];
+            case VType::raw_arr_ui8: return ((uint8_t*)data)[index];
+            case VType::raw_arr_i16: return ((int16_t*)data)[index];
+            case VType::raw_arr_ui16: return ((uint16_t*)data)[index];
+            case VType::raw_arr_i32: return ((int32_t*)data)[index];
+            case VType::raw_arr_ui32: return ((uint32_t*)data)[index];
+            case VType::raw_arr_flo: return ((float*)data)[index];
+            case VType::raw_arr_i64: return ((int64_t*)data)[index];
+            case VType::raw_arr_ui64: return ((uint64_t*)data)[index];
+            case VType::raw_arr_doub: return ((double*)data)[index];
+            default: return nullptr;
+        }
+    }
+    void MappedView::set(uint32_t index, ValueItem& value){
+        if(!writable)
+            throw InvalidOperation("Mapping is read only");
+        if(index >= length)
+            throw OutOfRange("Index out of view bounds");
+        switch (type) {
+            case VType::raw_arr_i8: ((int8_t*)data)[index] = (int8_t)value; break;
+            case VType::raw_arr_ui8: ((uint8_t*)data)[index] = (uint8_t)value; break;
+            case VType::raw_arr_i16: ((int16_t*)data)[index] = (int16_t)value; break;
+            case VType::raw_arr_ui16: ((uint16_t*)data)[index] = (uint16_t)value; break;
+            case VType::raw_arr_i32: ((int32_t*)data)[index] = (int32_t)value; break;
+            case VType::raw_arr_ui32: ((uint32_t*)data)[index] = (uint32_t)value; break;
+            case VType::raw_arr_flo: ((float*)data)[index] = (float)value; break;
+            case VType::raw_arr_i64: ((int64_t*)data)[index] = (int64_t)value; break;
+            case VType::raw_arr_ui64: ((uint64_t*)data)[index] = (uint64_t)value; break;
+            case VType::raw_arr_doub: ((double*)data)[index] = (double)value; break;
+            default: break;
+        }
+    }
+    ValueItem MappedView::copy() const{
+        return ValueItem(data, ValueMeta(type, false, true, length));
+    }
+    ValueItem MappedView::reference(const typed_lgr<MappedView>& view){
+        //counters and view in one block, released with last link, so array memory never outlives mapping
+        struct reference_block{
+            lgr_block counters;
+            typed_lgr<MappedView> view;
+        };
+        reference_block* block = new reference_block{{{1}, {0}, [](void* ptr){ delete (reference_block*)ptr; }}, view};
+        return ValueItem(new lgr(&block->counters, view->data, nullptr, nullptr), ValueMeta(view->type, true, view->writable, view->length), no_copy);
+    }
+    uint32_t MappedView::size() const noexcept{
+        return length;
+    }
+
     
 
     class FolderBrowserImpl{
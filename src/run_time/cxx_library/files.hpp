@@ -130,6 +130,44 @@ namespace files {
         // can cause desync, ie thread unsafe
     };
 
+    class MappedFile { //whole file mapped to memory, views hold mapping alive
+        void* data = nullptr;
+        void* handle = nullptr;//file mapping object in windows
+        uint64_t length = 0;
+        bool writable;
+    public:
+        enum class access_hint : uint8_t {
+            normal,
+            sequential,
+            random,
+            will_need,
+            dont_need
+        };
+        MappedFile(const char* path, size_t path_len, bool writable = false) noexcept(false);
+        ~MappedFile();
+        //length in elements of type, type must be raw_arr_*, no copy performed, view holds reference to mapping
+        static typed_lgr<class MappedView> view(const typed_lgr<MappedFile>& mapping, uint64_t offset, uint32_t length, VType type = VType::raw_arr_ui8);
+        bool advise(uint64_t offset, uint64_t length, access_hint hint);
+        bool flush();
+        uint64_t size() const noexcept;
+        void* internal_get_data() const noexcept;
+    };
+    class MappedView { //part of mapping, mapping not unmapped while view alive
+        typed_lgr<MappedFile> mapping;
+        void* data;
+        uint32_t length;
+        VType type;
+        bool writable;
+    public:
+        MappedView(const typed_lgr<MappedFile>& mapping, void* data, uint32_t length, VType type, bool writable);
+        ValueItem get(uint32_t index) const;
+        void set(uint32_t index, ValueItem& value);
+        ValueItem copy() const;//raw array with own memory
+        //raw array over view memory without copy, value holds view, so mapping stays while any copy of value alive
+        static ValueItem reference(const typed_lgr<MappedView>& view);
+        uint32_t size() const noexcept;
+    };
+
     class FolderBrowser{
         class FolderBrowserImpl* impl;
         FolderBrowser(class FolderBrowserImpl* impl) noexcept;
@@ -23,11 +23,6 @@ void init_define_TcpNetworkBlocking();
 #include <mswsock.h>
 #include <stdio.h>
 #pragma comment(lib, "Ws2_32.lib")
-
-#include "networking.hpp"
-#include "../asm/FuncEnvironment.hpp"
-#include "../../../configuration/agreement/symbols.hpp"
-#include <condition_variable>
 #include <utf8cpp/utf8.h>
 LPFN_ACCEPTEX _AcceptEx;
 LPFN_GETACCEPTEXSOCKADDRS _GetAcceptExSockaddrs;
@@ -61,6 +56,27 @@ void init_win_fns(SOCKET sock){
 
 	inited = true;
 }
+#else
+#include "../tasks_util/native_workers_singleton.hpp"
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+typedef int SOCKET;
+#define INVALID_SOCKET -1
+#define SOCKET_ERROR -1
+inline int closesocket(SOCKET socket){
+	return ::close(socket);
+}
+#endif
+#include "networking.hpp"
+#include "../asm/FuncEnvironment.hpp"
+#include "../../../configuration/agreement/symbols.hpp"
+#include <condition_variable>
 
 
 
@@ -258,6 +274,7 @@ void get_address_from_valueItem(ValueItem& ip_port, universal_address& addr_stor
 }
 
 #pragma region TCP
+#if defined(_WIN32) || defined(_WIN64)
 struct tcp_handle : public NativeWorkerHandle {
 	std::list<std::tuple<char*, size_t>> write_queue;
 	std::list<std::tuple<char*, size_t>> read_queue;
@@ -744,109 +761,535 @@ private:
 		return res;
 	}
 };
+#else
+//every operation submitted to io_uring and waiting task suspended on cv, so workers not blocked by socket
+struct tcp_handle : public NativeWorkerHandle {
+	std::list<std::tuple<char*, size_t>> write_queue;
+	TaskConditionVariable cv;
+	TaskMutex cv_mutex;
+	SOCKET socket;
+	struct {
+		char* buf;
+		uint32_t len;
+	} buffer;
+	char* data;
+	int total_bytes;
+	int sent_bytes;
+	int readed_bytes;
+	int data_len;
+	enum class error : uint8_t{
+		none = 0,
+		remote_close = 1,
+		local_close = 2,
+		local_reset = 3,
+		read_queue_overflow = 4,
+		invalid_state = 5,
+		undefined_error = 0xFF
+	} invalid_reason = error::none;
+	enum class Opcode : uint8_t{
+		ACCEPT,
+		READ,
+		WRITE,
+		TRANSMIT_FILE,
+		INTERNAL_READ,
+		INTERNAL_CLOSE
+	} opcode = Opcode::ACCEPT;
+	//set while client connect submitted and not completed
+	bool connecting = false;
 
-
-
-
-#pragma region TcpNetworkStream
-class TcpNetworkStream{
-	friend class TcpNetworkManager;
-	struct tcp_handle* handle;
-	TaskMutex mutex;
-	tcp_handle::error last_error;
-	bool checkup(){
-		if(!handle)
+	tcp_handle(SOCKET socket, int32_t buffer_len, NativeWorkerManager* manager, uint32_t read_queue_size = 10) : socket(socket), NativeWorkerHandle(manager){
+		if(buffer_len < 0)
+			throw InvalidArguments("buffer_len must be positive");
+		data = new char[buffer_len];
+		buffer.buf = data;
+		buffer.len = buffer_len;
+		data_len = buffer_len;
+		total_bytes = 0;
+		sent_bytes = 0;
+		readed_bytes = 0;
+	}
+	~tcp_handle(){
+		close();
+	}
+	uint32_t available_bytes(){
+		if(!data)
+			return 0;
+		if(readed_bytes)
+			return readed_bytes;
+		int value = 0;
+		if(ioctl(socket, FIONREAD, &value) == SOCKET_ERROR)
+			return 0;
+		else
+			return value;
+	}
+	bool data_available(){
+		return available_bytes() > 0;
+	}
+	void send_data(const char* data, int len){
+		if(!data)
+			return;
+		char* new_data = new char[len];
+		memcpy(new_data, data, len);
+		write_queue.push_back(std::make_tuple(new_data, len));
+	}
+	bool send_queue_item(){
+		if(!data)
 			return false;
-		if(!handle->valid()){
-			last_error = handle->invalid_reason;
-			delete handle;
-			handle = nullptr;
+		if(write_queue.empty())
 			return false;
+		auto item = write_queue.front();
+		write_queue.pop_front();
+		char* send_data = std::get<0>(item);
+		size_t val_len = std::get<1>(item);
+		std::unique_ptr<char[]> send_data_ptr(send_data);
+		while(val_len) {
+			size_t to_sent_bytes = val_len > data_len ? data_len : val_len;
+			memcpy(data, send_data, to_sent_bytes);
+			buffer.buf = data;
+			buffer.len = to_sent_bytes;
+			if(!send_await())
+				return false;
+			val_len -= to_sent_bytes;
+			send_data += to_sent_bytes;
 		}
 		return true;
 	}
-public:
-	TcpNetworkStream(tcp_handle* handle):handle(handle), last_error(tcp_handle::error::none){}
-	~TcpNetworkStream(){
-		if(handle){
-			std::lock_guard lg(mutex);
-			handle->close();
-			delete handle;
+
+
+	void read_force(uint32_t buffer_len, char* buffer){
+		if(!buffer_len)
+			return;
+		if(!buffer)
+			return;
+		while(buffer_len && data){
+			int readed = 0;
+			read_available(buffer, buffer_len, readed);
+			buffer += readed;
+			buffer_len -= readed;
 		}
-		handle = nullptr;
+	}
+	int64_t write_force(char* to_write, uint32_t to_write_len){
+		if(!data)
+			return -1;
+		if(!to_write_len)
+			return -1;
+		if(!to_write)
+			return -1;
+		uint32_t to_sent_bytes = data_len < to_write_len ? data_len : to_write_len;
+		memcpy(data, to_write, to_sent_bytes);
+		buffer.buf = data;
+		buffer.len = to_sent_bytes;
+		if(!send_await())
+			return -1;
+		return sent_bytes;
 	}
 
-	ValueItem read_available_ref(){
-		std::lock_guard lg(mutex);
-		if(!handle)
-			return nullptr;
-		while(!handle->data_available()){
-			if(!handle->send_queue_item())
-				break;
+
+	void read_data(){
+		if(!data)
+			return;
+		MutexUnify mutex(cv_mutex);
+		art::unique_lock<MutexUnify> lock(mutex);
+		opcode = Opcode::READ;
+		if(read()){
+			cv.wait(lock);
+			return;
 		}
-		if(!checkup())
-			return ValueItem(nullptr, ValueMeta(VType::raw_arr_ui8, false, false, 0) , as_refrence);
-		int readed = 0; 
-		char* data = handle->read_available_no_copy(readed);
-		return ValueItem(data, ValueMeta(VType::raw_arr_ui8, false, false, readed) , as_refrence);
+		lock.unlock();
+		close(invalid_reason);
 	}
-	ValueItem read_available(char* buffer, int buffer_len){
-		std::lock_guard lg(mutex);
-		if(!handle)
-			return nullptr;
-		while(!handle->data_available()){
-			if(!handle->send_queue_item())
-				break;
+	void read_available(char* extern_buffer, int buffer_len, int& readed){
+		if(!readed_bytes)
+			read_data();
+		if(readed_bytes < buffer_len){
+			readed = readed_bytes;
+			memcpy(extern_buffer, buffer.buf, readed_bytes);
+			readed_bytes = 0;
+		}
+		else{
+			readed = buffer_len;
+			memcpy(extern_buffer, buffer.buf, buffer_len);
+			readed_bytes -= buffer_len;
+			buffer.buf += buffer_len;
+			buffer.len -= buffer_len;
 		}
-		
-		if(!checkup())
-			return (uint32_t)0;
-		int readed = 0; 
-		handle->read_available(buffer, buffer_len, readed);
-		return ValueItem((uint32_t)readed);
 	}
-	bool data_available(){
-		std::lock_guard lg(mutex);
-		if(handle)
-			return handle->data_available();
-		return false;
+	char* read_available_no_copy(int& readed){
+		if(!readed_bytes)
+			read_data();
+		readed = readed_bytes;
+		readed_bytes = 0;
+		return buffer.buf;
 	}
-	void write(char* data, size_t size){
-		std::lock_guard lg(mutex);
-		if(handle){
-			handle->send_data(data, size);
-			while(!handle->data_available()){
-				if(!handle->send_queue_item())
-					break;
+
+
+	void close(error err = error::local_close){
+		if(!data)
+			return;
+		pre_close(err);
+		internal_close();
+	}
+	//called from NativeWorkersSingleton dispatcher with positive result
+	void handle(unsigned long dwBytesTransferred){
+		MutexUnify mutex(cv_mutex);
+		art::unique_lock<MutexUnify> lock(mutex);
+		switch (opcode) {
+		case Opcode::READ:
+			buffer.buf = data;
+			buffer.len = data_len;
+			readed_bytes = dwBytesTransferred;
+			cv.notify_all();
+			break;
+		case Opcode::WRITE:
+			sent_bytes += dwBytesTransferred;
+			if(sent_bytes < total_bytes){
+				//partial send, continue from dispatcher without waking task
+				buffer.buf += dwBytesTransferred;
+				buffer.len -= dwBytesTransferred;
+				if(!send())
+					cv.notify_all();
 			}
-			checkup();
+			else cv.notify_all();
+			break;
+		case Opcode::ACCEPT:
+			connecting = false;
+			cv.notify_all();
+			break;
+		case Opcode::TRANSMIT_FILE:
+			cv.notify_all();
+			break;
+		default:
+			break;
 		}
 	}
-	bool write_file(char* path, size_t path_len, uint64_t data_len, uint64_t offset, uint32_t chunks_size){
-		std::lock_guard lg(mutex);
-		if(handle){
-			while(handle->valid())if(!handle->send_queue_item())break;
-			
-			if(!checkup())
-				return false;
-			
-			return handle->send_file(path, path_len, data_len, offset, chunks_size);
+
+	void send_and_close(char* data, int len){
+		if(!this->data)
+			return;
+		write_queue = {};
+		while(len && this->data) {
+			int to_sent_bytes = data_len < len ? data_len : len;
+			memcpy(this->data, data, to_sent_bytes);
+			buffer.buf = this->data;
+			buffer.len = to_sent_bytes;
+			if(!send_await())
+				return;
+			data += to_sent_bytes;
+			len -= to_sent_bytes;
 		}
-		return false;
+		close();
 	}
-	bool write_file(void* fhandle, uint64_t data_len, uint64_t offset, uint32_t chunks_size){
-		std::lock_guard lg(mutex);
-		if(handle){
-			while(handle->valid())if(!handle->send_queue_item())break;
-			if(!checkup())
+
+	//file is file descriptor casted to pointer
+	bool send_file(void* file, uint64_t data_len, uint64_t offset, uint32_t chunks_size){
+		if(!data)
+			return false;
+		if(chunks_size == 0)
+			chunks_size = 0x1000;
+		int fd = (int)(intptr_t)file;
+		if(data_len == 0){
+			struct stat file_stat;
+			if(fstat(fd, &file_stat) == -1 || (uint64_t)file_stat.st_size < offset)
 				return false;
-			return handle->send_file(fhandle, data_len, offset, chunks_size);
+			data_len = file_stat.st_size - offset;
 		}
-		return false;
+		return transfer_file(fd, data_len, chunks_size, offset);
 	}
-	//write all data from write_queue
-	void force_write(){
-		std::lock_guard lg(mutex);
+	bool send_file(const char* path, size_t path_len, uint64_t data_len, uint64_t offset, uint32_t chunks_size){
+		if(!data)
+			return false;
+		std::string spath(path, path_len);
+		int file = open(spath.c_str(), O_RDONLY | O_CLOEXEC);
+		if(file == -1)
+			return false;
+		posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+		bool result;
+		try{
+			result = send_file((void*)(intptr_t)file, data_len, offset, chunks_size);
+		}catch(...){
+			::close(file);
+			throw;
+		}
+		::close(file);
+		return result;
+	}
+
+	bool valid(){
+		return data != nullptr;
+	}
+
+	void reset(){
+		if(!data)
+			return;
+		pre_close(error::local_reset);
+		//zero linger makes close send RST and drop unsent data
+		linger lin;
+		lin.l_onoff = 1;
+		lin.l_linger = 0;
+		setsockopt(socket, SOL_SOCKET, SO_LINGER, (char*)&lin, sizeof(lin));
+		closesocket(socket);
+		socket = INVALID_SOCKET;
+	}
+	void connection_reset(){
+		MutexUnify mutex(cv_mutex);
+		art::unique_lock<MutexUnify> lock(mutex);
+		delete[] data;
+		data = nullptr;
+		invalid_reason = result == 0 || result == -ECONNRESET ? error::remote_close : error::undefined_error;
+		readed_bytes = 0;
+		if(socket != INVALID_SOCKET){
+			closesocket(socket);
+			socket = INVALID_SOCKET;
+		}
+		cv.notify_all();
+	}
+	void rebuffer(int32_t buffer_len){
+		if(!data)
+			return;
+		if(buffer_len < 0)
+			throw InvalidArguments("buffer_len must be positive");
+		char* new_data = new char[buffer_len];
+		if(readed_bytes)
+			memcpy(new_data, buffer.buf, readed_bytes < buffer_len ? readed_bytes : buffer_len);
+		if(readed_bytes > buffer_len)
+			readed_bytes = buffer_len;
+		delete[] data;
+		data = new_data;
+		data_len = buffer_len;
+		buffer.buf = data;
+		buffer.len = data_len;
+	}
+
+private:
+	void pre_close(error err){
+		std::list<std::tuple<char*, size_t>> clear_write_queue;
+		write_queue.swap(clear_write_queue);
+		for(auto& item : clear_write_queue)
+			delete[] std::get<0>(item);
+		MutexUnify mutex(cv_mutex);
+		art::unique_lock<MutexUnify> lock(mutex);
+		readed_bytes = 0;
+		sent_bytes = 0;
+		delete[] data;
+		data = nullptr;
+		invalid_reason = err;
+		cv.notify_all();
+	}
+	void internal_close(){
+		MutexUnify mutex(cv_mutex);
+		art::unique_lock<MutexUnify> lock(mutex);
+		if(socket == INVALID_SOCKET)
+			return;
+		opcode = Opcode::INTERNAL_CLOSE;
+		::shutdown(socket, SHUT_RDWR);
+		closesocket(socket);
+		socket = INVALID_SOCKET;
+	}
+	//must be called under cv_mutex, false if operation not submitted
+	bool read(){
+		buffer.buf = data;
+		buffer.len = data_len;
+		if(!NativeWorkersSingleton::submit(this, nullptr, NativeWorkersSingleton::prepare_recv(socket, data, data_len))){
+			invalid_reason = error::undefined_error;
+			return false;
+		}
+		return true;
+	}
+	bool send(){
+		opcode = Opcode::WRITE;
+		if(!NativeWorkersSingleton::submit(this, nullptr, NativeWorkersSingleton::prepare_send(socket, buffer.buf, buffer.len, MSG_NOSIGNAL))){
+			invalid_reason = error::undefined_error;
+			return false;
+		}
+		return true;
+	}
+	bool send_await(){
+		MutexUnify mutex(cv_mutex);
+		art::unique_lock<MutexUnify> lock(mutex);
+		sent_bytes = 0;
+		total_bytes = buffer.len;
+		if(!send()){
+			lock.unlock();
+			close(invalid_reason);
+			return false;
+		}
+		cv.wait(lock);
+		return data && sent_bytes >= total_bytes;//if data is null, then socket is closed
+	}
+	//returns moved bytes or -errno, completion with zero or negative result not treated as disconnect for this opcode
+	int32_t splice_await(int fd_in, int64_t offset_in, int fd_out, uint32_t len){
+		MutexUnify mutex(cv_mutex);
+		art::unique_lock<MutexUnify> lock(mutex);
+		opcode = Opcode::TRANSMIT_FILE;
+		if(!NativeWorkersSingleton::submit(this, nullptr, NativeWorkersSingleton::prepare_splice(fd_in, offset_in, fd_out, -1, len, SPLICE_F_MOVE)))
+			return -EAGAIN;
+		cv.wait(lock);
+		return result;
+	}
+	//zero copy, pages moved from page cache to socket through pipe, file never touches user buffers
+	bool transfer_file(int file, uint64_t data_len, uint32_t chunks_size, uint64_t offset){
+		int pipe_fds[2];
+		if(pipe2(pipe_fds, O_CLOEXEC) == -1)
+			return copy_file(file, data_len, chunks_size, offset);
+		if(chunks_size > 0x10000)
+			fcntl(pipe_fds[1], F_SETPIPE_SZ, chunks_size);
+		int pipe_size = fcntl(pipe_fds[1], F_GETPIPE_SZ);
+		if(pipe_size <= 0)
+			pipe_size = 0x10000;
+		bool first = true;
+		bool res = true;
+		while(data_len && res){
+			uint32_t to_move = data_len > (uint64_t)pipe_size ? pipe_size : (uint32_t)data_len;
+			int32_t moved = splice_await(file, offset, pipe_fds[1], to_move);
+			if(moved <= 0){
+				//file system or file type not support splice, nothing sended yet so copy can be used
+				if(first && (moved == -EINVAL || moved == -ENOSYS || moved == -EOPNOTSUPP)){
+					closesocket(pipe_fds[0]);
+					closesocket(pipe_fds[1]);
+					return copy_file(file, data_len, chunks_size, offset);
+				}
+				res = false;
+				break;
+			}
+			first = false;
+			offset += moved;
+			data_len -= moved;
+			while(moved){
+				int32_t sended = splice_await(pipe_fds[0], -1, socket, moved);
+				if(sended <= 0){
+					res = false;
+					break;
+				}
+				moved -= sended;
+			}
+		}
+		closesocket(pipe_fds[0]);
+		closesocket(pipe_fds[1]);
+		return res && data;
+	}
+	//chunked fallback, file readed to connection buffer and sended from it
+	bool copy_file(int file, uint64_t data_len, uint32_t chunks_size, uint64_t offset){
+		if(chunks_size > (uint32_t)this->data_len)
+			chunks_size = this->data_len;
+		while(data_len){
+			uint32_t to_read = data_len > chunks_size ? chunks_size : (uint32_t)data_len;
+			ssize_t readed = pread(file, data, to_read, offset);
+			if(readed <= 0)
+				return false;
+			buffer.buf = data;
+			buffer.len = (uint32_t)readed;
+			if(!send_await())
+				return false;
+			data_len -= readed;
+			offset += readed;
+		}
+		return true;
+	}
+};
+#endif
+
+
+
+
+#pragma region TcpNetworkStream
+class TcpNetworkStream{
+	friend class TcpNetworkManager;
+	struct tcp_handle* handle;
+	TaskMutex mutex;
+	tcp_handle::error last_error;
+	bool checkup(){
+		if(!handle)
+			return false;
+		if(!handle->valid()){
+			last_error = handle->invalid_reason;
+			delete handle;
+			handle = nullptr;
+			return false;
+		}
+		return true;
+	}
+public:
+	TcpNetworkStream(tcp_handle* handle):handle(handle), last_error(tcp_handle::error::none){}
+	~TcpNetworkStream(){
+		if(handle){
+			std::lock_guard lg(mutex);
+			handle->close();
+			delete handle;
+		}
+		handle = nullptr;
+	}
+
+	ValueItem read_available_ref(){
+		std::lock_guard lg(mutex);
+		if(!handle)
+			return nullptr;
+		while(!handle->data_available()){
+			if(!handle->send_queue_item())
+				break;
+		}
+		if(!checkup())
+			return ValueItem(nullptr, ValueMeta(VType::raw_arr_ui8, false, false, 0) , as_refrence);
+		int readed = 0; 
+		char* data = handle->read_available_no_copy(readed);
+		return ValueItem(data, ValueMeta(VType::raw_arr_ui8, false, false, readed) , as_refrence);
+	}
+	ValueItem read_available(char* buffer, int buffer_len){
+		std::lock_guard lg(mutex);
+		if(!handle)
+			return nullptr;
+		while(!handle->data_available()){
+			if(!handle->send_queue_item())
+				break;
+		}
+		
+		if(!checkup())
+			return (uint32_t)0;
+		int readed = 0; 
+		handle->read_available(buffer, buffer_len, readed);
+		return ValueItem((uint32_t)readed);
+	}
+	bool data_available(){
+		std::lock_guard lg(mutex);
+		if(handle)
+			return handle->data_available();
+		return false;
+	}
+	void write(char* data, size_t size){
+		std::lock_guard lg(mutex);
+		if(handle){
+			handle->send_data(data, size);
+			while(!handle->data_available()){
+				if(!handle->send_queue_item())
+					break;
+			}
+			checkup();
+		}
+	}
+	bool write_file(char* path, size_t path_len, uint64_t data_len, uint64_t offset, uint32_t chunks_size){
+		std::lock_guard lg(mutex);
+		if(handle){
+			while(handle->valid())if(!handle->send_queue_item())break;
+			
+			if(!checkup())
+				return false;
+			
+			return handle->send_file(path, path_len, data_len, offset, chunks_size);
+		}
+		return false;
+	}
+	bool write_file(void* fhandle, uint64_t data_len, uint64_t offset, uint32_t chunks_size){
+		std::lock_guard lg(mutex);
+		if(handle){
+			while(handle->valid())if(!handle->send_queue_item())break;
+			if(!checkup())
+				return false;
+			return handle->send_file(fhandle, data_len, offset, chunks_size);
+		}
+		return false;
+	}
+	//write all data from write_queue
+	void force_write(){
+		std::lock_guard lg(mutex);
 		if(handle){
 			while(handle->valid())if(!handle->send_queue_item())break;
 			checkup();
@@ -1042,7 +1485,7 @@ public:
 		std::lock_guard lg(mutex);
 		if(handle)
 			return handle->available_bytes();
-		return 0ui32;
+		return (uint32_t)0;
 	}
 	ValueItem write(char* data, uint32_t len){
 		std::lock_guard lg(mutex);
@@ -1194,6 +1637,7 @@ void init_define_TcpNetworkBlocking(){
 
 #pragma endregion
 
+#if defined(_WIN32) || defined(_WIN64)
 class TcpNetworkManager : public NativeWorkerManager {
 	TaskMutex safety;
 	typed_lgr<class FuncEnvironment> handler_fn;
@@ -1759,17 +2203,595 @@ void deinit_networking(){
 }
 
 #else
-//TO_DO: LINUX implementation using io_uring
+class TcpNetworkManager : public NativeWorkerManager {
+	TaskMutex safety;
+	typed_lgr<class FuncEnvironment> handler_fn;
+	typed_lgr<class FuncEnvironment> accept_filter;
+	sockaddr_in6 connectionAddress;
+	SOCKET main_socket;
+	timeval recv_timeout;
+	//multishot accept, one submission generates completion for every new connection
+	struct acceptor_handle : public NativeWorkerHandle{
+		//delay before next rearm, grows while accept fails and reset by first accepted connection
+		uint32_t backoff_ms = 0;
+		acceptor_handle(NativeWorkerManager* manager) : NativeWorkerHandle(manager) {}
+	};
+	std::list<acceptor_handle> acceptor_handles;
+	size_t active_acceptors = 0;
+	//accepted sockets handled by tasks, manager must live until they finish
+	size_t pending_accepts = 0;
+	static constexpr uint32_t min_accept_backoff_ms = 10;
+	static constexpr uint32_t max_accept_backoff_ms = 1000;
+public:
+	int32_t default_len;
+private:
+	bool allow_new_connections = false;
+	bool disabled = true;
+	bool corrupted = false;
+	size_t acceptors;
+	TcpNetworkServer::ManageType manage_type;
+	TaskConditionVariable state_changed_cv;
 
-uint8_t init_networking(){
-	init_define_UniversalAddress();
-	init_define_TcpNetworkStream();
-	init_define_TcpNetworkBlocking();
-	
-	inited = true;
-}
-void deinit_networking(){
-	//inited = false;
+	//must be called under safety
+	void make_acceptor(acceptor_handle& acceptor){
+		//completion key set to manager, connections submitted with null key
+		if(NativeWorkersSingleton::submit(&acceptor, this, NativeWorkersSingleton::prepare_accept(main_socket, nullptr, nullptr, true)))
+			active_acceptors++;
+		else{
+			ValueItem error = std::string("Failed submit accept: ") + std::to_string(errno);
+			errors.async_notify(error);
+		}
+	}
+	ValueItem accept_manager_construct(tcp_handle* self){
+		switch (manage_type) {
+		case TcpNetworkServer::ManageType::blocking:
+			return ValueItem(AttachA::Interface::constructStructure<TcpNetworkBlocing>(define_TcpNetworkBlocking, self), no_copy);
+		case TcpNetworkServer::ManageType::write_delayed:
+			return ValueItem(AttachA::Interface::constructStructure<TcpNetworkStream>(define_TcpNetworkStream,self), no_copy);
+		default:
+			return nullptr;
+		}
+	}
+	void accepted(tcp_handle* self,ValueItem clientAddr, ValueItem localAddr){
+		if(!allow_new_connections){
+			delete self;
+			return;
+		}
+		std::lock_guard guard(safety);
+		Task::start(new Task(handler_fn, ValueItem{
+			accept_manager_construct(self),
+			std::move(clientAddr),
+			std::move(localAddr)
+		}));
+	}
+
+	//filter may run user code for long time, so dispatcher only moves socket to task
+	static ValueItem* _accept_task(ValueItem* args, uint32_t len){
+		TcpNetworkManager& manager = *(TcpNetworkManager*)args[0].getSourcePtr();
+		SOCKET new_sock = (SOCKET)(int32_t)args[1];
+		try{
+			manager.new_connection(new_sock);
+		}catch(...){
+			manager.accept_done();
+			throw;
+		}
+		manager.accept_done();
+		return nullptr;
+	}
+	//failed accept rearmed after delay, shutdown wakes delay through state_changed_cv
+	static ValueItem* _rearm_task(ValueItem* args, uint32_t len){
+		TcpNetworkManager& manager = *(TcpNetworkManager*)args[0].getSourcePtr();
+		acceptor_handle& acceptor = *(acceptor_handle*)args[1].getSourcePtr();
+		MutexUnify um(manager.safety);
+		art::unique_lock lock(um);
+		auto until = std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(acceptor.backoff_ms);
+		while(!manager.disabled && std::chrono::high_resolution_clock::now() < until)
+			manager.state_changed_cv.wait_until(lock, until);
+		manager.active_acceptors--;
+		if(!manager.disabled)
+			manager.make_acceptor(acceptor);
+		else if(!manager.active_acceptors)
+			manager.state_changed_cv.notify_all();
+		return nullptr;
+	}
+	static inline typed_lgr<FuncEnvironment> accept_task = new FuncEnvironment(_accept_task, false);
+	static inline typed_lgr<FuncEnvironment> rearm_task = new FuncEnvironment(_rearm_task, false);
+
+	void accept_done(){
+		std::lock_guard lock(safety);
+		if(!--pending_accepts)
+			state_changed_cv.notify_all();
+	}
+	void acceptor_completion(acceptor_handle& acceptor){
+		if(acceptor.result >= 0){
+			acceptor.backoff_ms = 0;
+			std::lock_guard lock(safety);
+			pending_accepts++;
+			Task::start(new Task(accept_task, ValueItem{
+				ValueItem((void*)this),
+				ValueItem((int32_t)acceptor.result)
+			}));
+		}
+		if(acceptor.cqe_flags & IORING_CQE_F_MORE)
+			return;
+		//multishot accept terminated by error or shutdown, rearm if still running
+		std::lock_guard lock(safety);
+		if(disabled){
+			if(!--active_acceptors)
+				state_changed_cv.notify_all();
+		}
+		else if(acceptor.result < 0){
+			//errors like EMFILE repeats until resources freed, immediate rearm only spins dispatcher
+			acceptor.backoff_ms = acceptor.backoff_ms ? std::min(acceptor.backoff_ms * 2, max_accept_backoff_ms) : min_accept_backoff_ms;
+			Task::start(new Task(rearm_task, ValueItem{
+				ValueItem((void*)this),
+				ValueItem((void*)&acceptor)
+			}));
+		}
+		else{
+			active_acceptors--;
+			make_acceptor(acceptor);
+		}
+	}
+
+	void new_connection(SOCKET new_sock){
+		universal_address clientAddr;
+		universal_address localAddr;
+		socklen_t remoteLen = sizeof(universal_address);
+		socklen_t localLen = sizeof(universal_address);
+		memset(&clientAddr, 0, sizeof(universal_address));
+		memset(&localAddr, 0, sizeof(universal_address));
+		getpeername(new_sock, (sockaddr*)&clientAddr, &remoteLen);
+		getsockname(new_sock, (sockaddr*)&localAddr, &localLen);
+		ValueItem clientAddress(AttachA::Interface::constructStructure<universal_address>(define_UniversalAddress, clientAddr), no_copy);
+		ValueItem localAddress(AttachA::Interface::constructStructure<universal_address>(define_UniversalAddress, localAddr), no_copy);
+		if(accept_filter){
+			if(AttachA::cxxCall(accept_filter,clientAddress,localAddress)){
+				closesocket(new_sock);
+				#ifndef DISABLE_RUNTIME_INFO
+				auto tmp = UniversalAddress::_define_to_string(&clientAddress,1);
+				ValueItem notify{ "Client: " + (std::string)*tmp + " not accepted due filter" };
+				delete tmp;
+				info.async_notify(notify);
+				#endif
+				return;
+			}
+		}
+		if((recv_timeout.tv_sec || recv_timeout.tv_usec) && setsockopt(new_sock, SOL_SOCKET, SO_RCVTIMEO, (char*)&recv_timeout, sizeof(recv_timeout)) == SOCKET_ERROR){
+			ValueItem warn = std::string("Failed set recv timeout for client: ") + std::to_string(errno);
+			warning.async_notify(warn);
+		}
+
+		#ifndef DISABLE_RUNTIME_INFO
+		{
+			auto tmp = UniversalAddress::_define_to_string(&clientAddress,1);
+			ValueItem notify{ "Client connected from: " + (std::string)*tmp };
+			delete tmp;
+			info.async_notify(notify);
+		}
+		#endif
+		tcp_handle* data;
+		try{
+			data = new tcp_handle(new_sock, default_len, this);
+		}catch(...){
+			closesocket(new_sock);
+			throw;
+		}
+		accepted(data, std::move(clientAddress), std::move(localAddress));
+	}
+public:
+	TcpNetworkManager(universal_address& ip_port, size_t acceptors,TcpNetworkServer::ManageType manage_type, int32_t timeout_ms, int32_t default_buffer) : acceptors(acceptors),manage_type(manage_type), default_len(default_buffer) {
+		memcpy(&connectionAddress, &ip_port, sizeof(sockaddr_in6));
+		//listen socket only accepts, timeout applied to every accepted socket
+		recv_timeout.tv_sec = timeout_ms / 1000;
+		recv_timeout.tv_usec = (timeout_ms % 1000) * 1000;
+		main_socket = ::socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+		if (main_socket == INVALID_SOCKET){
+			ValueItem error = std::string("Failed create socket: ") + std::to_string(errno);
+			errors.sync_notify(error);
+			corrupted = true;
+			return;
+		}
+		int argp = 1;
+		int result = setsockopt(main_socket,SOL_SOCKET,SO_REUSEADDR,(char*)&argp, sizeof(argp));
+		if (result == SOCKET_ERROR){
+			ValueItem error = std::string("Failed set reuse addr: ") + std::to_string(errno);
+			errors.sync_notify(error);
+			corrupted = true;
+			return;
+		}
+		//ignored error, it is not critical, on linux value is queue length of pending fast open requests
+		argp = SOMAXCONN;
+		result = setsockopt(main_socket,IPPROTO_TCP,TCP_FASTOPEN,(char*)&argp, sizeof(argp));
+		if (result == SOCKET_ERROR){
+			ValueItem warn = std::string("Failed enable fast open for server(") + std::to_string(errno) + "), continue slow mode";
+			warning.async_notify(warn);
+		}
+		argp = 0;
+		result = setsockopt(main_socket,IPPROTO_IPV6,IPV6_V6ONLY,(char*)&argp, sizeof(argp));
+		if (result == SOCKET_ERROR){
+			ValueItem error = std::string("Failed set dual mode: ") + std::to_string(errno);
+			errors.sync_notify(error);
+			corrupted = true;
+			return;
+		}
+		if (bind(main_socket, (sockaddr*)&connectionAddress, sizeof(sockaddr_in6)) == SOCKET_ERROR){
+			ValueItem error = std::string("Failed bind: ") + std::to_string(errno);
+			errors.sync_notify(error);
+			corrupted = true;
+			return;
+		}
+		//server can be binded to port 0
+		socklen_t addr_len = sizeof(sockaddr_in6);
+		getsockname(main_socket, (sockaddr*)&connectionAddress, &addr_len);
+	}
+	~TcpNetworkManager(){
+		shutdown();
+	}
+
+	void handle(void* _data, NativeWorkerHandle* overlapped, unsigned long dwBytesTransferred, bool status) override {
+		if(_data == this){
+			acceptor_completion(*(acceptor_handle*)overlapped);
+			return;
+		}
+		auto& data = *(tcp_handle*)overlapped;
+		if(data.opcode == tcp_handle::Opcode::TRANSMIT_FILE || (status && dwBytesTransferred)) data.handle(dwBytesTransferred);
+		else {
+			#ifndef DISABLE_RUNTIME_INFO
+			{
+				ValueItem notify{ "Client disconnected (client hash: " + std::to_string(std::hash<void*>()(overlapped))+')' };
+				info.async_notify(notify);
+			}
+			#endif
+			data.connection_reset();
+		}
+	}
+	void set_on_connect(typed_lgr<class FuncEnvironment> handler_fn, TcpNetworkServer::ManageType manage_type){
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+		std::lock_guard lock(safety);
+		this->handler_fn = handler_fn;
+		this->manage_type = manage_type;
+	}
+	void shutdown(){
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+		MutexUnify um(safety);
+		art::unique_lock lock(um);
+		if(disabled)
+			return;
+		allow_new_connections = false;
+		disabled = true;
+		//pending multishot accepts completes with EINVAL, acceptor handles must live until that
+		::shutdown(main_socket, SHUT_RDWR);
+		//wakes acceptors delayed by backoff
+		state_changed_cv.notify_all();
+		while(active_acceptors || pending_accepts)
+			state_changed_cv.wait(lock);
+		closesocket(main_socket);
+		main_socket = INVALID_SOCKET;
+		state_changed_cv.notify_all();
+	}
+	void pause(){
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+		allow_new_connections = false;
+	}
+	void resume(){
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+		allow_new_connections = true;
+	}
+	void start(){
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+		std::lock_guard lock(safety);
+		allow_new_connections = true;
+		if(!disabled)
+			return;
+		if(main_socket == INVALID_SOCKET)
+			return;
+		if (listen(main_socket, SOMAXCONN) == SOCKET_ERROR)
+			return;
+		while(acceptor_handles.size() < acceptors)
+			acceptor_handles.emplace_back(this);
+		for(auto& acceptor : acceptor_handles)
+			make_acceptor(acceptor);
+		disabled = false;
+		state_changed_cv.notify_all();
+	}
+	void _await(){
+		MutexUnify um(safety);
+		art::unique_lock lock(um);
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+		while(!disabled)
+			state_changed_cv.wait(lock);
+	}
+
+
+	void set_accept_filter(typed_lgr<class FuncEnvironment> filter){
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+		std::lock_guard lock(safety);
+		this->accept_filter = filter;
+	}
+	bool is_corrupted(){
+		return corrupted;
+	}
+
+	uint16_t port(){
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+		return htons(connectionAddress.sin6_port);
+	}
+	std::string ip(){
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+		Structure* tmp = AttachA::Interface::constructStructure<universal_address>(define_UniversalAddress);
+		memcpy(tmp->get_data_no_vtable(), &connectionAddress, sizeof(sockaddr_in6));
+		tmp->fully_constructed = true;
+		ValueItem args(tmp, as_refrence);
+		ValueItem* res;
+		try{
+			res = UniversalAddress::_define_to_string(&args, 1);
+		}catch(...){
+			Structure::destruct(tmp);
+			throw;
+		}
+		Structure::destruct(tmp);
+		std::string ret = (std::string)*res;
+		delete res;
+		return ret;
+	}
+	ValueItem address(){
+		if(corrupted)
+			throw AttachARuntimeException("TcpNetworkManager is corrupted");
+
+		sockaddr_storage* addr = new sockaddr_storage;
+		memcpy(addr, &connectionAddress, sizeof(sockaddr_in6));
+		memset(((char*)addr) + sizeof(sockaddr_in6), 0, sizeof(sockaddr_storage) - sizeof(sockaddr_in6));
+		return ValueItem(AttachA::Interface::constructStructure<universal_address>(define_UniversalAddress,*addr), no_copy);
+	}
+
+	bool is_paused(){
+		return !disabled && !allow_new_connections;
+	}
+	bool in_run(){
+		return !disabled;
+	}
+};
+class TcpClientManager : public NativeWorkerManager {
+	TaskMutex mutex;
+	sockaddr_in6 connectionAddress;
+	tcp_handle* _handle;
+	bool corrupted = false;
+
+	struct cancel_handle : public NativeWorkerHandle{
+		cancel_handle(NativeWorkerManager* manager) : NativeWorkerHandle(manager) {}
+	};
+	static inline const char cancel_key = 0;
+
+	bool connect(int32_t timeout_ms){
+		MutexUnify umutex(_handle->cv_mutex);
+		art::unique_lock<MutexUnify> lock(umutex);
+		_handle->opcode = tcp_handle::Opcode::ACCEPT;
+		_handle->connecting = true;
+		if(!NativeWorkersSingleton::submit(_handle, nullptr, NativeWorkersSingleton::prepare_connect(_handle->socket, &connectionAddress, sizeof(connectionAddress)))){
+			lock.unlock();
+			_handle->reset();
+			delete _handle;
+			_handle = nullptr;
+			return false;
+		}
+		if(timeout_ms){
+			auto until = std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(timeout_ms);
+			while(_handle->connecting && std::chrono::high_resolution_clock::now() < until)
+				_handle->cv.wait_until(lock, until);
+			if(_handle->connecting){
+				//connect still in ring, cancel it and wait completion before handle freed
+				cancel_handle* request = new cancel_handle(this);
+				if(!NativeWorkersSingleton::submit(request, (void*)&cancel_key, NativeWorkersSingleton::prepare_cancel(_handle)))
+					delete request;
+				while(_handle->connecting)
+					_handle->cv.wait(lock);
+				if(_handle->result >= 0)
+					_handle->result = -ETIMEDOUT;
+			}
+		}else{
+			while(_handle->connecting)
+				_handle->cv.wait(lock);
+		}
+		if(_handle->result < 0){
+			lock.unlock();
+			_handle->reset();
+			delete _handle;
+			_handle = nullptr;
+			return false;
+		}
+		return true;
+	}
+public:
+	void handle(void* _data, NativeWorkerHandle* overlapped, unsigned long dwBytesTransferred, bool status) override {
+		if(_data == &cancel_key){
+			delete (cancel_handle*)overlapped;
+			return;
+		}
+		tcp_handle& handle = *(tcp_handle*)overlapped;
+		if(handle.opcode == tcp_handle::Opcode::ACCEPT || handle.opcode == tcp_handle::Opcode::TRANSMIT_FILE || (status && dwBytesTransferred))
+			handle.handle(dwBytesTransferred);
+		else
+			handle.connection_reset();
+	}
+
+	TcpClientManager(sockaddr_in6& _connectionAddress, int32_t timeout_ms = 0) : connectionAddress(_connectionAddress), _handle(nullptr) {
+		if(timeout_ms < 0) timeout_ms = 0;
+		SOCKET clientSocket = ::socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+		if (clientSocket == INVALID_SOCKET) {
+			corrupted = true;
+			return;
+		}
+		_handle = new tcp_handle(clientSocket, 4096, this);
+		if(!connect(timeout_ms))
+			corrupted = true;
+	}
+	TcpClientManager(sockaddr_in6& _connectionAddress, char* data, uint32_t len, int32_t timeout_ms = 0) : TcpClientManager(_connectionAddress, timeout_ms){
+		if(corrupted)
+			return;
+		//no ConnectEx analog, data sended right after connect
+		_handle->send_data(data, len);
+		_handle->send_queue_item();
+	}
+	~TcpClientManager() override {
+		if(corrupted)
+			return;
+		delete _handle;
+	}
+
+	int32_t read(char* data, int32_t len){
+		if(corrupted)
+			throw std::runtime_error("TcpClientManager::read, corrupted");
+		std::lock_guard<TaskMutex> lock(mutex);
+		int32_t readed = 0;
+		while(!_handle->available_bytes())
+			if(!_handle->send_queue_item()) break;
+		_handle->read_available(data, len, readed);
+		return readed;
+	}
+	bool write(const char* data, int32_t len){
+		if(corrupted)
+			throw std::runtime_error("TcpClientManager::write, corrupted");
+		std::lock_guard<TaskMutex> lock(mutex);
+		_handle->send_data(data, len);
+		while(!_handle->available_bytes())
+			if(!_handle->send_queue_item())break;
+		return _handle->valid();
+	}
+	bool write_file(const char* path, size_t len, uint64_t data_len, uint64_t offset, uint32_t chunks_size){
+		if(corrupted)
+			throw std::runtime_error("TcpClientManager::write_file, corrupted");
+		std::lock_guard<TaskMutex> lock(mutex);
+		while(!_handle->available_bytes())
+			if(!_handle->send_queue_item())break;
+		return _handle->send_file(path, len, data_len, offset, chunks_size);
+	}
+	bool write_file(void* handle, uint64_t data_len, uint64_t offset, uint32_t chunks_size){
+		if(corrupted)
+			throw std::runtime_error("TcpClientManager::write_file, corrupted");
+		std::lock_guard<TaskMutex> lock(mutex);
+		while(!_handle->available_bytes())
+			if(!_handle->send_queue_item())break;
+		return _handle->send_file(handle, data_len, offset, chunks_size);
+	}
+	void close(){
+		if(corrupted)
+			throw std::runtime_error("TcpClientManager::close, corrupted");
+		std::lock_guard<TaskMutex> lock(mutex);
+		_handle->close();
+	}
+	void reset(){
+		if(corrupted)
+			throw std::runtime_error("TcpClientManager::close, corrupted");
+		std::lock_guard<TaskMutex> lock(mutex);
+		_handle->reset();
+	}
+	bool is_corrupted(){
+		return corrupted;
+	}
+	void rebuffer(uint32_t size){
+		if(corrupted)
+			throw std::runtime_error("TcpClientManager::rebuffer, corrupted");
+		std::lock_guard<TaskMutex> lock(mutex);
+		_handle->rebuffer(size);
+	}
+};
+#pragma endregion
+
+class udp_handle : public NativeWorkerHandle, public NativeWorkerManager {
+	typed_lgr<Task> notify_task;
+	SOCKET socket;
+	sockaddr_in6 server_address;
+	msghdr message;
+	iovec buf;
+public:
+	uint32_t fullifed_bytes;
+	bool status;
+	int last_error;
+	udp_handle(sockaddr_in6& address, uint32_t timeout_ms) : NativeWorkerHandle(this), last_error(0), fullifed_bytes(0), status(false){
+		socket = ::socket(AF_INET6, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP);
+		if(socket == INVALID_SOCKET)
+			return;
+		if(bind(socket, (sockaddr*)&address, sizeof(sockaddr_in6)) == SOCKET_ERROR){
+			closesocket(socket);
+			socket = INVALID_SOCKET;
+			return;
+		}
+		server_address = address;
+	}
+	~udp_handle(){
+		if(socket != INVALID_SOCKET)
+			closesocket(socket);
+	}
+	void handle(void* data, NativeWorkerHandle* overlapped, unsigned long fullifed_bytes, bool status) override{
+		this->fullifed_bytes = fullifed_bytes;
+		this->status = status;
+		last_error = status ? 0 : -result;
+		Task::start(notify_task);
+	}
+	void recv(uint8_t* data, uint32_t size, sockaddr_storage& sender, int& sender_len){
+		if(socket == INVALID_SOCKET)
+			throw InvalidOperation("Socket not connected");
+		buf.iov_base = data;
+		buf.iov_len = size;
+		memset(&message, 0, sizeof(message));
+		message.msg_name = &sender;
+		message.msg_namelen = sender_len;
+		message.msg_iov = &buf;
+		message.msg_iovlen = 1;
+		notify_task = Task::dummy_task();
+		if(!NativeWorkersSingleton::submit(this, nullptr, NativeWorkersSingleton::prepare_rw(IORING_OP_RECVMSG, socket, &message, 1, 0))){
+			last_error = errno;
+			status = false;
+			fullifed_bytes = 0;
+			notify_task = nullptr;
+			return;
+		}
+		Task::await_task(notify_task);
+		notify_task = nullptr;
+		sender_len = message.msg_namelen;
+	}
+	void send(uint8_t* data, uint32_t size, sockaddr_storage& to){
+		if(socket == INVALID_SOCKET)
+			throw InvalidOperation("Socket not connected");
+		buf.iov_base = data;
+		buf.iov_len = size;
+		memset(&message, 0, sizeof(message));
+		message.msg_name = &to;
+		message.msg_namelen = sizeof(sockaddr_in6);
+		message.msg_iov = &buf;
+		message.msg_iovlen = 1;
+		notify_task = Task::dummy_task();
+		if(!NativeWorkersSingleton::submit(this, nullptr, NativeWorkersSingleton::prepare_rw(IORING_OP_SENDMSG, socket, &message, 1, 0))){
+			last_error = errno;
+			status = false;
+			fullifed_bytes = 0;
+			notify_task = nullptr;
+			return;
+		}
+		Task::await_task(notify_task);
+		notify_task = nullptr;
+	}
+};
+
+uint8_t init_networking(){
+	init_define_UniversalAddress();
+	init_define_TcpNetworkStream();
+	init_define_TcpNetworkBlocking();
+	inited = true;
+	return 0;
+}
+void deinit_networking(){
+	inited = false;
 }
 #endif
 
@@ -310,12 +310,226 @@ namespace chanel {
 		auto_events.erase(found);
 	}
 
+	BoundedChanel::BoundedChanel(size_t capacity) {
+		if (capacity < 2)
+			capacity = 2;
+		size_t rounded = 1;
+		while (rounded < capacity)
+			rounded <<= 1;
+		buffer = new Cell[rounded];
+		mask = rounded - 1;
+		for (size_t i = 0; i < rounded; i++)
+			buffer[i].sequence.store(i, std::memory_order_relaxed);
+		enqueue_pos.store(0, std::memory_order_relaxed);
+		dequeue_pos.store(0, std::memory_order_relaxed);
+		waiting_producers = 0;
+		waiting_consumers = 0;
+		closed = false;
+	}
+	BoundedChanel::~BoundedChanel() {
+		MutexUnify mu(park_mutex);
+		art::unique_lock ul(mu);
+		closed = true;
+		destroying = true;
+		not_full.notify_all();
+		not_empty.notify_all();
+		//woken waiters still hold park_mutex, buffer freed only after last one left
+		while (waiting_producers.load() || waiting_consumers.load())
+			drained.wait(ul);
+		ul.unlock();
+		delete[] buffer;
+	}
+	//caller holds park_mutex, returns true if chanel destroyed and must not be touched after unlock
+	bool BoundedChanel::leave_park(std::atomic_size_t& counter) {
+		counter--;
+		if (!destroying)
+			return false;
+		if (!waiting_producers.load() && !waiting_consumers.load())
+			drained.notify_all();
+		return true;
+	}
+	bool BoundedChanel::push(ValueItem& val) {
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		while (true) {
+			Cell& cell = buffer[pos & mask];
+			size_t seq = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+			if (diff == 0) {
+				if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.value = std::move(val);
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+				return false;//full
+			else
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+	bool BoundedChanel::pop(ValueItem& val) {
+		size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+		while (true) {
+			Cell& cell = buffer[pos & mask];
+			size_t seq = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+			if (diff == 0) {
+				if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					val = std::move(cell.value);
+					cell.sequence.store(pos + mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+				return false;//empty
+			else
+				pos = dequeue_pos.load(std::memory_order_relaxed);
+		}
+	}
+	//waiter counters incremented before recheck under park_mutex, so after push/pop it is enough to check counter to not lose wakeup
+	void BoundedChanel::wake_producers(bool all) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiting_producers.load() == 0)
+			return;
+		std::lock_guard guard(park_mutex);
+		if (all)
+			not_full.notify_all();
+		else
+			not_full.notify_one();
+	}
+	void BoundedChanel::wake_consumers(bool all) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiting_consumers.load() == 0)
+			return;
+		std::lock_guard guard(park_mutex);
+		if (all)
+			not_empty.notify_all();
+		else
+			not_empty.notify_one();
+	}
+	void BoundedChanel::notify(ValueItem&& val) {
+		while (true) {
+			if (closed)
+				throw AException("TaskDeath", "Chanel closed");
+			if (push(val)) {
+				wake_consumers(false);
+				return;
+			}
+			waiting_producers++;
+			{
+				MutexUnify mu(park_mutex);
+				art::unique_lock ul(mu);
+				//recheck fullness, consumer could take item before counter increment
+				while (!closed && enqueue_pos.load() - dequeue_pos.load() > mask)
+					not_full.wait(ul);
+				if (leave_park(waiting_producers))
+					throw AException("TaskDeath", "Chanel closed");
+			}
+		}
+	}
+	void BoundedChanel::notify(const ValueItem& val) {
+		notify(ValueItem(val));
+	}
+	void BoundedChanel::notify(ValueItem* vals, uint32_t len) {
+		uint32_t i = 0;
+		while (i < len) {
+			if (closed)
+				throw AException("TaskDeath", "Chanel closed");
+			uint32_t pushed = 0;
+			while (i < len) {
+				ValueItem item(vals[i]);
+				if (!push(item))
+					break;
+				i++;
+				pushed++;
+			}
+			if (pushed)
+				wake_consumers(pushed > 1);
+			if (i == len)
+				return;
+			waiting_producers++;
+			{
+				MutexUnify mu(park_mutex);
+				art::unique_lock ul(mu);
+				while (!closed && enqueue_pos.load() - dequeue_pos.load() > mask)
+					not_full.wait(ul);
+				if (leave_park(waiting_producers))
+					throw AException("TaskDeath", "Chanel closed");
+			}
+		}
+	}
+	bool BoundedChanel::try_notify(const ValueItem& val) {
+		if (closed)
+			return false;
+		ValueItem item(val);
+		if (!push(item))
+			return false;
+		wake_consumers(false);
+		return true;
+	}
+	ValueItem BoundedChanel::get() {
+		ValueItem res;
+		while (true) {
+			if (pop(res)) {
+				wake_producers(false);
+				return res;
+			}
+			if (closed)
+				throw AException("TaskDeath", "Chanel closed");
+			waiting_consumers++;
+			{
+				MutexUnify mu(park_mutex);
+				art::unique_lock ul(mu);
+				while (!closed && enqueue_pos.load() == dequeue_pos.load())
+					not_empty.wait(ul);
+				if (leave_park(waiting_consumers))
+					throw AException("TaskDeath", "Chanel closed");
+			}
+		}
+	}
+	ValueItem BoundedChanel::try_get() {
+		ValueItem res;
+		if (!pop(res))
+			return ValueItem{ false, res };
+		wake_producers(false);
+		return ValueItem{ true, res };
+	}
+	list_array<ValueItem> BoundedChanel::get_many(uint32_t max_count) {
+		list_array<ValueItem> res;
+		if (!max_count)
+			return res;
+		res.push_back(get());
+		ValueItem item;
+		while (res.size() < max_count && pop(item))
+			res.push_back(std::move(item));
+		if (res.size() > 1)
+			wake_producers(true);
+		return res;
+	}
+	void BoundedChanel::close() {
+		std::lock_guard guard(park_mutex);
+		closed = true;
+		not_full.notify_all();
+		not_empty.notify_all();
+	}
+	bool BoundedChanel::is_closed() {
+		return closed;
+	}
+	size_t BoundedChanel::capacity() {
+		return mask + 1;
+	}
+	size_t BoundedChanel::size() {
+		size_t enq = enqueue_pos.load();
+		size_t deq = dequeue_pos.load();
+		return enq > deq ? enq - deq : 0;
+	}
 
 
 	AttachAVirtualTable* define_Chanel;
 	AttachAVirtualTable* define_ChanelHandler;
 	AttachAVirtualTable* define_AutoNotifyChanel;
 	AttachAVirtualTable* define_AutoEventChanel;
+	AttachAVirtualTable* define_BoundedChanel;
 
 
 	AttachAFun(funs_Chanel_notify, 2,{
@@ -420,6 +634,38 @@ namespace chanel {
 		AttachA::Interface::getExtractAs<typed_lgr<ChanelHandler>>(args[0],define_ChanelHandler)->wait_item();
 	})
 
+	AttachAFun(funs_BoundedChanel_notify, 2, {
+		auto& chanel = AttachA::Interface::getExtractAs<typed_lgr<BoundedChanel>>(args[0], define_BoundedChanel);
+		if(len == 2)
+			chanel->notify(args[1]);
+		else
+			chanel->notify(args + 1, len - 1);
+	})
+	AttachAFun(funs_BoundedChanel_try_notify, 2, {
+		return AttachA::Interface::getExtractAs<typed_lgr<BoundedChanel>>(args[0], define_BoundedChanel)->try_notify(args[1]);
+	})
+	AttachAFun(funs_BoundedChanel_get, 1, {
+		return AttachA::Interface::getExtractAs<typed_lgr<BoundedChanel>>(args[0], define_BoundedChanel)->get();
+	})
+	AttachAFun(funs_BoundedChanel_try_get, 1, {
+		return AttachA::Interface::getExtractAs<typed_lgr<BoundedChanel>>(args[0], define_BoundedChanel)->try_get();
+	})
+	AttachAFun(funs_BoundedChanel_get_many, 2, {
+		return AttachA::Interface::getExtractAs<typed_lgr<BoundedChanel>>(args[0], define_BoundedChanel)->get_many((uint32_t)args[1]);
+	})
+	AttachAFun(funs_BoundedChanel_close, 1, {
+		AttachA::Interface::getExtractAs<typed_lgr<BoundedChanel>>(args[0], define_BoundedChanel)->close();
+	})
+	AttachAFun(funs_BoundedChanel_is_closed, 1, {
+		return AttachA::Interface::getExtractAs<typed_lgr<BoundedChanel>>(args[0], define_BoundedChanel)->is_closed();
+	})
+	AttachAFun(funs_BoundedChanel_capacity, 1, {
+		return AttachA::Interface::getExtractAs<typed_lgr<BoundedChanel>>(args[0], define_BoundedChanel)->capacity();
+	})
+	AttachAFun(funs_BoundedChanel_size, 1, {
+		return AttachA::Interface::getExtractAs<typed_lgr<BoundedChanel>>(args[0], define_BoundedChanel)->size();
+	})
+
 	void init() {
 		if(define_Chanel != nullptr) return;
 		define_Chanel = AttachA::Interface::createTable<typed_lgr<Chanel>>("chanel",
@@ -443,11 +689,24 @@ namespace chanel {
 			AttachA::Interface::direct_method("wait_item", funs_ChanelHandler_wait_item)
 		);
 
+		define_BoundedChanel = AttachA::Interface::createTable<typed_lgr<BoundedChanel>>("bounded_chanel",
+			AttachA::Interface::direct_method("notify", funs_BoundedChanel_notify),
+			AttachA::Interface::direct_method("try_notify", funs_BoundedChanel_try_notify),
+			AttachA::Interface::direct_method("get", funs_BoundedChanel_get),
+			AttachA::Interface::direct_method("try_get", funs_BoundedChanel_try_get),
+			AttachA::Interface::direct_method("get_many", funs_BoundedChanel_get_many),
+			AttachA::Interface::direct_method("close", funs_BoundedChanel_close),
+			AttachA::Interface::direct_method("is_closed", funs_BoundedChanel_is_closed),
+			AttachA::Interface::direct_method("capacity", funs_BoundedChanel_capacity),
+			AttachA::Interface::direct_method("size", funs_BoundedChanel_size)
+		);
+
 		define_AutoNotifyChanel = AttachA::Interface::createTable<typed_lgr<AutoNotifyChanel>>("auto_notify_chanel");
 		define_AutoEventChanel = AttachA::Interface::createTable<typed_lgr<AutoEventChanel>>("auto_event_chanel");
 		AttachA::Interface::typeVTable<typed_lgr<Chanel>>() = define_Chanel;
 		AttachA::Interface::typeVTable<typed_lgr<ChanelHandler>>() = define_ChanelHandler;
 		AttachA::Interface::typeVTable<typed_lgr<AutoEventChanel>>() = define_AutoEventChanel;
+		AttachA::Interface::typeVTable<typed_lgr<BoundedChanel>>() = define_BoundedChanel;
 
 	}
 
@@ -458,5 +717,10 @@ namespace chanel {
 		ValueItem* createProxy_ChanelHandler(ValueItem*, uint32_t) {
 			return new ValueItem(AttachA::Interface::constructStructure<typed_lgr<ChanelHandler>>(define_ChanelHandler, new ChanelHandler()), no_copy);
 		}
+		ValueItem* createProxy_BoundedChanel(ValueItem* args, uint32_t len) {
+			size_t capacity = 1024;
+			if (len >= 1) if (args[0].meta.vtype != VType::noting) capacity = (size_t)args[0];
+			return new ValueItem(AttachA::Interface::constructStructure<typed_lgr<BoundedChanel>>(define_BoundedChanel, new BoundedChanel(capacity)), no_copy);
+		}
 	}
 }
\ No newline at end of file
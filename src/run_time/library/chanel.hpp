@@ -7,6 +7,7 @@
 #pragma once
 #include <list>
 #include <queue>
+#include <atomic>
 #include "../tasks.hpp"
 #include "../attacha_abi_structs.hpp"
 namespace chanel {
@@ -68,10 +69,54 @@ namespace chanel {
 		void remove_auto_event(typed_lgr<AutoEventChanel> notifyer);
 	};
 
+	//bounded lock-free ring buffer, every item received by only one consumer
+	//producers suspended when buffer full and consumers when buffer empty
+	class BoundedChanel {
+		struct Cell {
+			std::atomic_size_t sequence;
+			ValueItem value;
+		};
+		Cell* buffer;
+		size_t mask;
+		alignas(64) std::atomic_size_t enqueue_pos;
+		alignas(64) std::atomic_size_t dequeue_pos;
+		alignas(64) std::atomic_size_t waiting_producers;
+		std::atomic_size_t waiting_consumers;
+		std::atomic_bool closed;
+		bool destroying = false;//set under park_mutex, woken waiters leave without touching chanel
+		TaskMutex park_mutex;
+		TaskConditionVariable not_full;
+		TaskConditionVariable not_empty;
+		TaskConditionVariable drained;//destructor waits parked waiters here
+		bool push(ValueItem& val);
+		bool pop(ValueItem& val);
+		void wake_producers(bool all);
+		void wake_consumers(bool all);
+		bool leave_park(std::atomic_size_t& counter);
+	public:
+		//capacity rounded up to power of two
+		BoundedChanel(size_t capacity);
+		~BoundedChanel();
+		void notify(ValueItem&& val);
+		void notify(const ValueItem& val);
+		//push all items, wakes consumers once per batch
+		void notify(ValueItem* vals, uint32_t len);
+		bool try_notify(const ValueItem& val);
+		ValueItem get();
+		ValueItem try_get();
+		//waits for at least one item, then takes up to max_count without waiting
+		list_array<ValueItem> get_many(uint32_t max_count);
+		//wakes all waiters, pending items still can be received
+		void close();
+		bool is_closed();
+		size_t capacity();
+		size_t size();
+	};
 
 	void init();
 	namespace constructor {
 		ValueItem* createProxy_Chanel(ValueItem*, uint32_t);
 		ValueItem* createProxy_ChanelHandler(ValueItem*, uint32_t);
+		ValueItem* createProxy_BoundedChanel(ValueItem*, uint32_t);
 	}
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ AttachAVirtualTable* define_FileHandle;
 AttachAVirtualTable* define_BlockingFileHandle;
 AttachAVirtualTable* define_TextFile;
 AttachAVirtualTable* define_FolderBrowser;
+AttachAVirtualTable* define_MappedFile;
+AttachAVirtualTable* define_MappedView;
 
 class TextFile{
 public:
@@ -581,6 +583,12 @@ namespace file {
 
             return ValueItem(AttachA::Interface::constructStructure<typed_lgr<files::BlockingFileHandle>>(define_BlockingFileHandle,new files::BlockingFileHandle(path.c_str(), path.size(), mode, action, flags, share)), no_copy);
         })
+        AttachAFun(createProxy_MappedFile, 1, {
+            auto path = (std::string)args[0];
+            bool writable = false;
+            if(len >= 2)if(args[1].meta.vtype != VType::noting) writable = (bool)args[1];
+            return ValueItem(AttachA::Interface::constructStructure<typed_lgr<files::MappedFile>>(define_MappedFile, new files::MappedFile(path.c_str(), path.size(), writable)), no_copy);
+        })
         AttachAFun(createProxy_TextFile, 1, {
             auto file_handle = AttachA::Interface::getExtractAs<typed_lgr<files::FileHandle>>(args[0], define_FileHandle);
             auto endian = Endian::native;
@@ -737,6 +745,52 @@ namespace file {
     })
 #pragma endregion
 
+#pragma region MappedFile
+    AttachAFun(funs_MappedFile_view, 3, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedFile>>(args[0], define_MappedFile);
+        VType type = VType::raw_arr_ui8;
+        if(len >= 4)if(args[3].meta.vtype != VType::noting) type = (VType)(uint8_t)args[3];
+        return ValueItem(AttachA::Interface::constructStructure<typed_lgr<files::MappedView>>(define_MappedView, files::MappedFile::view(handle, (uint64_t)args[1], (uint32_t)args[2], type)), no_copy);
+    })
+    AttachAFun(funs_MappedFile_advise, 4, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedFile>>(args[0], define_MappedFile);
+        return handle->advise((uint64_t)args[1], (uint64_t)args[2], (files::MappedFile::access_hint)(uint8_t)args[3]);
+    })
+    AttachAFun(funs_MappedFile_flush, 1, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedFile>>(args[0], define_MappedFile);
+        return handle->flush();
+    })
+    AttachAFun(funs_MappedFile_size, 1, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedFile>>(args[0], define_MappedFile);
+        return handle->size();
+    })
+    AttachAFun(funs_MappedFile_internal_get_data, 1, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedFile>>(args[0], define_MappedFile);
+        return handle->internal_get_data();
+    })
+
+    AttachAFun(funs_MappedView_get, 2, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedView>>(args[0], define_MappedView);
+        return handle->get((uint32_t)args[1]);
+    })
+    AttachAFun(funs_MappedView_set, 3, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedView>>(args[0], define_MappedView);
+        handle->set((uint32_t)args[1], args[2]);
+    })
+    AttachAFun(funs_MappedView_copy, 1, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedView>>(args[0], define_MappedView);
+        return handle->copy();
+    })
+    AttachAFun(funs_MappedView_reference, 1, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedView>>(args[0], define_MappedView);
+        return files::MappedView::reference(handle);
+    })
+    AttachAFun(funs_MappedView_size, 1, {
+        auto& handle = AttachA::Interface::getExtractAs<typed_lgr<files::MappedView>>(args[0], define_MappedView);
+        return handle->size();
+    })
+#pragma endregion
+
 #pragma region TextFile
     AttachAFun(funs_TextFile_read_line, 1, {
         auto& handle = AttachA::Interface::getExtractAs<typed_lgr<TextFile>>(args[0], define_TextFile);
@@ -1008,6 +1062,21 @@ namespace file {
             AttachA::Interface::direct_method("get_native_handle", funs_BlockingFileHandle_internal_get_handle, ClassAccess::intern)
         );
 
+        define_MappedFile = AttachA::Interface::createTable<typed_lgr<files::MappedFile>>("mapped_file",
+            AttachA::Interface::direct_method("view", funs_MappedFile_view),
+            AttachA::Interface::direct_method("advise", funs_MappedFile_advise),
+            AttachA::Interface::direct_method("flush", funs_MappedFile_flush),
+            AttachA::Interface::direct_method("size", funs_MappedFile_size),
+            AttachA::Interface::direct_method("get_native_data", funs_MappedFile_internal_get_data, ClassAccess::intern)
+        );
+        define_MappedView = AttachA::Interface::createTable<typed_lgr<files::MappedView>>("mapped_view",
+            AttachA::Interface::direct_method("get", funs_MappedView_get),
+            AttachA::Interface::direct_method("set", funs_MappedView_set),
+            AttachA::Interface::direct_method("copy", funs_MappedView_copy),
+            AttachA::Interface::direct_method("size", funs_MappedView_size),
+            AttachA::Interface::direct_method("reference", funs_MappedView_reference)
+        );
+
         define_TextFile = AttachA::Interface::createTable<typed_lgr<TextFile>>("text_file",
             AttachA::Interface::direct_method("read_line", funs_TextFile_read_line),
             AttachA::Interface::direct_method("read_word", funs_TextFile_read_word),
@@ -1038,6 +1107,8 @@ namespace file {
         );
         AttachA::Interface::typeVTable<typed_lgr<files::FileHandle>>() = define_FileHandle;
         AttachA::Interface::typeVTable<typed_lgr<files::BlockingFileHandle>>() = define_BlockingFileHandle;
+        AttachA::Interface::typeVTable<typed_lgr<files::MappedFile>>() = define_MappedFile;
+        AttachA::Interface::typeVTable<typed_lgr<files::MappedView>>() = define_MappedView;
         AttachA::Interface::typeVTable<typed_lgr<TextFile>>() = define_TextFile;
         AttachA::Interface::typeVTable<typed_lgr<files::FolderBrowser>>() = define_FolderBrowser;
     }
@@ -11,6 +11,7 @@ namespace file {
 	namespace constructor {
 		ValueItem* createProxy_FileHandle(ValueItem*, uint32_t);
 		ValueItem* createProxy_BlockingFileHandle(ValueItem*, uint32_t);
+		ValueItem* createProxy_MappedFile(ValueItem*, uint32_t);
 
 		ValueItem* createProxy_TextFile(ValueItem*, uint32_t);
 
@@ -10,6 +10,7 @@ namespace parallel {
 	AttachAVirtualTable* define_ConditionVariable;
 	AttachAVirtualTable* define_Mutex;
 	AttachAVirtualTable* define_RecursiveMutex;
+	AttachAVirtualTable* define_SharedMutex;
 	AttachAVirtualTable* define_Semaphore;
 	AttachAVirtualTable* define_ConcurentFile;
 	AttachAVirtualTable* define_EventSystem;
@@ -43,6 +44,12 @@ namespace parallel {
 	}
 
 #pragma region ConditionVariable
+	//shared_mutex paired with condition variable in exclusive mode
+	MutexUnify extractMutexUnify(ValueItem& item){
+		if(item.meta.vtype == VType::struct_ && ((Structure&)item).get_vtable() == define_SharedMutex)
+			return MutexUnify(*AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(item, define_SharedMutex));
+		return MutexUnify(*AttachA::Interface::getExtractAs<typed_lgr<TaskMutex>>(item, define_Mutex));
+	}
 	AttachAFun(funs_ConditionVariable_wait, 1,{
 		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskConditionVariable>>(args[0], define_ConditionVariable);
 		switch (len) {
@@ -55,8 +62,7 @@ namespace parallel {
 		}
 		case 2:{
 			if (args[1].meta.vtype == VType::struct_) {
-				auto& mutex = AttachA::Interface::getExtractAs<typed_lgr<TaskMutex>>(args[1], define_Mutex);
-				MutexUnify unif(*mutex);
+				MutexUnify unif = extractMutexUnify(args[1]);
 				art::unique_lock lock(unif, art::adopt_lock);
 				class_.wait(lock);
 				lock.release();
@@ -79,8 +85,7 @@ namespace parallel {
 		}
 		case 3:
 		default:{
-			auto& mutex = AttachA::Interface::getExtractAs<typed_lgr<TaskMutex>>(args[1], define_Mutex);
-			MutexUnify unif(*mutex);
+			MutexUnify unif = extractMutexUnify(args[1]);
 			art::unique_lock lock(unif, art::adopt_lock);
 			bool res;
 			if(args[2].meta.vtype == VType::time_point)
@@ -104,8 +109,7 @@ namespace parallel {
 		}
 		case 3:
 		default:{
-			auto& mutex = AttachA::Interface::getExtractAs<typed_lgr<TaskMutex>>(args[1], define_Mutex);
-			MutexUnify unif(*mutex);
+			MutexUnify unif = extractMutexUnify(args[1]);
 			art::unique_lock lock(unif, art::adopt_lock);
 			auto res = class_.wait_until(lock, (std::chrono::high_resolution_clock::time_point)args[2]);
 			lock.release();
@@ -233,6 +237,75 @@ namespace parallel {
 		AttachA::Interface::typeVTable<typed_lgr<TaskRecursiveMutex>>() = define_RecursiveMutex;
 	}
 #pragma endregion
+#pragma region SharedMutex
+	AttachAFun(funs_SharedMutex_lock, 1,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		class_.lock();
+	})
+	AttachAFun(funs_SharedMutex_unlock, 1,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		class_.unlock();
+	})
+	AttachAFun(funs_SharedMutex_try_lock, 1,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		if(len == 1)
+			return class_.try_lock();
+		else
+			return class_.try_lock_for((size_t)args[1]);
+	})
+	AttachAFun(funs_SharedMutex_try_lock_until, 2,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		return class_.try_lock_until((std::chrono::high_resolution_clock::time_point)args[1]);
+	})
+	AttachAFun(funs_SharedMutex_lock_shared, 1,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		class_.lock_shared();
+	})
+	AttachAFun(funs_SharedMutex_unlock_shared, 1,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		class_.unlock_shared();
+	})
+	AttachAFun(funs_SharedMutex_try_lock_shared, 1,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		if(len == 1)
+			return class_.try_lock_shared();
+		else
+			return class_.try_lock_shared_for((size_t)args[1]);
+	})
+	AttachAFun(funs_SharedMutex_try_lock_shared_until, 2,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		return class_.try_lock_shared_until((std::chrono::high_resolution_clock::time_point)args[1]);
+	})
+	AttachAFun(funs_SharedMutex_is_locked, 1,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		return class_.is_locked();
+	})
+	AttachAFun(funs_SharedMutex_is_locked_shared, 1,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		return class_.is_locked_shared();
+	})
+	AttachAFun(funs_SharedMutex_is_own, 1,{
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSharedMutex>>(args[0], define_SharedMutex);
+		return class_.is_own();
+	})
+
+	void init_SharedMutex() {
+		define_SharedMutex = AttachA::Interface::createTable<typed_lgr<TaskSharedMutex>>("shared_mutex",
+			AttachA::Interface::direct_method("lock", funs_SharedMutex_lock),
+			AttachA::Interface::direct_method("unlock", funs_SharedMutex_unlock),
+			AttachA::Interface::direct_method("try_lock", funs_SharedMutex_try_lock),
+			AttachA::Interface::direct_method("try_lock_until", funs_SharedMutex_try_lock_until),
+			AttachA::Interface::direct_method("lock_shared", funs_SharedMutex_lock_shared),
+			AttachA::Interface::direct_method("unlock_shared", funs_SharedMutex_unlock_shared),
+			AttachA::Interface::direct_method("try_lock_shared", funs_SharedMutex_try_lock_shared),
+			AttachA::Interface::direct_method("try_lock_shared_until", funs_SharedMutex_try_lock_shared_until),
+			AttachA::Interface::direct_method("is_locked", funs_SharedMutex_is_locked),
+			AttachA::Interface::direct_method("is_locked_shared", funs_SharedMutex_is_locked_shared),
+			AttachA::Interface::direct_method("is_own", funs_SharedMutex_is_own)
+		);
+		AttachA::Interface::typeVTable<typed_lgr<TaskSharedMutex>>() = define_SharedMutex;
+	}
+#pragma endregion
 #pragma region Semaphore
 	AttachAFun(funs_Semaphore_lock, 1,{
 		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskSemaphore>>(args[0], define_Semaphore);
@@ -657,36 +730,64 @@ namespace parallel {
 #pragma endregion
 #pragma region TaskGroup
 	AttachAFun(funs_TaskGroup_start, 1, {
-		Task::start(AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup));
+		AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup)->start();
+	})
+	//optional second argument is time_point or timeout in milliseconds, remaining tasks cancelled on timeout
+	AttachAFun(funs_TaskGroup_wait_all, 1, {
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup);
+		if(len == 1){
+			class_.wait_all();
+			return true;
+		}
+		else if(args[1].meta.vtype == VType::time_point)
+			return class_.wait_all_until((std::chrono::high_resolution_clock::time_point)args[1]);
+		else
+			return class_.wait_all_until(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds((uint64_t)args[1]));
 	})
+	//arguments: pre_started, release, timeout as time_point or milliseconds
+	//pre_started kept for compatibility, group starts not started children itself
 	AttachAFun(funs_TaskGroup_await_multiple, 1, {
-		switch (len) {
-		case 1:
-			Task::await_multiple(AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup));
-			break;
-		case 2:
-			Task::await_multiple(AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup), (bool)args[1]);
-			break;
-		case 3:
-		default:{
-			bool release = (bool)args[2];
-			Task::await_multiple(AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup), (bool)args[1], release);
-			if(release)
-				AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup).clear();
-			break;
-		}
-		}
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup);
+		bool completed = true;
+		if(len < 4)
+			class_.wait_all();
+		else if(args[3].meta.vtype == VType::time_point)
+			completed = class_.wait_all_until((std::chrono::high_resolution_clock::time_point)args[3]);
+		else
+			completed = class_.wait_all_until(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds((uint64_t)args[3]));
+		if(completed && len >= 3 && (bool)args[2])
+			class_.clear();
+		return completed;
+	})
+	AttachAFun(funs_TaskGroup_wait_any, 1, {
+		auto& class_ = *AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup);
+		typed_lgr<Task> res;
+		if(len == 1)
+			res = class_.wait_any();
+		else if(args[1].meta.vtype == VType::time_point)
+			res = class_.wait_any_until((std::chrono::high_resolution_clock::time_point)args[1]);
+		else
+			res = class_.wait_any_until(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds((uint64_t)args[1]));
+		if(!res)
+			return ValueItem();
+		return ValueItem(AttachA::Interface::constructStructure<typed_lgr<Task>>(define_Task, res), no_copy);
+	})
+	AttachAFun(funs_TaskGroup_first_result, 1, {
+		return AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup)->first_result();
+	})
+	AttachAFun(funs_TaskGroup_has_failure, 1, {
+		return AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup)->has_failure();
 	})
 	AttachAFun(funs_TaskGroup_await_results, 1, {
-		return Task::await_results(AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup));
+		return AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup)->results();
 	})
 	AttachAFun(funs_TaskGroup_notify_cancel, 1, {
-		Task::notify_cancel(AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup));
+		AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup)->cancel();
 	})
 
 	template<typename T>
 	AttachAFun(funs_TaskGroup_array_to_, 1, {
-		auto results = Task::await_results(AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup));
+		auto results = AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup)->results();
 		
 		if(results.size() > UINT32_MAX)
 			throw InvalidCast("Task internal result array is too large to convert to an array");
@@ -700,23 +801,31 @@ namespace parallel {
 	})
 	AttachAFun(funs_TaskGroup_to_set, 1, {
 		std::unordered_set<ValueItem> res;
-		for(auto& i : Task::await_results(AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup)))
+		for(auto& i : AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup)->results())
 			res.insert(i);
 		return res;
 	})
-	void ___createProxy_TaskGroup__push_item(list_array<typed_lgr<Task>>& tasks, ValueItem& item){
+	AttachAFun(funs_TaskGroup_to_uarr, 1, {
+		return AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup)->results();
+	})
+	void ___createProxy_TaskGroup__push_item(TaskGroup& group, ValueItem& item){
 		switch(item.meta.vtype){
 			case VType::async_res:
-				tasks.push_back((typed_lgr<Task>&)item);
+				group.add((typed_lgr<Task>&)item);
 				break;
 			case VType::struct_:
 				{
 					Structure& str = (Structure&)item;
 					if(str.get_vtable() == define_Task){
-						tasks.push_back(AttachA::Interface::getAs<typed_lgr<Task>>(str));
+						group.add(AttachA::Interface::getAs<typed_lgr<Task>>(str));
 						break;
 					}else if (str.get_vtable() == define_TaskGroup){
-						tasks.push_back(AttachA::Interface::getAs<list_array<typed_lgr<Task>>>(str));
+						//task belongs only to one group, nested group awaited and its finished children merged
+						auto& nested = AttachA::Interface::getAs<typed_lgr<TaskGroup>>(str);
+						if(nested.getPtr() == &group)
+							break;
+						nested->wait_all();
+						group.add(nested->children());
 						break;
 					}else
 						break;
@@ -724,7 +833,7 @@ namespace parallel {
 			case VType::uarr:{
 				list_array<ValueItem>& arr = *(list_array<ValueItem>*)item.getSourcePtr();
 				for(auto& it : arr)
-					___createProxy_TaskGroup__push_item(tasks, it);
+					___createProxy_TaskGroup__push_item(group, it);
 				break;
 			}
 			case VType::faarr:
@@ -732,19 +841,19 @@ namespace parallel {
 				ValueItem* arr = (ValueItem*)item.getSourcePtr();
 				uint32_t len = item.meta.val_len;
 				for(uint32_t i = 0; i < len; i++)
-					___createProxy_TaskGroup__push_item(tasks, arr[i]);
+					___createProxy_TaskGroup__push_item(group, arr[i]);
 				break;
 			}
 			case VType::set:{
 				std::unordered_set<ValueItem>& set = (std::unordered_set<ValueItem>&)item;
 				for(auto& it : set)
-					___createProxy_TaskGroup__push_item(tasks, const_cast<ValueItem&>(it));
+					___createProxy_TaskGroup__push_item(group, const_cast<ValueItem&>(it));
 				break;
 			}
 			case VType::map:{
 				std::unordered_map<ValueItem, ValueItem>& map = (std::unordered_map<ValueItem, ValueItem>&)item;
 				for(auto& it : map)
-					___createProxy_TaskGroup__push_item(tasks, it.second);
+					___createProxy_TaskGroup__push_item(group, it.second);
 				break;
 			}
 			default:
@@ -752,14 +861,18 @@ namespace parallel {
 		}
 	}
 	AttachAFun(funs_TaskGroup_add, 1, {
-		auto& tasks = AttachA::Interface::getExtractAs<list_array<typed_lgr<Task>>>(args[0], define_TaskGroup);
-		for(uint32_t i = 0; i < len; i++)
-			___createProxy_TaskGroup__push_item(tasks, args[i]);
+		auto& group = *AttachA::Interface::getExtractAs<typed_lgr<TaskGroup>>(args[0], define_TaskGroup);
+		for(uint32_t i = 1; i < len; i++)
+			___createProxy_TaskGroup__push_item(group, args[i]);
 	})
 	void init_TaskGroup() {
-		define_TaskGroup = AttachA::Interface::createTable<list_array<typed_lgr<Task>>>("task_group",
+		define_TaskGroup = AttachA::Interface::createTable<typed_lgr<TaskGroup>>("task_group",
 			AttachA::Interface::direct_method("start", funs_TaskGroup_start),
 			AttachA::Interface::direct_method("await_multiple", funs_TaskGroup_await_multiple),
+			AttachA::Interface::direct_method("wait_all", funs_TaskGroup_wait_all),
+			AttachA::Interface::direct_method("wait_any", funs_TaskGroup_wait_any),
+			AttachA::Interface::direct_method("first_result", funs_TaskGroup_first_result),
+			AttachA::Interface::direct_method("has_failure", funs_TaskGroup_has_failure),
 			AttachA::Interface::direct_method("await_results", funs_TaskGroup_await_results),
 			AttachA::Interface::direct_method("notify_cancel", funs_TaskGroup_notify_cancel),
 			AttachA::Interface::direct_method(symbols::structures::convert::to_ui8_arr, funs_TaskGroup_array_to_<uint8_t>),
@@ -774,10 +887,10 @@ namespace parallel {
 			AttachA::Interface::direct_method(symbols::structures::convert::to_double_arr, funs_TaskGroup_array_to_<double>),
 			AttachA::Interface::direct_method(symbols::structures::convert::to_farr, funs_TaskGroup_array_to_<ValueItem>),
 			AttachA::Interface::direct_method(symbols::structures::convert::to_set, funs_TaskGroup_to_set),
-			AttachA::Interface::direct_method(symbols::structures::convert::to_uarr, funs_TaskGroup_await_multiple),
+			AttachA::Interface::direct_method(symbols::structures::convert::to_uarr, funs_TaskGroup_to_uarr),
 			AttachA::Interface::direct_method(symbols::structures::add_operator, funs_TaskGroup_add)
 		);
-		AttachA::Interface::typeVTable<list_array<typed_lgr<Task>>>() = define_TaskGroup;
+		AttachA::Interface::typeVTable<typed_lgr<TaskGroup>>() = define_TaskGroup;
 	}
 #pragma endregion
 
@@ -797,6 +910,9 @@ namespace parallel {
 		ValueItem* createProxy_RecursiveMutex(ValueItem*, uint32_t) {
 			return new ValueItem(AttachA::Interface::constructStructure<typed_lgr<TaskRecursiveMutex>>(define_RecursiveMutex, new TaskRecursiveMutex()), no_copy);
 		}
+		ValueItem* createProxy_SharedMutex(ValueItem*, uint32_t) {
+			return new ValueItem(AttachA::Interface::constructStructure<typed_lgr<TaskSharedMutex>>(define_SharedMutex, new TaskSharedMutex()), no_copy);
+		}
 		ValueItem* createProxy_Semaphore(ValueItem*, uint32_t) {
 			return new ValueItem(AttachA::Interface::constructStructure<typed_lgr<TaskSemaphore>>(define_Semaphore, new TaskSemaphore()), no_copy);
 		}
@@ -828,15 +944,10 @@ namespace parallel {
 				return ValueItem(AttachA::Interface::constructStructure<typed_lgr<Task>>(define_Task, AttachA::Interface::getExtractAs<typed_lgr<Task>>(args[0],define_Task)), no_copy);
 		})
 		ValueItem* createProxy_TaskGroup(ValueItem* val, uint32_t len) {
-			if(!len)
-				return new ValueItem(AttachA::Interface::constructStructure<list_array<typed_lgr<Task>>>(define_TaskGroup), no_copy);
-			else{
-				list_array<typed_lgr<Task>> tasks;
-				tasks.reserve_push_back(len);
-				for(uint32_t i = 0; i < len; i++)
-					___createProxy_TaskGroup__push_item(tasks, val[i]);
-				return new ValueItem(AttachA::Interface::constructStructure<list_array<typed_lgr<Task>>>(define_TaskGroup, std::move(tasks)), no_copy);
-			}
+			typed_lgr<TaskGroup> group = new TaskGroup();
+			for(uint32_t i = 0; i < len; i++)
+				___createProxy_TaskGroup__push_item(*group, val[i]);
+			return new ValueItem(AttachA::Interface::constructStructure<typed_lgr<TaskGroup>>(define_TaskGroup, group), no_copy);
 		}
 	}
 	
@@ -1036,7 +1147,17 @@ namespace parallel {
 		bool used_task_local;
 		ValueItem args;
 		parseArgumentsToTask<0>(vals, len, func,fault_func, timeout, used_task_local, args);
-		return new ValueItem(new typed_lgr(new Task(func, args, used_task_local, fault_func, timeout)), VType::async_res, no_copy);
+		typed_lgr<Task> task = make_lgr<Task>(func, args, used_task_local, fault_func, timeout);
+		//6: priority, 0 high .. 4 low, 7: deadline as time_point or milliseconds from now
+		if(len > 6) if(vals[6].meta.vtype != VType::noting)
+			task->set_priority((TaskPriority)(uint8_t)vals[6]);
+		if(len > 7) if(vals[7].meta.vtype != VType::noting){
+			if(vals[7].meta.vtype == VType::time_point)
+				task->set_deadline((std::chrono::high_resolution_clock::time_point)vals[7]);
+			else
+				task->set_deadline(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds((uint64_t)vals[7]));
+		}
+		return new ValueItem(new typed_lgr(std::move(task)), VType::async_res, no_copy);
 	}
 
 
@@ -1107,6 +1228,9 @@ namespace parallel {
 			Task::explicitStartTimer();
 			return nullptr;
 		}
+		ValueItem* metrics(ValueItem*, uint32_t){
+			return new ValueItem(Task::metrics());
+		}
 	}
 
 	namespace atomic{
@@ -1877,6 +2001,7 @@ namespace parallel {
 		init_ConditionVariable();
 		init_Mutex();
 		init_RecursiveMutex();
+		init_SharedMutex();
 		init_Semaphore();
 		init_EventSystem();
 		init_TaskLimiter();
@@ -13,6 +13,8 @@ namespace parallel {
 		ValueItem* createProxy_ConditionVariable(ValueItem*, uint32_t);
 		ValueItem* createProxy_Mutex(ValueItem*, uint32_t);
 		ValueItem* createProxy_RecursiveMutex(ValueItem*, uint32_t);
+		//readers use lock_shared/unlock_shared, pending writer blocks new readers
+		ValueItem* createProxy_SharedMutex(ValueItem*, uint32_t);
 		ValueItem* createProxy_Semaphore(ValueItem*, uint32_t);
 
 		ValueItem* createProxy_EventSystem(ValueItem*, uint32_t);
@@ -42,6 +44,8 @@ namespace parallel {
 		ValueItem* await_no_tasks(ValueItem*, uint32_t);
 		ValueItem* await_end_tasks(ValueItem*, uint32_t);
 		ValueItem* explicitStartTimer(ValueItem*, uint32_t);
+		//returns map[global, totals, workers], see Task::metrics
+		ValueItem* metrics(ValueItem*, uint32_t);
 	}
 	namespace atomic{
 		namespace constructor {
@@ -70,6 +74,6 @@ namespace parallel {
 	//returns task that wait native thread and return function result
 	ValueItem* createAsyncThread(ValueItem*, uint32_t);
 
-	//returns task, args: [func, (fault handler), (timeout), (used_task_local)], sarr,farr[args....]
+	//returns task, args: [func, (fault handler), (timeout), (used_task_local)], sarr,farr[args....], (priority), (deadline)
 	ValueItem* createTask(ValueItem*, uint32_t);
 }
\ No newline at end of file
@@ -49,6 +49,20 @@ __declspec(noinline) static void lgr_join_snapshot_0(list_array<std::vector<void
 #define snap_rec_lgr_arg
 #endif
 
+void lgr::free_counters() {
+	if (in_block) {
+		//block starts with counters
+		lgr_block* block = (lgr_block*)total;
+		if (block->release)
+			block->release(block);
+		else
+			::operator delete(block);
+	}
+	else {
+		delete total;
+		delete weak;
+	}
+}
 void lgr::exit() {
 	lgr_exit_snapshot(snap_records, current_snap);
 	if (total == nullptr);
@@ -57,8 +71,7 @@ void lgr::exit() {
 			return;
 		--(*weak);
 		if (!*weak && !*total) {
-			delete total;
-			delete weak;
+			free_counters();
 			rm_lgr_snap_records;
 		}
 	}
@@ -68,8 +81,7 @@ void lgr::exit() {
 		if (ptr)
 			if (destructor) destructor(ptr);
 		if (!*weak) {
-			delete total;
-			delete weak;
+			free_counters();
 			rm_lgr_snap_records;
 		}
 	}
@@ -104,12 +116,25 @@ lgr::lgr(void* copy, bool(*clc_depth)(void*), void(*destruct)(void*), bool as_we
 		lgr_join_snapshot_0(snap_records, current_snap);
 	}
 }
+lgr::lgr(lgr_block* block, void* object, bool(*clc_depth)(void*), void(*destruct)(void*)) : calc_depth(clc_depth), destructor(destruct) {
+	ptr = object;
+	total = &block->total;
+	weak = &block->weak;
+	in_block = true;
+	in_safe_deph = calcDeph();
+	if (!in_safe_deph) {
+		++(*weak);
+		--(*total);
+	}
+	lgr_join_snapshot_0(snap_records, current_snap);
+}
 lgr::lgr(const lgr& copy) {
 	if (this == &copy)return;
 	if (total || weak) exit();
 	ptr = copy.ptr;
 	calc_depth = copy.calc_depth;
 	destructor = copy.destructor;
+	in_block = copy.in_block;
 	join(copy.total, copy.weak as_snap_rec_lgr_arg);
 }
 lgr::lgr(lgr&& mov) can_throw {
@@ -121,6 +146,7 @@ lgr::lgr(lgr&& mov) can_throw {
 	total = mov.total;
 	weak = mov.weak;
 	in_safe_deph = mov.in_safe_deph;
+	in_block = mov.in_block;
 	calc_depth = mov.calc_depth;
 	destructor = mov.destructor;
 	mov.ptr = nullptr;
@@ -142,6 +168,7 @@ lgr& lgr::operator=(const lgr& copy) {
 	ptr = copy.ptr;
 	calc_depth = copy.calc_depth;
 	destructor = copy.destructor;
+	in_block = copy.in_block;
 	join(copy.total, copy.weak as_snap_rec_lgr_arg);
 	return *this;
 }
@@ -155,6 +182,7 @@ lgr& lgr::operator=(lgr&& mov) can_throw {
 	total = mov.total;
 	weak = mov.weak;
 	in_safe_deph = mov.in_safe_deph;
+	in_block = mov.in_block;
 	calc_depth = mov.calc_depth;
 	destructor = mov.destructor;
 	mov.ptr = nullptr;
@@ -203,6 +231,9 @@ bool lgr::alone(){
 	return false;
 }
 void* lgr::try_take_ptr() {
+	//object in block can not be released separately from counters
+	if(in_block)
+		return nullptr;
 	if(alone()){
 		void* res = ptr;
 		ptr = nullptr;
@@ -212,6 +243,9 @@ void* lgr::try_take_ptr() {
 	return nullptr;
 }
 bool lgr::calcDeph() {
+	//types without depth_safety always safe, skip thread local set
+	if (!calc_depth)
+		return true;
 	bool res = depth_safety();
 	__lgr_safe_deph.clear();
 	return res;
@@ -6,11 +6,20 @@
 
 #pragma once
 #include <atomic>
+#include <concepts>
+#include <new>
 #include <unordered_set>
 #include "../library/list_array.hpp"
 #define ENABLE_SNAPSHOTS_LGR false
 extern thread_local std::unordered_set<const void*> __lgr_safe_deph;
 
+//counters placed at start of allocation, object stored right after them, used by make_lgr
+struct lgr_block {
+	std::atomic_size_t total;
+	std::atomic_size_t weak;
+	void(*release)(void*);//frees whole block, nullptr for ::operator delete
+};
+
 class lgr {
 #if ENABLE_SNAPSHOTS_LGR
 	list_array<std::vector<void*>*>* snap_records = nullptr;
@@ -29,13 +38,17 @@ class lgr {
 	std::atomic_size_t* total = nullptr;
 	std::atomic_size_t* weak = nullptr;
 	bool in_safe_deph = false;
+	bool in_block = false;
 
+	void free_counters();
 	void exit();
 	void join(std::atomic_size_t* p_total_links, std::atomic_size_t* tot_weak snap_rec_lgr_arg);
 public:
 	lgr();
 	lgr(nullptr_t) : lgr(){};
 	lgr(void* copy, bool(*clc_depth)(void*) = nullptr, void(*destruct)(void*) = nullptr, bool as_weak = false);
+	//object must be placed in same allocation after block, destruct should only call destructor
+	lgr(lgr_block* block, void* object, bool(*clc_depth)(void*), void(*destruct)(void*));
 	lgr(const lgr& copy);
 	lgr(lgr&& mov) can_throw;
 	~lgr();
@@ -101,7 +114,7 @@ template<class T, bool as_array = false>
 class typed_lgr {
 	lgr actual_lgr;
 
-	template<typename = std::enable_if_t<has_depth_safety<T, bool()>::value>>
+	//instantiated only when referenced from get_depth_calc
 	static bool depth_calc(void* v) {
 		return ((T*)v)->depth_safety();
 	}
@@ -119,6 +132,14 @@ public:
 		else
 			delete (T*)v;
 	}
+	static void destruct_in_block(void* v) {
+		((T*)v)->~T();
+	}
+	template<class U, class... Args>
+	friend typed_lgr<U> make_lgr(Args&&... args);
+private:
+	explicit typed_lgr(lgr&& actual) noexcept : actual_lgr(std::move(actual)) {}
+public:
 	typed_lgr() {}
 	typed_lgr(nullptr_t) {};
 	typed_lgr(T* capture, bool as_weak = false) : actual_lgr(capture, get_depth_calc(), destruct, as_weak) { }
@@ -183,4 +204,44 @@ public:
 	operator ptrdiff_t() const {
 		return actual_lgr;
 	}
-};
\ No newline at end of file
+};
+
+template<class T>
+concept has_lgr_block_allocator = requires(size_t size, void* ptr) {
+	{ T::allocate_lgr_block(size) } -> std::same_as<void*>;
+	T::free_lgr_block(ptr);
+};
+
+//object and both counters in one allocation, object memory released when last weak link gone
+//types with allocate_lgr_block/free_lgr_block provide memory for whole block
+template<class T, class... Args>
+typed_lgr<T> make_lgr(Args&&... args) {
+	struct block_t {
+		lgr_block counters;
+		alignas(T) unsigned char object[sizeof(T)];
+	};
+	static_assert(alignof(block_t) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "make_lgr does not support over-aligned types");
+	block_t* block;
+	void(*release)(void*);
+	if constexpr (has_lgr_block_allocator<T>) {
+		block = (block_t*)T::allocate_lgr_block(sizeof(block_t));
+		release = T::free_lgr_block;
+	}
+	else {
+		block = (block_t*)::operator new(sizeof(block_t));
+		release = nullptr;
+	}
+	new (&block->counters) lgr_block{ {1}, {0}, release };
+	T* object;
+	try {
+		object = ::new (block->object) T(std::forward<Args>(args)...);
+	}
+	catch (...) {
+		if (release)
+			release(block);
+		else
+			::operator delete(block);
+		throw;
+	}
+	return typed_lgr<T>(lgr(&block->counters, object, typed_lgr<T>::get_depth_calc(), typed_lgr<T>::destruct_in_block));
+}
@@ -971,6 +971,7 @@ extern "C" void initStandardLib_file(){
 	file::init();
 	FuncEnvironment::AddNative(file::constructor::createProxy_FileHandle, "# file file_handle", false);
 	FuncEnvironment::AddNative(file::constructor::createProxy_BlockingFileHandle, "# file blocking_file_handle", false);
+	FuncEnvironment::AddNative(file::constructor::createProxy_MappedFile, "# file mapped_file", false);
 	FuncEnvironment::AddNative(file::constructor::createProxy_TextFile, "# file text_file", false);
 	FuncEnvironment::AddNative(file::constructor::createProxy_FolderBrowser, "# file folder_browser", false);
 	FuncEnvironment::AddNative(file::constructor::createProxy_FolderChangesMonitor, "# file folder_changes_monitor", false);
@@ -983,6 +984,7 @@ extern "C" void initStandardLib_paralel(){
 	parallel::init();
 	FuncEnvironment::AddNative(parallel::constructor::createProxy_Mutex, "# parallel mutex", false);
 	FuncEnvironment::AddNative(parallel::constructor::createProxy_RecursiveMutex, "# parallel recursive_mutex", false);
+	FuncEnvironment::AddNative(parallel::constructor::createProxy_SharedMutex, "# parallel shared_mutex", false);
 	FuncEnvironment::AddNative(parallel::constructor::createProxy_ConditionVariable, "# parallel condition_variable", false);
 	FuncEnvironment::AddNative(parallel::constructor::createProxy_Semaphore, "# parallel semaphore", false);
 	FuncEnvironment::AddNative(parallel::constructor::createProxy_EventSystem, "# parallel event_system", false);
@@ -1000,6 +1002,7 @@ extern "C" void initStandardLib_paralel(){
 	FuncEnvironment::AddNative(parallel::task_runtime::clean_up, "parallel task_runtime clean_up", false);
 	FuncEnvironment::AddNative(parallel::task_runtime::create_executor, "parallel task_runtime create_executor", false);
 	FuncEnvironment::AddNative(parallel::task_runtime::explicitStartTimer, "parallel task_runtime explicitStartTimer", false);
+	FuncEnvironment::AddNative(parallel::task_runtime::metrics, "parallel task_runtime metrics", false);
 	FuncEnvironment::AddNative(parallel::task_runtime::reduce_executor, "parallel task_runtime reduce_executor", false);
 	FuncEnvironment::AddNative(parallel::task_runtime::total_executors, "parallel task_runtime total_executors", false);
 	FuncEnvironment::AddNative(parallel::this_task::check_cancelation, "parallel this_task check_cancelation", false);
@@ -1028,6 +1031,7 @@ extern "C" void initStandardLib_chanel(){
 	INIT_CHECK
 	FuncEnvironment::AddNative(chanel::constructor::createProxy_Chanel, "# chanel chanel", false);
 	FuncEnvironment::AddNative(chanel::constructor::createProxy_ChanelHandler, "# chanel chanel_handler", false);
+	FuncEnvironment::AddNative(chanel::constructor::createProxy_BoundedChanel, "# chanel bounded_chanel", false);
 }
 extern "C" void initStandardLib_internal(){
 	INIT_CHECK
@@ -5,6 +5,7 @@
 // http://www.boost.org/LICENSE_1_0.txt)
 
 #include <list>
+#include <cassert>
 #include <boost/context/continuation.hpp>
 
 #include "AttachA_CXX.hpp"
@@ -18,6 +19,11 @@
 #include "tasks_util/hill_climbing.hpp"
 #include "library/parallel.hpp"
 #include "tasks_util/native_workers_singleton.hpp"
+#include "tasks_util/work_stealing_deque.hpp"
+#include "tasks_util/timer_wheel.hpp"
+#include "tasks_util/task_metrics.hpp"
+#include "tasks_util/ready_queue.hpp"
+#include "tasks_util/numa.hpp"
 #include "../../configuration/tasks.hpp"
 
 
@@ -71,6 +77,12 @@ void MutexUnify::lock() {
 	case MutexUnifyType::mmut:
 		mmut->lock();
 		break;
+	case MutexUnifyType::rwmut:
+		rwmut->lock();
+		break;
+	case MutexUnifyType::rwmut_shared:
+		rwmut->lock_shared();
+		break;
 	default:
 		break;
 	}
@@ -85,6 +97,10 @@ bool MutexUnify::try_lock() {
 		return nrec->try_lock();
 	case MutexUnifyType::umut:
 		return umut->try_lock();
+	case MutexUnifyType::rwmut:
+		return rwmut->try_lock();
+	case MutexUnifyType::rwmut_shared:
+		return rwmut->try_lock_shared();
 	default:
 		return false;
 	}
@@ -101,6 +117,10 @@ bool MutexUnify::try_lock_for(size_t milliseconds) {
 		return umut->try_lock_for(milliseconds);
 	case MutexUnifyType::mmut:
 		return mmut->try_lock_for(milliseconds);
+	case MutexUnifyType::rwmut:
+		return rwmut->try_lock_for(milliseconds);
+	case MutexUnifyType::rwmut_shared:
+		return rwmut->try_lock_shared_for(milliseconds);
 	default:
 		return false;
 	}
@@ -117,6 +137,10 @@ bool MutexUnify::try_lock_until(std::chrono::high_resolution_clock::time_point t
 		return umut->try_lock_until(time_point);
 	case MutexUnifyType::mmut:
 		return mmut->try_lock_until(time_point);
+	case MutexUnifyType::rwmut:
+		return rwmut->try_lock_until(time_point);
+	case MutexUnifyType::rwmut_shared:
+		return rwmut->try_lock_shared_until(time_point);
 	default:
 		return false;
 	}
@@ -138,6 +162,12 @@ void MutexUnify::unlock() {
 	case MutexUnifyType::mmut:
 		mmut->unlock();
 		break;
+	case MutexUnifyType::rwmut:
+		rwmut->unlock();
+		break;
+	case MutexUnifyType::rwmut_shared:
+		rwmut->unlock_shared();
+		break;
 	default:
 		break;
 	}
@@ -167,6 +197,10 @@ MutexUnify::MutexUnify(TaskMutex& smut) {
 	type = MutexUnifyType::umut;
 	umut = std::addressof(smut);
 }
+MutexUnify::MutexUnify(TaskSharedMutex& smut, bool shared) {
+	type = shared ? MutexUnifyType::rwmut_shared : MutexUnifyType::rwmut;
+	rwmut = std::addressof(smut);
+}
 MutexUnify::MutexUnify(nullptr_t) {
 	type = MutexUnifyType::noting;
 }
@@ -196,6 +230,11 @@ MutexUnify& MutexUnify::operator=(TaskMutex& smut) {
 	umut = std::addressof(smut);
 	return *this;
 }
+MutexUnify& MutexUnify::operator=(TaskSharedMutex& smut) {
+	type = MutexUnifyType::rwmut;
+	rwmut = std::addressof(smut);
+	return *this;
+}
 MutexUnify& MutexUnify::operator=(nullptr_t) {
 	type = MutexUnifyType::noting;
 	return *this;
@@ -291,6 +330,12 @@ void MultiplyMutex::unlock() {
 size_t Task::max_running_tasks = configuration::tasks::max_running_tasks;
 size_t Task::max_planned_tasks = configuration::tasks::max_planned_tasks;
 bool Task::enable_task_naming = configuration::tasks::enable_task_naming;
+bool Task::enable_work_stealing = configuration::tasks::enable_work_stealing;
+size_t Task::priority_aging_step = configuration::tasks::priority_aging_step;
+bool Task::pin_workers = configuration::tasks::numa::pin_workers;
+bool Task::enable_task_affinity = configuration::tasks::numa::task_affinity;
+size_t Task::blocking_stuck_threshold = configuration::tasks::blocking::stuck_threshold;
+bool Task::enable_metrics = configuration::tasks::enable_metrics;
 
 TaskCancellation::TaskCancellation() : AttachARuntimeException("This task received cancellation token") {}
 TaskCancellation::~TaskCancellation() {
@@ -364,14 +409,17 @@ TaskResult::TaskResult(TaskResult&& move) noexcept {
 }
 #pragma endregion
 struct timing {
-	std::chrono::high_resolution_clock::time_point wait_timepoint; 
 	typed_lgr<Task> awake_task; 
 	uint16_t check_id;
 };
+using task_ready_queue = run_time::tasks::util::ready_queue<typed_lgr<Task>, (size_t)TaskPriority::low + 1, (size_t)TaskPriority::avg>;
+std::chrono::nanoseconds priority_aging_step(){
+	return std::chrono::milliseconds(Task::priority_aging_step);
+}
 struct binded_context{
 	run_time::tasks::util::hill_climb executor_manager_hill_climb;
 	std::list<uint32_t> completions;
-	std::list<typed_lgr<Task>> tasks;
+	task_ready_queue tasks;
 	TaskConditionVariable on_closed_notifier;
 	art::recursive_mutex no_race;
 	art::condition_variable_any new_task_notifier;
@@ -380,19 +428,53 @@ struct binded_context{
 	bool allow_implicit_start = false;
 	bool fixed_size = false;
 };
+//only owner can push to deque, so tasks resumed by other threads with affinity to worker placed to inbox
+struct local_task_queue : public run_time::tasks::util::work_stealing_deque<typed_lgr<Task>> {
+	art::mutex inbox_safety;
+	std::deque<typed_lgr<Task>*> inbox;
+	std::atomic_size_t inbox_size = 0;
+	size_t node = 0;
+	uint32_t worker_id = 0;
+	std::atomic_int64_t running_since = 0;//steady clock ns when current task started, 0 when idle or detection disabled
+	std::atomic_bool in_blocking_region = false;
+
+	void push_inbox(typed_lgr<Task>* task){
+		art::lock_guard guard(inbox_safety);
+		inbox.push_back(task);
+		++inbox_size;
+	}
+	typed_lgr<Task>* pop_inbox(){
+		if(!inbox_size)
+			return nullptr;
+		art::lock_guard guard(inbox_safety);
+		if(inbox.empty())
+			return nullptr;
+		typed_lgr<Task>* task = inbox.front();
+		inbox.pop_front();
+		--inbox_size;
+		return task;
+	}
+};
+//after this count of tasks taken from local queue, worker checks global queue, to not starve injected tasks
+constexpr size_t local_tasks_streak_limit = 61;
+//after this count of failed steals while local queues not empty, worker parks instead of yield
+constexpr size_t failed_steals_limit = 16;
+constexpr std::chrono::milliseconds failed_steals_park = std::chrono::milliseconds(1);
 struct {
 	TaskConditionVariable no_tasks_notifier;
 	TaskConditionVariable no_tasks_execute_notifier;
 
-	std::queue<typed_lgr<Task>> tasks;
-	std::queue<typed_lgr<Task>> cold_tasks;
-	std::deque<timing> timed_tasks;
+	task_ready_queue tasks;
+	task_ready_queue cold_tasks;
+	run_time::tasks::util::timer_wheel<timing> timed_tasks;
 
+	//lock order: Task::no_race before task_thread_safety, never lock task while holding global lock
 	art::recursive_mutex task_thread_safety;
 	art::mutex task_timer_safety;
 
 	art::condition_variable_any tasks_notifier;
 	art::condition_variable_any time_notifier;
+	std::chrono::high_resolution_clock::time_point timer_planned_wake = std::chrono::high_resolution_clock::time_point::min();
 
 	size_t executors = 0;
 	size_t in_exec = 0;
@@ -403,6 +485,14 @@ struct {
 	std::atomic_size_t in_run_tasks= 0;
 	std::atomic_size_t planned_tasks = 0;
 
+	std::atomic_size_t tasks_in_local_queues = 0;
+	std::atomic_size_t idle_executors = 0;
+	std::atomic_uint32_t next_worker_id = 1;
+	std::atomic_size_t next_worker_processor = 0;
+	art::rw_mutex local_queues_safety;
+	std::vector<local_task_queue*> local_queues;
+	std::unordered_map<uint32_t, local_task_queue*> local_queues_by_worker;//used by affinity to find last worker
+
 	TaskConditionVariable can_started_new_notifier;
 	TaskConditionVariable can_planned_new_notifier;
 	
@@ -413,6 +503,9 @@ struct {
 	art::condition_variable_any executor_manager_task_taken;
 	run_time::tasks::util::hill_climb executor_manager_hill_climb;
 	std::list<uint32_t> workers_completions;
+	size_t blocked_workers = 0;//in blocking region
+	size_t stuck_workers = 0;//detected by executor manager
+	size_t compensating_workers = 0;
 
 	
 	#if _configuration_tasks_enable_debug_mode
@@ -432,7 +525,43 @@ struct {
 	bool context_in_swap = false;
 
 	bool in_exec_decreased = false;
+	uint32_t blocking_depth = 0;
+	bool blocking_counted = false;
+
+	local_task_queue* local_queue = nullptr;
+	size_t steal_from = 0;
+	size_t numa_node = 0;
 } thread_local loc;
+
+#pragma region Metrics
+run_time::tasks::util::worker_metrics& local_metrics(){
+	auto& metrics = run_time::tasks::util::task_metrics::local();
+	if (!metrics.thread_id)
+		metrics.thread_id = _thread_id();
+	return metrics;
+}
+//min when metrics disabled, so callers skip sample
+std::chrono::high_resolution_clock::time_point metrics_now(){
+	if (!Task::enable_metrics)
+		return std::chrono::high_resolution_clock::time_point::min();
+	return std::chrono::high_resolution_clock::now();
+}
+uint64_t metrics_elapsed_ns(std::chrono::high_resolution_clock::time_point from){
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - from).count();
+}
+void metrics_record(run_time::tasks::util::latency_histogram& histogram, std::chrono::high_resolution_clock::time_point from){
+	if (from != std::chrono::high_resolution_clock::time_point::min())
+		histogram.record(metrics_elapsed_ns(from));
+}
+void markReady(Task& task){
+	if (Task::enable_metrics)
+		task.ready_since.store(std::chrono::high_resolution_clock::now(), std::memory_order_relaxed);
+}
+void markTaken(Task& task){
+	auto since = task.ready_since.exchange(std::chrono::high_resolution_clock::time_point::min(), std::memory_order_relaxed);
+	metrics_record(local_metrics().ready_wait, since);
+}
+#pragma endregion
 struct TaskCallback {
 	static void dummy(ValueItem&){}
 	ValueItem args;
@@ -549,21 +678,35 @@ void swapCtxRelock(const MutexUnify& mut0, const MutexUnify& mut1) {
 
 void warmUpTheTasks() {
 	if (!Task::max_running_tasks && glob.tasks.empty()) {
-		std::swap(glob.tasks, glob.cold_tasks);
+		glob.tasks.swap(glob.cold_tasks);
 	}
 	else {
 		size_t placed = glob.in_run_tasks;
-		while (!glob.cold_tasks.empty() && Task::max_running_tasks > placed++) {
-			glob.tasks.push(std::move(glob.cold_tasks.front()));
-			glob.cold_tasks.pop();
-		}
+		while (!glob.cold_tasks.empty() && Task::max_running_tasks > placed++)
+			glob.tasks.push(glob.cold_tasks.take(priority_aging_step()), priority_aging_step());
 		if (Task::max_running_tasks > placed && glob.cold_tasks.empty())
 			glob.can_started_new_notifier.notify_all();
 	}
 }
 
+//learned size from measured high water mark, deeper path than measured one must not reach guard pages
+size_t learned_stack_size(size_t high_water) {
+	if (!high_water)
+		return 0;
+	size_t bytes = high_water * configuration::tasks::light_stack::learn_margin;
+	return std::max(bytes, high_water + configuration::tasks::light_stack::learn_min_headroom);
+}
+//hint first, then recorded usage when learning enabled
+size_t task_stack_size(FuncEnvironment& func) {
+	size_t bytes = func.stackHint();
+	if (!bytes && light_stack::learn_stack_size)
+		bytes = learned_stack_size(func.stackHighWater());
+	return bytes ? light_stack::size_class(bytes) : configuration::tasks::light_stack::default_size;
+}
+
 ctx::continuation context_exec(ctx::continuation&& sink) {
 	*loc.tmp_current_context = std::move(sink);
+	bool cancelled = false;
 	try {
 		checkCancelation();
 		ValueItem* res = loc.curr_task->func->syncWrapper((ValueItem*)loc.curr_task->args.val, loc.curr_task->args.meta.val_len);
@@ -574,6 +717,7 @@ ctx::continuation context_exec(ctx::continuation&& sink) {
 	}
 	catch (TaskCancellation& cancel) {
 		forceCancelCancellation(cancel);
+		cancelled = true;
 	}
 	catch (const ctx::detail::forced_unwind&) {
 		throw;
@@ -581,11 +725,20 @@ ctx::continuation context_exec(ctx::continuation&& sink) {
 	catch (...) {
 		loc.ex_ptr = std::current_exception();
 	}
+	//failed and cancelled runs recorded too, their path can be deepest one
+	if (light_stack::learn_stack_size)
+		loc.curr_task->func->recordStackUsage(light_stack::high_water_size());
 	try{
 		loc.curr_task->args = nullptr;
 	}catch(...){};
 	art::lock_guard l(loc.curr_task->no_race);
 	loc.curr_task->end_of_life = true;
+	//cancelled task has no final result, awaiters still must be released
+	//exception result stored later by execute_task, it sets end flag itself
+	if (cancelled) {
+		loc.curr_task->was_cancelled = true;
+		loc.curr_task->fres.end_of_life = true;
+	}
 	loc.curr_task->fres.result_notify.notify_all();
 	--glob.in_run_tasks;
 	if (Task::max_running_tasks)
@@ -594,6 +747,7 @@ ctx::continuation context_exec(ctx::continuation&& sink) {
 }
 ctx::continuation context_ex_handle(ctx::continuation&& sink) {
 	*loc.tmp_current_context = std::move(sink);
+	bool cancelled = false;
 	try {
 		checkCancelation();
 		ValueItem* res = loc.curr_task->ex_handle->syncWrapper((ValueItem*)loc.curr_task->args.val, loc.curr_task->args.meta.val_len);
@@ -604,6 +758,7 @@ ctx::continuation context_ex_handle(ctx::continuation&& sink) {
 	}
 	catch (TaskCancellation& cancel) {
 		forceCancelCancellation(cancel);
+		cancelled = true;
 	}
 	catch (const ctx::detail::forced_unwind&) {
 		throw;
@@ -618,6 +773,10 @@ ctx::continuation context_ex_handle(ctx::continuation&& sink) {
 	MutexUnify uni(loc.curr_task->no_race);
 	art::unique_lock l(uni);
 	loc.curr_task->end_of_life = true;
+	if (cancelled) {
+		loc.curr_task->was_cancelled = true;
+		loc.curr_task->fres.end_of_life = true;
+	}
 	loc.curr_task->fres.result_notify.notify_all();
 	--glob.in_run_tasks;
 	if (Task::max_running_tasks)
@@ -626,10 +785,177 @@ ctx::continuation context_ex_handle(ctx::continuation&& sink) {
 }
 
 
+#pragma region LocalQueues
+//pins worker when enabled and remembers its node, so stealing and stacks prefers local node
+void placeWorker(){
+	if(Task::pin_workers){
+		size_t processor = glob.next_worker_processor++ % run_time::tasks::numa::processors_count();
+		if(run_time::tasks::numa::pin_current_thread(processor)){
+			loc.numa_node = run_time::tasks::numa::node_of_processor(processor);
+			return;
+		}
+	}
+	loc.numa_node = run_time::tasks::numa::current_node();
+}
+local_task_queue* registerLocalQueue(){
+	local_task_queue* queue = new local_task_queue();
+	queue->node = loc.numa_node;
+	queue->worker_id = glob.next_worker_id++;
+	art::lock_guard guard(glob.local_queues_safety);
+	glob.local_queues.push_back(queue);
+	glob.local_queues_by_worker[queue->worker_id] = queue;
+	return queue;
+}
+//must be called under glob.task_thread_safety, moves remaining tasks to global queue
+void unregisterLocalQueue(local_task_queue* queue){
+	{
+		art::lock_guard guard(glob.local_queues_safety);
+		glob.local_queues.erase(std::find(glob.local_queues.begin(), glob.local_queues.end(), queue));
+		glob.local_queues_by_worker.erase(queue->worker_id);
+	}
+	bool moved = false;
+	while(typed_lgr<Task>* task = queue->pop()){
+		--glob.tasks_in_local_queues;
+		glob.tasks.push(std::move(*task), priority_aging_step());
+		delete task;
+		moved = true;
+	}
+	while(typed_lgr<Task>* task = queue->pop_inbox()){
+		--glob.tasks_in_local_queues;
+		glob.tasks.push(std::move(*task), priority_aging_step());
+		delete task;
+		moved = true;
+	}
+	delete queue;
+	if(moved)
+		glob.tasks_notifier.notify_all();
+}
+//only worker thread that owns local queue can push to it
+//local queues are plain lifo/fifo, so prioritized tasks and tasks with deadline always go to global queue
+bool pushLocalTask(typed_lgr<Task>& task){
+	if(!loc.local_queue || !Task::enable_work_stealing)
+		return false;
+	if(task->priority != TaskPriority::avg || task->deadline != std::chrono::high_resolution_clock::time_point::min())
+		return false;
+	markReady(*task);
+	loc.local_queue->push(new typed_lgr<Task>(std::move(task)));
+	++glob.tasks_in_local_queues;
+	run_time::tasks::util::metric_add(local_metrics().local_pushes);
+	if(glob.idle_executors){
+		art::lock_guard guard(glob.task_thread_safety);
+		glob.tasks_notifier.notify_one();
+	}
+	return true;
+}
+//resumed task goes to inbox of worker that executed it last time, prioritized tasks keeps global order
+bool pushAffinityTask(typed_lgr<Task>& task){
+	if(!Task::enable_task_affinity || !task->last_worker)
+		return false;
+	if(task->priority != TaskPriority::avg || task->deadline != std::chrono::high_resolution_clock::time_point::min())
+		return false;
+	if(loc.local_queue && loc.local_queue->worker_id == task->last_worker)
+		return false;
+	{
+		art::shared_lock guard(glob.local_queues_safety);
+		auto it = glob.local_queues_by_worker.find(task->last_worker);
+		if(it == glob.local_queues_by_worker.end())
+			return false;
+		markReady(*task);
+		it->second->push_inbox(new typed_lgr<Task>(std::move(task)));
+		++glob.tasks_in_local_queues;
+	}
+	if(glob.idle_executors){
+		art::lock_guard guard(glob.task_thread_safety);
+		glob.tasks_notifier.notify_one();
+	}
+	return true;
+}
+//first pass over queues of own node, second over remote nodes
+typed_lgr<Task>* stealTask(){
+	art::shared_lock guard(glob.local_queues_safety);
+	size_t count = glob.local_queues.size();
+	for(bool local_node : {true, false}){
+		for(size_t i = 0; i < count; i++){
+			size_t victim_id = (loc.steal_from + i) % count;
+			local_task_queue* victim = glob.local_queues[victim_id];
+			if(victim == loc.local_queue || (victim->node == loc.numa_node) != local_node)
+				continue;
+			typed_lgr<Task>* task = victim->steal();
+			if(!task)
+				task = victim->pop_inbox();
+			if(task){
+				loc.steal_from = victim_id;
+				run_time::tasks::util::metric_add(local_metrics().steals);
+				return task;
+			}
+		}
+	}
+	return nullptr;
+}
+//used by worker affinity, see Task::enable_task_affinity
+void rememberWorker(Task& task){
+	task.last_worker = loc.local_queue ? loc.local_queue->worker_id : 0;
+}
+//local queues filled without running limit check, so limited mode rechecks here like loadTask
+bool setLocalTask(typed_lgr<Task>* task){
+	--glob.tasks_in_local_queues;
+	typed_lgr<Task> taken = std::move(*task);
+	delete task;
+	if (Task::max_running_tasks) {
+		art::lock_guard guard(glob.task_thread_safety);
+		bool not_started = !reinterpret_cast<ctx::continuation&>(taken->fres.context);
+		if (not_started && Task::max_running_tasks <= glob.in_run_tasks + glob.tasks_in_swap) {
+			glob.cold_tasks.push(std::move(taken), priority_aging_step());
+			return false;
+		}
+		if (Task::max_running_tasks > glob.in_run_tasks + glob.tasks_in_swap && !glob.cold_tasks.empty()) {
+			glob.tasks.push(glob.cold_tasks.take(priority_aging_step()), priority_aging_step());
+			glob.tasks_notifier.notify_one();
+		}
+	}
+	loc.curr_task = std::move(taken);
+	markTaken(*loc.curr_task);
+	rememberWorker(*loc.curr_task);
+	loc.context_in_swap = false;
+	loc.is_task_thread = true;
+	loc.tmp_current_context = &reinterpret_cast<ctx::continuation&>(loc.curr_task->fres.context);
+	return true;
+}
+//pop from own local queue, then try steal from others
+bool loadLocalTask(){
+	typed_lgr<Task>* task = loc.local_queue ? loc.local_queue->pop_inbox() : nullptr;
+	if(!task && loc.local_queue)
+		task = loc.local_queue->pop();
+	if(!task)
+		task = stealTask();
+	if(!task)
+		return false;
+	return setLocalTask(task);
+}
+//fast path, called without global lock
+//urgent tasks in global queue break the streak, so they does not wait behind local work
+bool loadOwnLocalTask(size_t& streak){
+	if(!loc.local_queue || ++streak >= local_tasks_streak_limit || glob.tasks.urgent())
+		return false;
+	typed_lgr<Task>* task = loc.local_queue->pop_inbox();
+	if(!task)
+		task = loc.local_queue->pop();
+	if(!task)
+		return false;
+	return setLocalTask(task);
+}
+#pragma endregion
+
 void transfer_task(typed_lgr<Task>& task){
 	if(task->bind_to_worker_id ==  (uint16_t)-1){
+		if(pushAffinityTask(task))
+			return;
+		if(pushLocalTask(task))
+			return;
+		markReady(*task);
+		run_time::tasks::util::metric_add(local_metrics().injections);
 		art::lock_guard guard(glob.task_thread_safety);
-		glob.tasks.push(std::move(task));
+		glob.tasks.push(std::move(task), priority_aging_step());
 		glob.tasks_notifier.notify_one();
 	}else{
 		art::unique_lock initializer_guard(glob.binded_workers_safety);
@@ -644,8 +970,9 @@ void transfer_task(typed_lgr<Task>& task){
 			invite_to_debugger("Binded worker context " + std::to_string(task->bind_to_worker_id) + " is closed");
 			std::abort();
 		}
+		markReady(*task);
 		art::lock_guard guard(extern_context.no_race);
-		extern_context.tasks.push_back(std::move(task));
+		extern_context.tasks.push(std::move(task), priority_aging_step());
 		extern_context.new_task_notifier.notify_one();
 	}
 }
@@ -660,7 +987,8 @@ void awake_task(typed_lgr<Task>& task){
 					guard.unlock();
 					art::unique_lock context_quard(context.no_race);
 					task->bind_to_worker_id = id;
-					context.tasks.push_back(std::move(task));
+					markReady(*task);
+					context.tasks.push(std::move(task), priority_aging_step());
 					context.new_task_notifier.notify_one();
 					return;
 				}
@@ -675,8 +1003,11 @@ void taskNotifyIfEmpty(art::unique_lock<art::recursive_mutex>& re_lock) {
 	if(!loc.in_exec_decreased)
 		--glob.in_exec;
 	loc.in_exec_decreased = false;
-	if (!glob.in_exec && glob.tasks.empty() && glob.timed_tasks.empty()) 
-		glob.no_tasks_execute_notifier.notify_all();
+	if (glob.tasks.empty() && !glob.tasks_in_local_queues) {
+		glob.no_tasks_notifier.notify_all();
+		if (!glob.in_exec && glob.timed_tasks.empty())
+			glob.no_tasks_execute_notifier.notify_all();
+	}
 }
 bool loadTask() {
 	{
@@ -684,23 +1015,20 @@ bool loadTask() {
 		size_t len = glob.tasks.size();
 		if (!len)
 			return true;
-		auto tmp = std::move(glob.tasks.front());
-		glob.tasks.pop();
+		auto tmp = glob.tasks.take(priority_aging_step());
 		if (len == 1)
 			glob.no_tasks_notifier.notify_all();
 		loc.curr_task = std::move(tmp);
+		markTaken(*loc.curr_task);
+		rememberWorker(*loc.curr_task);
 		if(Task::max_running_tasks){
 			if (Task::max_running_tasks > (glob.in_run_tasks + glob.tasks_in_swap)) {
-				if (!glob.cold_tasks.empty()) {
-					glob.tasks.push(std::move(glob.cold_tasks.front()));
-					glob.cold_tasks.pop();
-				}
+				if (!glob.cold_tasks.empty())
+					glob.tasks.push(glob.cold_tasks.take(priority_aging_step()), priority_aging_step());
 			}
 		}else{
-			while(!glob.cold_tasks.empty()){
-				glob.tasks.push(std::move(glob.cold_tasks.front()));
-				glob.cold_tasks.pop();
-			}
+			while(!glob.cold_tasks.empty())
+				glob.tasks.push(glob.cold_tasks.take(priority_aging_step()), priority_aging_step());
 		}
 	}
 	loc.tmp_current_context = &reinterpret_cast<ctx::continuation&>(loc.curr_task->fres.context);
@@ -743,12 +1071,14 @@ void pseudo_task_handle(const std::string& old_name, bool &caught_ex){
 	loc.is_task_thread = true;
 }
 
+void notifyTaskGroup(Task& task);
 bool execute_task(const std::string& old_name){
 	bool pseudo_handle_caugnt_ex = false;
 	if (!loc.curr_task->func)
 		return true;
 	if(loc.curr_task->_task_local == (ValueEnvironment*)-1 || loc.curr_task->func->isCheap()){
 		pseudo_task_handle(old_name, pseudo_handle_caugnt_ex);
+		run_time::tasks::util::metric_add(local_metrics().tasks_executed);
 		if (pseudo_handle_caugnt_ex)
 			goto caught_ex;
 		goto end_task;
@@ -758,6 +1088,7 @@ bool execute_task(const std::string& old_name){
 
 	worker_mode_desk(old_name, "process task - " + std::to_string(loc.curr_task->task_id()));
 	if (*loc.tmp_current_context) {
+		run_time::tasks::util::metric_add(local_metrics().context_resumes);
 		*loc.tmp_current_context = std::move(*loc.tmp_current_context).resume();
 	}
 	else {
@@ -765,8 +1096,10 @@ bool execute_task(const std::string& old_name){
 		--glob.planned_tasks;
 		if (Task::max_planned_tasks)
 			glob.can_planned_new_notifier.notify_one();
-		*loc.tmp_current_context = ctx::callcc(std::allocator_arg, light_stack(1048576/*1 mb*/), context_exec);
+		*loc.tmp_current_context = ctx::callcc(std::allocator_arg, light_stack(task_stack_size(*loc.curr_task->func)), context_exec);
 	}
+	if (loc.curr_task->end_of_life)
+		run_time::tasks::util::metric_add(local_metrics().tasks_executed);
 caught_ex:
 	if (loc.ex_ptr) {
 		if (loc.curr_task->ex_handle) {
@@ -783,6 +1116,8 @@ caught_ex:
 		loc.ex_ptr = nullptr;
 	}
 end_task:
+	if (loc.curr_task->fres.end_of_life)
+		notifyTaskGroup(*loc.curr_task);
 	loc.is_task_thread = false;
 	loc.curr_task = nullptr;
 	worker_mode_desk(old_name, "idle");
@@ -790,16 +1125,23 @@ end_task:
 }
 void taskExecutor(bool end_in_task_out = false) {
 	std::string old_name = end_in_task_out ? _get_name_thread_dbg(_thread_id()) : "";
+	light_stack::prepare_thread();
 
 	if(old_name.empty())
 		_set_name_thread_dbg("Worker " + std::to_string(_thread_id()));
 	else
 		_set_name_thread_dbg(old_name + " | (Temoral worker) " + std::to_string(_thread_id()));
 
+	//temporal workers does not have own queue, but can steal
+	if(!end_in_task_out){
+		placeWorker();
+		loc.local_queue = registerLocalQueue();
+	}
 	art::unique_lock guard(glob.task_thread_safety);
 	glob.workers_completions.push_front(0);
 	auto to_remove_after_death = glob.workers_completions.begin();
 	uint32_t& completions = glob.workers_completions.front();
+	size_t failed_steals = 0;
 	++glob.in_exec;
 	++glob.executors;
 	while (true) {
@@ -818,45 +1160,91 @@ void taskExecutor(bool end_in_task_out = false) {
 					break;
 				}
 			}
+			if (glob.tasks_in_local_queues) {
+				if (loadLocalTask()) {
+					failed_steals = 0;
+					++glob.in_exec;
+					goto task_taken;
+				}
+				//task in the middle of pop by other worker, or moved to cold queue
+				if (++failed_steals < failed_steals_limit) {
+					guard.unlock();
+					art::this_thread::yield();
+					guard.lock();
+					continue;
+				}
+				//counter stays positive while owner busy with pop, so park with timeout instead of spinning
+				failed_steals = 0;
+				if (end_in_task_out)
+					goto end_worker;
+				++glob.idle_executors;
+				glob.tasks_notifier.wait_for(guard, failed_steals_park);
+				--glob.idle_executors;
+				continue;
+			}
 
 			if (end_in_task_out) 
 				goto end_worker;
+			++glob.idle_executors;
+			//recheck after increment, pushLocalTask notifies only when sees idle executors
+			if (glob.tasks_in_local_queues) {
+				--glob.idle_executors;
+				continue;
+			}
 			glob.tasks_notifier.wait(guard);
+			--glob.idle_executors;
 		}
 		loc.is_task_thread = true;
 		if (loadTask())
 			continue;
+	task_taken:
 		glob.executor_manager_task_taken.notify_one();
 		guard.unlock();
-		if(loc.curr_task->bind_to_worker_id != (uint16_t)-1){
-			transfer_task(loc.curr_task);
-			guard.lock();
-			continue;
-		}
-#if _configuration_tasks_enable_debug_mode
 		{
-			art::shared_lock dbg_guard(glob.debug_safety);
-			glob.on_workers_tasks.push_back(loc.curr_task.getPtr());
-		}
+			bool shut_down_signal = false;
+			uint32_t local_completions = 0;
+			size_t local_streak = 0;
+			do {
+				if(loc.curr_task->bind_to_worker_id != (uint16_t)-1){
+					transfer_task(loc.curr_task);
+					continue;
+				}
+#if _configuration_tasks_enable_debug_mode
+				{
+					art::shared_lock dbg_guard(glob.debug_safety);
+					glob.on_workers_tasks.push_back(loc.curr_task.getPtr());
+				}
 #endif
-		//if func is nullptr then this task signal to shutdown executor
-		bool shut_down_signal = execute_task(old_name);
+				if (Task::blocking_stuck_threshold && loc.local_queue)
+					loc.local_queue->running_since.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+				//if func is nullptr then this task signal to shutdown executor
+				shut_down_signal = execute_task(old_name);
+				if (loc.local_queue)
+					loc.local_queue->running_since.store(0, std::memory_order_relaxed);
 #if _configuration_tasks_enable_debug_mode
-		{
-			art::shared_lock dbg_guard(glob.debug_safety);
-			Task* ptr = loc.curr_task.getPtr();
-			auto it = std::find(glob.on_workers_tasks.rbegin(), glob.on_workers_tasks.rend(), ptr);
-			if(it != glob.on_workers_tasks.rend())
-				glob.on_workers_tasks.erase(std::next(it).base());
-		}
+				{
+					art::shared_lock dbg_guard(glob.debug_safety);
+					Task* ptr = loc.curr_task.getPtr();
+					auto it = std::find(glob.on_workers_tasks.rbegin(), glob.on_workers_tasks.rend(), ptr);
+					if(it != glob.on_workers_tasks.rend())
+						glob.on_workers_tasks.erase(std::next(it).base());
+				}
 #endif
-
-		guard.lock();
-		if (shut_down_signal)
-			break;
-		completions +=1;
+				if (shut_down_signal)
+					break;
+				local_completions += 1;
+			} while (loadOwnLocalTask(local_streak));
+			guard.lock();
+			completions += local_completions;
+			if (shut_down_signal)
+				break;
+		}
 	}
 end_worker:
+	if(loc.local_queue){
+		unregisterLocalQueue(loc.local_queue);
+		loc.local_queue = nullptr;
+	}
 	--glob.executors;
 	glob.workers_completions.erase(to_remove_after_death);
 	taskNotifyIfEmpty(guard);
@@ -864,6 +1252,7 @@ end_worker:
 
 void bindedTaskExecutor(uint16_t id){
 	std::string old_name = "Binded";
+	light_stack::prepare_thread();
 	art::unique_lock initializer_guard(glob.binded_workers_safety);
 	if(!glob.binded_workers.contains(id)){
 		invite_to_debugger("Binded worker context " + std::to_string(id) + " not found");
@@ -875,22 +1264,23 @@ void bindedTaskExecutor(uint16_t id){
 	uint32_t& completions = context.completions.front();
 	initializer_guard.unlock();
 
-	std::list<typed_lgr<Task>>& queue = context.tasks;
+	task_ready_queue& queue = context.tasks;
 	art::recursive_mutex& safety = context.no_race;
 	art::condition_variable_any& notifier = context.new_task_notifier;
 	bool pseudo_handle_caugnt_ex = false;
 	_set_name_thread_dbg("Binded worker " + std::to_string(_thread_id()) + ": " + std::to_string(id));
+	placeWorker();
 
 	art::unique_lock guard(safety);
 	context.executors++;
 	while(true){
 		while(queue.empty())
 			notifier.wait(guard);
-		loc.curr_task = std::move(queue.front());
-		queue.pop_front();
+		loc.curr_task = queue.take(priority_aging_step());
 		guard.unlock();
 		if (!loc.curr_task->func)
 			break;
+		markTaken(*loc.curr_task);
 		if(loc.curr_task->bind_to_worker_id !=  (uint16_t)id){
 			transfer_task(loc.curr_task);
 			continue;
@@ -935,48 +1325,43 @@ void bindedTaskExecutor(uint16_t id){
 void taskTimer() {
 	_set_name_thread_dbg("Task time controller");
 
-	art::mutex mtx;
-	mtx.lock();
+	list_array<timing> expired;
 	list_array<typed_lgr<Task>> cached_wake_ups;
+	art::unique_lock guard(glob.task_timer_safety);
 	while (true) {
-		{
-			art::lock_guard guard(glob.task_timer_safety);
-			if (glob.timed_tasks.size()) {
-				while (glob.timed_tasks.front().wait_timepoint <= std::chrono::high_resolution_clock::now()) {
-					timing& tmng = glob.timed_tasks.front();
-					if (tmng.check_id != tmng.awake_task->awake_check) {
-						glob.timed_tasks.pop_front();
-						if (glob.timed_tasks.empty())
-							break;
-						else
-							continue;
-					}
-					art::lock_guard task_guard(tmng.awake_task->no_race);
-					if (tmng.awake_task->awaked) {
-						glob.timed_tasks.pop_front();
-					}
-					else {
-						tmng.awake_task->time_end_flag = true;
-						cached_wake_ups.push_back(std::move(tmng.awake_task));
-						glob.timed_tasks.pop_front();
-					}
-					if (glob.timed_tasks.empty())
-						break;
+		glob.timed_tasks.advance(std::chrono::high_resolution_clock::now(), [&expired](timing&& tmng) {
+			expired.push_back(std::move(tmng));
+		});
+		if (!expired.empty()) {
+			//task no_race locked outside timer lock, sleeping task holds own no_race while inserts timing
+			guard.unlock();
+			for (timing& tmng : expired) {
+				if (tmng.check_id != tmng.awake_task->awake_check)
+					continue;
+				art::lock_guard task_guard(tmng.awake_task->no_race);
+				if (!tmng.awake_task->awaked) {
+					tmng.awake_task->time_end_flag = true;
+					markReady(*tmng.awake_task);
+					cached_wake_ups.push_back(std::move(tmng.awake_task));
 				}
 			}
+			expired.clear();
+			if (!cached_wake_ups.empty()) {
+				art::lock_guard task_guard(glob.task_thread_safety);
+				run_time::tasks::util::metric_add(local_metrics().injections, cached_wake_ups.size());
+				while (!cached_wake_ups.empty()) 
+					glob.tasks.push(cached_wake_ups.take_back(), priority_aging_step());
+				glob.tasks_notifier.notify_all();
+			}
+			guard.lock();
+			continue;
 		}
-		if (!cached_wake_ups.empty()) {
-			art::lock_guard guard(glob.task_thread_safety);
-			while (!cached_wake_ups.empty()) 
-				glob.tasks.push(cached_wake_ups.take_back());
-			glob.tasks_notifier.notify_all();
-		}
-		
-
+		glob.timer_planned_wake = glob.timed_tasks.next_time_point();
 		if (glob.timed_tasks.empty())
-			glob.time_notifier.wait(mtx);
+			glob.time_notifier.wait(guard);
 		else
-			glob.time_notifier.wait_until(mtx, glob.timed_tasks.front().wait_timepoint);
+			glob.time_notifier.wait_until(guard, glob.timer_planned_wake);
+		glob.timer_planned_wake = std::chrono::high_resolution_clock::time_point::min();
 	}
 }
 
@@ -988,28 +1373,20 @@ void startTimeController() {
 	art::thread(taskTimer).detach();
 	glob.time_control_enabled = true;
 }
+//must be called under glob.task_timer_safety
+void pushTimeWait(std::chrono::high_resolution_clock::time_point t, const typed_lgr<Task>& task, uint16_t check_id) {
+	glob.timed_tasks.insert(t, timing(task, check_id));
+	//timer thread wakes up by itself before this time point
+	if (t < glob.timer_planned_wake)
+		glob.time_notifier.notify_one();
+}
 void makeTimeWait(std::chrono::high_resolution_clock::time_point t) {
 	if (!glob.time_control_enabled)
 		startTimeController();
 	loc.curr_task->awaked = false;
 	loc.curr_task->time_end_flag = false;
-	size_t i = 0;
-	{
-		art::lock_guard guard(glob.task_timer_safety);
-		auto it = glob.timed_tasks.begin();
-		auto end = glob.timed_tasks.end();
-		while (it != end) {
-			if (it->wait_timepoint >= t) {
-				glob.timed_tasks.insert(it, timing(t,loc.curr_task, loc.curr_task->awake_check ));
-				i = -1;
-				break;
-			}
-			++it;
-		}
-		if (i != -1)
-			glob.timed_tasks.push_back(timing(t, loc.curr_task, loc.curr_task->awake_check));
-	}
-	glob.time_notifier.notify_one();
+	art::lock_guard guard(glob.task_timer_safety);
+	pushTimeWait(t, loc.curr_task, loc.curr_task->awake_check);
 }
 
 #pragma region Task
@@ -1057,6 +1434,8 @@ Task::Task(Task&& mov) noexcept : fres(std::move(mov.fres)) {
 	awaked = mov.awaked;
 	started = mov.started;
 	is_yield_mode = mov.is_yield_mode;
+	priority = mov.priority;
+	deadline = mov.deadline;
 }
 Task::~Task() {
 	if (_task_local && _task_local != (ValueEnvironment*)-1)
@@ -1071,6 +1450,99 @@ Task::~Task() {
 	}
 }
 
+//block fits task alone and task placed after lgr_block by make_lgr
+static_assert(alignof(Task) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "pool blocks come from ::operator new, so task atomics must not need more alignment");
+constexpr size_t task_pool_block_size = (sizeof(Task) + sizeof(lgr_block) + alignof(Task) + 15) & ~size_t(15);
+using task_pool = run_time::tasks::util::object_pool<task_pool_block_size, configuration::tasks::task_pool::thread_cache_size, configuration::tasks::task_pool::depot_size>;
+void* Task::operator new(size_t size) {
+	if constexpr (configuration::tasks::task_pool::enable)
+		return task_pool::allocate();
+	else
+		return ::operator new(size);
+}
+void Task::operator delete(void* ptr) {
+	if constexpr (configuration::tasks::task_pool::enable)
+		task_pool::deallocate(ptr);
+	else
+		::operator delete(ptr);
+}
+void* Task::allocate_lgr_block(size_t size) {
+	if constexpr (configuration::tasks::task_pool::enable) {
+		if (size <= task_pool_block_size)
+			return task_pool::allocate();
+	}
+	return ::operator new(size);
+}
+void Task::free_lgr_block(void* ptr) {
+	//blocks bigger than pool block came from ::operator new, pool only requires block to be not smaller
+	if constexpr (configuration::tasks::task_pool::enable)
+		task_pool::deallocate(ptr);
+	else
+		::operator delete(ptr);
+}
+run_time::tasks::util::object_pool_stats Task::allocation_stats() {
+	return task_pool::stats();
+}
+
+ValueItem metrics_histogram(const run_time::tasks::util::histogram_snapshot& histogram) {
+	std::unordered_map<ValueItem, ValueItem> res;
+	res[std::string("count")] = histogram.count;
+	res[std::string("mean_ns")] = histogram.count ? histogram.sum / histogram.count : 0;
+	res[std::string("max_ns")] = histogram.max;
+	res[std::string("p50_ns")] = histogram.percentile(0.5);
+	res[std::string("p90_ns")] = histogram.percentile(0.9);
+	res[std::string("p99_ns")] = histogram.percentile(0.99);
+	res[std::string("p999_ns")] = histogram.percentile(0.999);
+	return ValueItem(std::move(res));
+}
+ValueItem metrics_worker(const run_time::tasks::util::worker_metrics_snapshot& metrics) {
+	std::unordered_map<ValueItem, ValueItem> res;
+	res[std::string("thread_id")] = metrics.thread_id;
+	res[std::string("tasks_executed")] = metrics.tasks_executed;
+	res[std::string("context_resumes")] = metrics.context_resumes;
+	res[std::string("steals")] = metrics.steals;
+	res[std::string("local_pushes")] = metrics.local_pushes;
+	res[std::string("injections")] = metrics.injections;
+	res[std::string("ready_wait")] = metrics_histogram(metrics.ready_wait);
+	res[std::string("mutex_wait")] = metrics_histogram(metrics.mutex_wait);
+	res[std::string("condition_wait")] = metrics_histogram(metrics.condition_wait);
+	return ValueItem(std::move(res));
+}
+ValueItem Task::metrics() {
+	std::unordered_map<ValueItem, ValueItem> global;
+	{
+		art::lock_guard guard(glob.task_thread_safety);
+		global[std::string("executors")] = glob.executors;
+		global[std::string("ready_queue")] = glob.tasks.size();
+		global[std::string("cold_queue")] = glob.cold_tasks.size();
+		global[std::string("urgent_queue")] = glob.tasks.urgent();
+		global[std::string("blocked_workers")] = glob.blocked_workers + glob.stuck_workers;
+		global[std::string("compensating_workers")] = glob.compensating_workers;
+	}
+	{
+		art::lock_guard guard(glob.task_timer_safety);
+		global[std::string("timer_queue")] = glob.timed_tasks.size();
+	}
+	global[std::string("idle_executors")] = glob.idle_executors.load();
+	global[std::string("local_queues")] = glob.tasks_in_local_queues.load();
+	global[std::string("running_tasks")] = glob.in_run_tasks.load();
+	global[std::string("planned_tasks")] = glob.planned_tasks.load();
+	global[std::string("suspended_tasks")] = glob.tasks_in_swap.load();
+	auto pool = allocation_stats();
+	global[std::string("task_pool_allocated")] = pool.allocated;
+	global[std::string("task_pool_reused")] = pool.reused;
+
+	list_array<ValueItem> workers;
+	for (auto& worker : run_time::tasks::util::task_metrics::workers())
+		workers.push_back(metrics_worker(worker));
+
+	std::unordered_map<ValueItem, ValueItem> res;
+	res[std::string("global")] = ValueItem(std::move(global));
+	res[std::string("totals")] = metrics_worker(run_time::tasks::util::task_metrics::totals());
+	res[std::string("workers")] = ValueItem(std::move(workers));
+	return ValueItem(std::move(res));
+}
+
 void Task::auto_bind_worker_enable(bool enable){
 	auto_bind_worker = enable;
 	if (enable)
@@ -1080,10 +1552,56 @@ void Task::set_worker_id(uint16_t id){
 	bind_to_worker_id = id;
 	auto_bind_worker = false;
 }
+void Task::set_priority(TaskPriority task_priority){
+	priority = task_priority;
+}
+void Task::set_deadline(std::chrono::high_resolution_clock::time_point task_deadline){
+	deadline = task_deadline;
+}
 
+//whole batch queued under one global lock, then woken min(batch, idle) workers
+//batch always goes to global queue, so idle workers pick it without stealing from one local queue
+template<class Iterator>
+void startBatch(Iterator begin, Iterator end, bool skip_callbacks) {
+	std::vector<typed_lgr<Task>> batch;
+	for (; begin != end; ++begin) {
+		typed_lgr<Task>& task = *begin;
+		if (skip_callbacks && task->_task_local == (ValueEnvironment*)-1)
+			continue;
+		if (task->started && !task->is_yield_mode)
+			continue;
+		art::lock_guard task_guard(task->no_race);
+		if (task->started && !task->is_yield_mode)
+			continue;
+		task->started = true;
+		markReady(*task);
+		batch.push_back(task);
+	}
+	if (batch.empty())
+		return;
+	run_time::tasks::util::metric_add(local_metrics().injections, batch.size());
+	art::lock_guard guard(glob.task_thread_safety);
+	bool can_run = Task::max_running_tasks > glob.in_run_tasks || !Task::max_running_tasks;
+	for (auto& task : batch) {
+		if (can_run)
+			glob.tasks.push(std::move(task), priority_aging_step());
+		else
+			glob.cold_tasks.push(std::move(task), priority_aging_step());
+	}
+	//only idle workers wait on tasks_notifier, so broadcast wakes exactly them
+	size_t idle = glob.idle_executors;
+	if (batch.size() >= idle)
+		glob.tasks_notifier.notify_all();
+	else {
+		for (size_t i = 0; i < batch.size(); i++)
+			glob.tasks_notifier.notify_one();
+	}
+}
 void Task::start(list_array<typed_lgr<Task>>& lgr_task) {
-	for (auto& it : lgr_task)
-		start(it);
+	startBatch(lgr_task.begin(), lgr_task.end(), false);
+}
+void Task::start(typed_lgr<Task>* lgr_task, size_t len) {
+	startBatch(lgr_task, lgr_task + len, false);
 }
 
 
@@ -1150,15 +1668,21 @@ void Task::start(const typed_lgr<Task>& tsk) {
 	typed_lgr<Task> lgr_task = tsk;
 	if (lgr_task->started && !lgr_task->is_yield_mode)
 		return;
+	art::lock_guard task_guard(lgr_task->no_race);
+	if (lgr_task->started && !lgr_task->is_yield_mode)
+		return;
+	lgr_task->started = true;
+	if (!Task::max_running_tasks && lgr_task->bind_to_worker_id == (uint16_t)-1)
+		if (pushLocalTask(lgr_task))
+			return;
+	markReady(*lgr_task);
+	run_time::tasks::util::metric_add(local_metrics().injections);
 	{
 		art::lock_guard guard(glob.task_thread_safety);
-		if (lgr_task->started && !lgr_task->is_yield_mode)
-			return;
 		if (Task::max_running_tasks > glob.in_run_tasks || !Task::max_running_tasks)
-			glob.tasks.push(lgr_task);
+			glob.tasks.push(lgr_task, ::priority_aging_step());
 		else
-			glob.cold_tasks.push(lgr_task);
-		lgr_task->started = true;
+			glob.cold_tasks.push(lgr_task, ::priority_aging_step());
 		glob.tasks_notifier.notify_one();
 	}
 }
@@ -1195,14 +1719,15 @@ void Task::close_bind_only_executor(uint16_t id) {
 			return;
 		context.in_close = true;
 		for(uint16_t i = 0; i < context.executors; i++){
-			context.tasks.push_back(new Task(nullptr, ValueItem()));
+			context.tasks.push(new Task(nullptr, ValueItem()), ::priority_aging_step());
 		}
 		context.new_task_notifier.notify_all();
 		context_lock.unlock();
 		while(context.executors != 0)
 			context.on_closed_notifier.wait(guard);
 
-		std::swap(transfer_tasks, context.tasks);
+		while(!context.tasks.empty())
+			transfer_tasks.push_back(context.tasks.take());
 		glob.binded_workers.erase(id);
 	}
 	for(typed_lgr<Task>& task : transfer_tasks){
@@ -1243,14 +1768,14 @@ void Task::await_no_tasks(bool be_executor) {
 	else {
 		MutexUnify uni(glob.task_thread_safety);
 		art::unique_lock l(uni);
-		while (glob.tasks.size() || glob.cold_tasks.size() || glob.timed_tasks.size())
+		while (glob.tasks.size() || glob.tasks_in_local_queues || glob.cold_tasks.size() || glob.timed_tasks.size())
 			glob.no_tasks_notifier.wait(l);
 	}
 }
 void Task::await_end_tasks(bool be_executor) {
 	if (be_executor && !loc.is_task_thread) {
 		art::unique_lock l(glob.task_thread_safety);
-		while (glob.tasks.size() || glob.cold_tasks.size() || glob.timed_tasks.size() || glob.in_exec || glob.tasks_in_swap) {
+		while (glob.tasks.size() || glob.tasks_in_local_queues || glob.cold_tasks.size() || glob.timed_tasks.size() || glob.in_exec || glob.tasks_in_swap) {
 			l.unlock();
 			try {
 				taskExecutor(true);
@@ -1266,20 +1791,16 @@ void Task::await_end_tasks(bool be_executor) {
 		MutexUnify uni(glob.task_thread_safety);
 		art::unique_lock l(uni);
 		if(loc.is_task_thread)
-			while ((glob.tasks.size() || glob.cold_tasks.size() || glob.timed_tasks.size()) && glob.in_exec != 1 && glob.tasks_in_swap != 1)
+			while ((glob.tasks.size() || glob.tasks_in_local_queues || glob.cold_tasks.size() || glob.timed_tasks.size()) && glob.in_exec != 1 && glob.tasks_in_swap != 1)
 				glob.no_tasks_execute_notifier.wait(l);
 		else
-			while (glob.tasks.size() || glob.cold_tasks.size() || glob.timed_tasks.size() || glob.in_exec  || glob.tasks_in_swap)
+			while (glob.tasks.size() || glob.tasks_in_local_queues || glob.cold_tasks.size() || glob.timed_tasks.size() || glob.in_exec  || glob.tasks_in_swap)
 				glob.no_tasks_execute_notifier.wait(l);
 	}
 }
 void Task::await_multiple(list_array<typed_lgr<Task>>& tasks, bool pre_started, bool release) {
-	if (!pre_started) {
-		for (auto& it : tasks){
-			if(it->_task_local != (ValueEnvironment*)-1)
-				Task::start(it);
-		}
-	}
+	if (!pre_started)
+		startBatch(tasks.begin(), tasks.end(), true);
 	if (release) {
 		for (auto& it : tasks) {
 			await_task(it, false);
@@ -1291,14 +1812,8 @@ void Task::await_multiple(list_array<typed_lgr<Task>>& tasks, bool pre_started,
 			await_task(it, false);
 }
 void Task::await_multiple(typed_lgr<Task>* tasks, size_t len, bool pre_started, bool release) {
-	if (!pre_started) {
-		typed_lgr<Task>* iter = tasks;
-		size_t count = len;
-		while (count--){
-			if ((*iter)->_task_local != (ValueEnvironment*)-1)
-				Task::start(*iter++);
-		}
-	}
+	if (!pre_started)
+		startBatch(tasks, tasks + len, true);
 	if (release) {
 		while (len--) {
 			await_task(*tasks, false);
@@ -1368,14 +1883,74 @@ bool Task::is_task(){
 	return loc.is_task_thread;
 }
 
+//caller holds task_thread_safety
+//one compensating worker per blocked or stuck worker when no worker idle, excess retired by shutdown tasks
+void compensateBlockedWorkers() {
+	size_t needed = glob.blocked_workers + glob.stuck_workers;
+	if (needed > configuration::tasks::blocking::max_compensating_workers)
+		needed = configuration::tasks::blocking::max_compensating_workers;
+	if (glob.compensating_workers < needed) {
+		if (glob.idle_executors || !(glob.tasks.size() || glob.tasks_in_local_queues || glob.cold_tasks.size()))
+			return;
+		for (; glob.compensating_workers < needed; glob.compensating_workers++)
+			art::thread(taskExecutor, false).detach();
+	}
+	else if (glob.compensating_workers > needed) {
+		typed_lgr<Task> task = new Task(nullptr, nullptr);
+		for (; glob.compensating_workers > needed; glob.compensating_workers--) {
+			glob.tasks.push(task, priority_aging_step());
+			glob.tasks_notifier.notify_one();
+		}
+	}
+}
+//watchdog for blocking calls without region markers
+size_t countStuckWorkers() {
+	if (!Task::blocking_stuck_threshold)
+		return 0;
+	int64_t started_before = (std::chrono::steady_clock::now() - std::chrono::milliseconds(Task::blocking_stuck_threshold)).time_since_epoch().count();
+	size_t stuck = 0;
+	art::shared_lock guard(glob.local_queues_safety);
+	for (local_task_queue* queue : glob.local_queues) {
+		int64_t since = queue->running_since.load(std::memory_order_relaxed);
+		if (since && since < started_before && !queue->in_blocking_region.load(std::memory_order_relaxed))
+			stuck++;
+	}
+	return stuck;
+}
+void Task::enter_blocking_region() {
+	if (loc.blocking_depth++)
+		return;
+	//binded workers sized by own context
+	loc.blocking_counted = loc.is_task_thread && loc.curr_task->bind_to_worker_id == (uint16_t)-1;
+	if (!loc.blocking_counted)
+		return;
+	if (loc.local_queue)
+		loc.local_queue->in_blocking_region.store(true, std::memory_order_relaxed);
+	art::lock_guard guard(glob.task_thread_safety);
+	glob.blocked_workers++;
+	compensateBlockedWorkers();
+}
+void Task::leave_blocking_region() {
+	if (!loc.blocking_depth || --loc.blocking_depth || !loc.blocking_counted)
+		return;
+	loc.blocking_counted = false;
+	if (loc.local_queue)
+		loc.local_queue->in_blocking_region.store(false, std::memory_order_relaxed);
+	art::lock_guard guard(glob.task_thread_safety);
+	glob.blocked_workers--;
+	//executor manager retires on next tick, so short regions in a row reuse same compensating worker
+	if (!glob.executor_manager_in_work)
+		compensateBlockedWorkers();
+}
+
 
 void Task::clean_up() {
 	Task::await_no_tasks();
-	std::queue<typed_lgr<Task>> e0;
-	std::queue<typed_lgr<Task>> e1;
-	glob.tasks.swap(e0);
-	glob.cold_tasks.swap(e1);
+	glob.tasks.clear();
+	glob.cold_tasks.clear();
 	glob.timed_tasks.shrink_to_fit();
+	if constexpr (configuration::tasks::task_pool::enable)
+		task_pool::trim();
 }
 
 
@@ -1442,106 +2017,110 @@ typed_lgr<Task> Task::fullifed_task(ValueItem&& result){
 }
 
 
-class native_task_shedule : public NativeWorkerHandle, public NativeWorkerManager {
+struct native_task_job {
 	typed_lgr<class FuncEnvironment> func;
 	ValueItem args;
-	bool started = false;
-public:
 	typed_lgr<Task> task;
-	
-	native_task_shedule(typed_lgr<class FuncEnvironment> func) : NativeWorkerHandle(this){
-		this->func = func;
-		task = Task::dummy_task();
-		task->started = true;
-	}
-	native_task_shedule(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments) : NativeWorkerHandle(this){
-		this->func = func;
-		task = Task::dummy_task();
-		task->started = true;
-		put_arguments(args, std::move(arguments));
-	}
-	native_task_shedule(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments) : NativeWorkerHandle(this){
-		this->func = func;
-		task = Task::dummy_task();
-		task->started = true;
-		put_arguments(args, arguments);
-	}
-	native_task_shedule(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout): NativeWorkerHandle(this){
-		this->func = func;
-		task = Task::callback_dummy(dummy_data, on_await, on_cancel, on_timeout, on_destruct, timeout);
-		task->started = true;
-		put_arguments(args, arguments);
-	}
-	native_task_shedule(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout): NativeWorkerHandle(this){
-		this->func = func;
-		task = Task::callback_dummy(dummy_data, on_await, on_cancel, on_timeout, on_destruct, timeout);
-		task->started = true;
-		put_arguments(args, std::move(arguments));
+	TaskPriority priority = TaskPriority::avg;
+	std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::min();
+};
+//native workers complete posts in fifo order, so post only signals that one job is pending and worker takes best job from this queue
+struct {
+	art::mutex no_race;
+	run_time::tasks::util::ready_queue<native_task_job*, (size_t)TaskPriority::low + 1, (size_t)TaskPriority::avg> jobs;
+} native_jobs;
+
+class native_task_shedule : public NativeWorkerHandle, public NativeWorkerManager {
+	native_task_job* job;
+public:
+	native_task_shedule(typed_lgr<class FuncEnvironment> func, typed_lgr<Task>&& task, TaskPriority priority, std::chrono::high_resolution_clock::time_point deadline) : NativeWorkerHandle(this){
+		job = new native_task_job{func, nullptr, std::move(task), priority, deadline};
+		job->task->started = true;
+		job->task->priority = priority;
+		job->task->deadline = deadline;
+	}
+	native_task_shedule(typed_lgr<class FuncEnvironment> func, TaskPriority priority = TaskPriority::avg, std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::min())
+		: native_task_shedule(func, Task::dummy_task(), priority, deadline){}
+	native_task_shedule(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments, TaskPriority priority = TaskPriority::avg, std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::min())
+		: native_task_shedule(func, Task::dummy_task(), priority, deadline){
+		put_arguments(job->args, std::move(arguments));
+	}
+	native_task_shedule(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments, TaskPriority priority = TaskPriority::avg, std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::min())
+		: native_task_shedule(func, Task::dummy_task(), priority, deadline){
+		put_arguments(job->args, arguments);
+	}
+	native_task_shedule(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout, TaskPriority priority, std::chrono::high_resolution_clock::time_point deadline)
+		: native_task_shedule(func, Task::callback_dummy(dummy_data, on_await, on_cancel, on_timeout, on_destruct, timeout), priority, deadline){
+		put_arguments(job->args, arguments);
+	}
+	native_task_shedule(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout, TaskPriority priority, std::chrono::high_resolution_clock::time_point deadline)
+		: native_task_shedule(func, Task::callback_dummy(dummy_data, on_await, on_cancel, on_timeout, on_destruct, timeout), priority, deadline){
+		put_arguments(job->args, std::move(arguments));
+	}
+	~native_task_shedule(){
+		if(job)
+			delete job;
 	}
 	void handle(void* unused0, NativeWorkerHandle* unused1, unsigned long unused2, bool unused3){
+		native_task_job* current;
+		{
+			art::lock_guard guard(native_jobs.no_race);
+			current = native_jobs.jobs.take(priority_aging_step());
+		}
 		ValueItem* result = nullptr;
 		try{
-			result = FuncEnvironment::sync_call(func, (ValueItem*)args.val, args.meta.val_len);
+			result = FuncEnvironment::sync_call(current->func, (ValueItem*)current->args.val, current->args.meta.val_len);
 		}catch(...){
-			MutexUnify mtx(task->no_race);
+			MutexUnify mtx(current->task->no_race);
 			art::unique_lock<MutexUnify> ulock(mtx);
-			task->fres.finalResult(std::current_exception(), ulock);
-			task->end_of_life = true;
+			current->task->fres.finalResult(std::current_exception(), ulock);
+			current->task->end_of_life = true;
+			ulock.unlock();
+			notifyTaskGroup(*current->task);
+			delete current;
+			delete this;
 			return;
 		}
-		MutexUnify mtx(task->no_race);
+		MutexUnify mtx(current->task->no_race);
 		art::unique_lock<MutexUnify> ulock(mtx);
-		task->fres.finalResult(result, ulock);
-		task->end_of_life = true;
+		current->task->fres.finalResult(result, ulock);
+		current->task->end_of_life = true;
+		ulock.unlock();
+		notifyTaskGroup(*current->task);
+		delete current;
 		delete this;
 	}
 
-	bool start(){
-		if(started)
-			return false;
-		return started = NativeWorkersSingleton::post_work(this);
+	//job queued under same lock as post, so worker that receives post always finds job
+	typed_lgr<Task> start(){
+		typed_lgr<Task> task = job->task;
+		{
+			art::lock_guard guard(native_jobs.no_race);
+			if(!NativeWorkersSingleton::post_work(this)){
+				delete this;
+				throw AttachARuntimeException("Failed to start native task");
+			}
+			native_jobs.jobs.push(job, priority_aging_step());
+			job = nullptr;
+		}
+		return task;
 	}
 };
 
 typed_lgr<Task> Task::create_native_task(typed_lgr<class FuncEnvironment> func){
-	native_task_shedule* shedule = new native_task_shedule(func);
-	if(!shedule->start()){
-		delete shedule;
-		throw AttachARuntimeException("Failed to start native task");
-	}
-	return shedule->task;
+	return (new native_task_shedule(func))->start();
 }
-typed_lgr<Task> Task::create_native_task(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments){
-	native_task_shedule* shedule = new native_task_shedule(func, arguments);
-	if(!shedule->start()){
-		delete shedule;
-		throw AttachARuntimeException("Failed to start native task");
-	}
-	return shedule->task;
+typed_lgr<Task> Task::create_native_task(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments, TaskPriority priority, std::chrono::high_resolution_clock::time_point deadline){
+	return (new native_task_shedule(func, arguments, priority, deadline))->start();
 }
-typed_lgr<Task> Task::create_native_task(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments){
-	native_task_shedule* shedule = new native_task_shedule(func, std::move(arguments));
-	if(!shedule->start()){
-		delete shedule;
-		throw AttachARuntimeException("Failed to start native task");
-	}
-	return shedule->task;
+typed_lgr<Task> Task::create_native_task(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments, TaskPriority priority, std::chrono::high_resolution_clock::time_point deadline){
+	return (new native_task_shedule(func, std::move(arguments), priority, deadline))->start();
 }
-typed_lgr<Task> Task::create_native_task(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout){
-	native_task_shedule* shedule = new native_task_shedule(func, arguments, dummy_data, on_await, on_cancel, on_timeout, on_destruct, timeout);
-	if(!shedule->start()){
-		delete shedule;
-		throw AttachARuntimeException("Failed to start native task");
-	}
-	return shedule->task;
+typed_lgr<Task> Task::create_native_task(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout, TaskPriority priority, std::chrono::high_resolution_clock::time_point deadline){
+	return (new native_task_shedule(func, arguments, dummy_data, on_await, on_cancel, on_timeout, on_destruct, timeout, priority, deadline))->start();
 }
-typed_lgr<Task> Task::create_native_task(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout){
-	native_task_shedule* shedule = new native_task_shedule(func, std::move(arguments), dummy_data, on_await, on_cancel, on_timeout, on_destruct, timeout);
-	if(!shedule->start()){
-		delete shedule;
-		throw AttachARuntimeException("Failed to start native task");
-	}
-	return shedule->task;
+typed_lgr<Task> Task::create_native_task(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout, TaskPriority priority, std::chrono::high_resolution_clock::time_point deadline){
+	return (new native_task_shedule(func, std::move(arguments), dummy_data, on_await, on_cancel, on_timeout, on_destruct, timeout, priority, deadline))->start();
 }
 void Task::explicitStartTimer() {
 	startTimeController();
@@ -1561,8 +2140,9 @@ void Task::sleep_until(std::chrono::high_resolution_clock::time_point time_point
 }
 void Task::yield() {
 	if (loc.is_task_thread) {
+		markReady(*loc.curr_task);
 		art::lock_guard guard(glob.task_thread_safety);
-		glob.tasks.push(loc.curr_task);
+		glob.tasks.push(loc.curr_task, ::priority_aging_step());
 		swapCtxRelock(glob.task_thread_safety);
 	}
 	else
@@ -1588,7 +2168,7 @@ typed_lgr<Task> Task::callback_dummy(ValueItem& dummy_data, void(*on_start)(Valu
 		if(!glob.time_control_enabled)
 			startTimeController();
 		art::lock_guard guard(glob.task_timer_safety);
-		glob.timed_tasks.push_back(timing(timeout,tsk));
+		pushTimeWait(timeout, tsk, tsk->awake_check);
 	}
 	return tsk;
 }
@@ -1607,43 +2187,124 @@ typed_lgr<Task> Task::callback_dummy(ValueItem& dummy_data, void(*on_await)(Valu
 		if(!glob.time_control_enabled)
 			startTimeController();
 		art::lock_guard guard(glob.task_timer_safety);
-		glob.timed_tasks.push_back(timing(timeout,tsk));
+		pushTimeWait(timeout, tsk, tsk->awake_check);
 	}
 	return tsk;
 }
 
 #pragma endregion
 #pragma region TaskMutex
+Task* mutex_owner_self(bool task_owner) {
+	if (task_owner)
+		return loc.curr_task.getPtr();
+	return reinterpret_cast<Task*>((size_t)_thread_id() | native_thread_flag);
+}
+bool TaskMutex::try_own(Task* owner) {
+	Task* expected = nullptr;
+	//seq_cst pairs with waiters check in unlock
+	return current_task.load(std::memory_order_seq_cst) == nullptr
+		&& current_task.compare_exchange_strong(expected, owner, std::memory_order_acquire, std::memory_order_relaxed);
+}
+//spinning is useless when owner can only run on this thread after park
+bool TaskMutex::spin_own(Task* owner) {
+	if (loc.is_task_thread && glob.executors <= 1)
+		return false;
+	return spin.spin([this, owner]() { return try_own(owner); });
+}
+void TaskMutex::link_waiter(typed_lgr<Task>& task) {
+	task->mutex_wait_next = nullptr;
+	task->mutex_wait_prev = wait_tail;
+	task->mutex_waiting = true;
+	if (wait_tail)
+		wait_tail->mutex_wait_next = task;
+	else
+		wait_head = task;
+	wait_tail = task.getPtr();
+	waiters.fetch_add(1, std::memory_order_seq_cst);
+}
+void TaskMutex::unlink_waiter(typed_lgr<Task>& task) {
+	if (!task->mutex_waiting)
+		return;
+	typed_lgr<Task> next = std::move(task->mutex_wait_next);
+	Task* prev = task->mutex_wait_prev;
+	if (next)
+		next->mutex_wait_prev = prev;
+	else
+		wait_tail = prev;
+	if (prev)
+		prev->mutex_wait_next = std::move(next);
+	else
+		wait_head = std::move(next);
+	task->mutex_wait_next = nullptr;
+	task->mutex_wait_prev = nullptr;
+	task->mutex_waiting = false;
+	waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+typed_lgr<Task> TaskMutex::pop_waiter() {
+	typed_lgr<Task> task = wait_head;
+	unlink_waiter(task);
+	return task;
+}
 TaskMutex::~TaskMutex() {
-	art::lock_guard lg(no_race);
-	while (!resume_task.empty()) {
-		auto& tsk = resume_task.back();
-		Task::notify_cancel(tsk.task);
-		current_task = nullptr;
-		Task::await_task(tsk.task);
-		resume_task.pop_back();
+	list_array<typed_lgr<Task>> parked;
+	{
+		art::lock_guard lg(no_race);
+		while (wait_head)
+			parked.push_back(pop_waiter());
+		for (auto& tsk : parked) {
+			//native threads wait through not started bridge task, destroying mutex with them is caller bug
+			assert(tsk->started && "TaskMutex destroyed while threads waits it");
+			Task::notify_cancel(tsk);
+			art::lock_guard lg1(tsk->no_race);
+			//awaked set to stop timer wake, cancel flag raised before relock returns to waiter
+			if (!tsk->time_end_flag) {
+				tsk->awaked = true;
+				transfer_task(tsk);
+			}
+		}
 	}
+	//woken tasks throw cancellation after relock, wait until they leave mutex
+	for (auto& tsk : parked)
+		Task::await_task(tsk, false);
 }
 void TaskMutex::lock() {
 	if (loc.is_task_thread) {
+		Task* self = loc.curr_task.getPtr();
+		if (try_own(self) || spin_own(self))
+			return;
+		auto wait_start = metrics_now();
+		bool blocked = false;
 		loc.curr_task->awaked = false;
 		loc.curr_task->time_end_flag = false;
-
 		art::lock_guard lg(no_race);
-		while (current_task) {
-			resume_task.emplace_back(loc.curr_task, loc.curr_task->awake_check);
+		while (true) {
+			//linked before retry, so unlock that missed waiters counter can not leave us parked
+			link_waiter(loc.curr_task);
+			if (try_own(self)) {
+				unlink_waiter(loc.curr_task);
+				break;
+			}
 			swapCtxRelock(no_race);
+			blocked = true;
 		}
-		current_task = loc.curr_task.getPtr();
+		if (blocked)
+			metrics_record(local_metrics().mutex_wait, wait_start);
 	}
 	else {
+		Task* self = mutex_owner_self(false);
+		if (try_own(self) || spin_own(self))
+			return;
 		art::unique_lock ul(no_race);
-		typed_lgr<Task> task; 
-		while (current_task) {
+		while (true) {
 			art::condition_variable_any cd;
 			bool has_res = false;
-			task = Task::cxx_native_bridge(has_res, cd);
-			resume_task.emplace_back(task, task->awake_check);
+			typed_lgr<Task> task = Task::cxx_native_bridge(has_res, cd);
+			link_waiter(task);
+			if (try_own(self)) {
+				//bridge not started yet, safe to drop
+				unlink_waiter(task);
+				break;
+			}
 			while (!has_res)
 				cd.wait(ul);
 			task_not_ended:
@@ -1655,102 +2316,112 @@ void TaskMutex::lock() {
 			}
 			task->no_race.unlock();
 		}
-		current_task = reinterpret_cast<Task*>((size_t)_thread_id() | native_thread_flag);
 	}
 }
 bool TaskMutex::try_lock() {
-	if (!no_race.try_lock())
-		return false;
-	art::unique_lock ul(no_race, art::adopt_lock);
-
-	if (current_task)
-		return false;
-	else if(loc.is_task_thread || loc.context_in_swap)
-		current_task = loc.curr_task.getPtr();
-	else
-		current_task = reinterpret_cast<Task*>((size_t)_thread_id() | native_thread_flag);
-	return true;
+	return try_own(mutex_owner_self(loc.is_task_thread || loc.context_in_swap));
 }
 
 bool TaskMutex::try_lock_for(size_t milliseconds) {
 	return try_lock_until(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(milliseconds));
 }
 bool TaskMutex::try_lock_until(std::chrono::high_resolution_clock::time_point time_point) {
-	if (!no_race.try_lock_until(time_point))
-		return false;
-	art::unique_lock ul(no_race, art::adopt_lock);
-
 	if (loc.is_task_thread && !loc.context_in_swap) {
-		while (current_task) {
+		Task* self = loc.curr_task.getPtr();
+		if (try_own(self) || spin_own(self))
+			return true;
+		if (!no_race.try_lock_until(time_point))
+			return false;
+		art::unique_lock ul(no_race, art::adopt_lock);
+		auto wait_start = metrics_now();
+		bool blocked = false;
+		while (true) {
+			link_waiter(loc.curr_task);
+			if (try_own(self)) {
+				unlink_waiter(loc.curr_task);
+				if (blocked)
+					metrics_record(local_metrics().mutex_wait, wait_start);
+				return true;
+			}
 			art::lock_guard guard(loc.curr_task->no_race);
 			makeTimeWait(time_point);
-			resume_task.emplace_back(loc.curr_task, loc.curr_task->awake_check);
-			swapCtxRelock(loc.curr_task->no_race, no_race);
-			if (!loc.curr_task->awaked) 
+			//relocked in same order as taken, mutex lock first, like unlock does
+			swapCtxRelock(no_race, loc.curr_task->no_race);
+			blocked = true;
+			if (!loc.curr_task->awaked) {
+				//timed out, unlink if unlock not dropped us already
+				unlink_waiter(loc.curr_task);
+				metrics_record(local_metrics().mutex_wait, wait_start);
 				return false;
+			}
 		}
-		current_task = loc.curr_task.getPtr();
-		return true;
 	}
 	else {
-		bool has_res;
-		art::condition_variable_any cd;
-		while (current_task) {
-			has_res = false;
-			typed_lgr task = Task::cxx_native_bridge(has_res, cd);
-			resume_task.emplace_back(task, task->awake_check);
-			while (has_res)
-				cd.wait_until(ul, time_point);
-			if (!task->awaked)
-				return false;
+		Task* self = mutex_owner_self(loc.context_in_swap);
+		if (try_own(self) || spin_own(self))
+			return true;
+		if (!no_race.try_lock_until(time_point))
+			return false;
+		art::unique_lock ul(no_race, art::adopt_lock);
+		while (true) {
+			art::condition_variable_any cd;
+			bool has_res = false;
+			typed_lgr<Task> task = Task::cxx_native_bridge(has_res, cd);
+			link_waiter(task);
+			if (try_own(self)) {
+				unlink_waiter(task);
+				return true;
+			}
+			bool timed_out = false;
+			while (!has_res) {
+				if (timed_out)
+					cd.wait(ul);
+				else if (cd.wait_until(ul, time_point) == art::cv_status::timeout) {
+					timed_out = true;
+					if (!has_res && task->mutex_waiting) {
+						//bridge still linked and not started, safe to drop
+						unlink_waiter(task);
+						return false;
+					}
+				}
+			}
+			task_not_ended:
+			//prevent destruct cd, because it is used in task
+			task->no_race.lock();
+			if (!task->fres.end_of_life) {
+				task->no_race.unlock();
+				goto task_not_ended;
+			}
+			task->no_race.unlock();
+			if (std::chrono::high_resolution_clock::now() >= time_point)
+				return try_own(self);
 		}
-		if(!loc.context_in_swap)
-			current_task = reinterpret_cast<Task*>((size_t)_thread_id() | native_thread_flag);
-		else
-			current_task = loc.curr_task.getPtr();
-		return true;
 	}
 }
 void TaskMutex::unlock() {
-	art::lock_guard lg0(no_race);
-	if (loc.is_task_thread) {
-		if (current_task != loc.curr_task.getPtr())
-			throw InvalidOperation("Tried unlock non owned mutex");
-	}
-	else if (current_task != reinterpret_cast<Task*>((size_t)_thread_id() | native_thread_flag))
+	Task* expected = mutex_owner_self(loc.is_task_thread);
+	if (!current_task.compare_exchange_strong(expected, nullptr, std::memory_order_seq_cst))
 		throw InvalidOperation("Tried unlock non owned mutex");
-
-	current_task = nullptr;
-	if (resume_task.size()) {
-		typed_lgr<Task> it = resume_task.front().task;
-		uint16_t awake_check = resume_task.front().awake_check;
-		resume_task.pop_front();
+	if (!waiters.load(std::memory_order_seq_cst))
+		return;
+	art::lock_guard lg0(no_race);
+	//skip waiters woken by timeout, they unlink itself when resumed
+	while (wait_head) {
+		typed_lgr<Task> it = pop_waiter();
 		art::lock_guard lg1(it->no_race);
-		if(it->awake_check != awake_check)
-			return;
 		if (!it->time_end_flag) {
 			it->awaked = true;
 			transfer_task(it);
+			return;
 		}
 	}
 }
 
 bool TaskMutex::is_locked() {
-	if (try_lock()) {
-		unlock();
-		return false;
-	}
-	return true;
+	return current_task.load(std::memory_order_acquire) != nullptr;
 }
 bool TaskMutex::is_own(){
-	art::lock_guard lg0(no_race);
-	if (loc.is_task_thread) {
-		if (current_task != loc.curr_task.getPtr())
-			return false;
-	}
-	else if (current_task != reinterpret_cast<Task*>((size_t)_thread_id() | native_thread_flag))
-		return false;
-	return true;
+	return current_task.load(std::memory_order_acquire) == mutex_owner_self(loc.is_task_thread);
 }
 
 ValueItem* _TaskMutex_lock_holder(ValueItem* args, uint32_t len){
@@ -1938,6 +2609,280 @@ bool TaskRecursiveMutex::is_own() {
 }
 #pragma endregion
 
+#pragma region TaskSharedMutex
+//state word: readers count in low bits, writer owns, writer waits (blocks new readers) and somebody parked (release must take no_race)
+constexpr size_t shared_mutex_writer = size_t(1) << (sizeof(size_t) * 8 - 1);
+constexpr size_t shared_mutex_writer_waits = size_t(1) << (sizeof(size_t) * 8 - 2);
+constexpr size_t shared_mutex_parked = size_t(1) << (sizeof(size_t) * 8 - 3);
+constexpr size_t shared_mutex_readers = shared_mutex_parked - 1;
+
+TaskSharedMutex::~TaskSharedMutex() {
+	list_array<typed_lgr<Task>> parked;
+	{
+		art::lock_guard lg(no_race);
+		//native threads can not be cancelled, destroying mutex with them is caller bug
+		assert(!native_waiters && "TaskSharedMutex destroyed while threads waits it");
+		for (auto& it : writers)
+			parked.push_back(it.task);
+		for (auto& it : readers)
+			parked.push_back(it.task);
+		writers.clear();
+		readers.clear();
+		for (auto& tsk : parked) {
+			Task::notify_cancel(tsk);
+			art::lock_guard lg1(tsk->no_race);
+			//awaked set to stop timer wake, cancel flag raised before relock returns to waiter
+			if (!tsk->time_end_flag) {
+				tsk->awaked = true;
+				transfer_task(tsk);
+			}
+		}
+	}
+	//woken tasks throw cancellation after relock, wait until they leave mutex
+	for (auto& tsk : parked)
+		Task::await_task(tsk, false);
+}
+bool TaskSharedMutex::try_own_shared() {
+	size_t current = state.load(std::memory_order_relaxed);
+	while (!(current & (shared_mutex_writer | shared_mutex_writer_waits))) {
+		if (state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+			return true;
+	}
+	return false;
+}
+bool TaskSharedMutex::try_own() {
+	size_t current = state.load(std::memory_order_relaxed);
+	while (!(current & (shared_mutex_writer | shared_mutex_readers))) {
+		if (state.compare_exchange_weak(current, current | shared_mutex_writer, std::memory_order_acquire, std::memory_order_relaxed)) {
+			writer_owner = mutex_owner_self(loc.is_task_thread);
+			return true;
+		}
+	}
+	return false;
+}
+//caller holds no_race
+void TaskSharedMutex::update_flags() {
+	size_t flags = 0;
+	if (waiting_writers)
+		flags |= shared_mutex_writer_waits;
+	if (!readers.empty() || !writers.empty() || native_waiters)
+		flags |= shared_mutex_parked;
+	size_t current = state.load(std::memory_order_relaxed);
+	while (!state.compare_exchange_weak(current, (current & ~(shared_mutex_writer_waits | shared_mutex_parked)) | flags, std::memory_order_acq_rel, std::memory_order_relaxed));
+}
+//caller holds no_race, ownership handed to woken tasks, native threads retry by self
+void TaskSharedMutex::release_parked() {
+	while (!writers.empty()) {
+		size_t current = state.load(std::memory_order_relaxed);
+		if (current & (shared_mutex_writer | shared_mutex_readers))
+			break;
+		typed_lgr<Task> task = writers.front().task;
+		art::lock_guard lg(task->no_race);
+		if (task->time_end_flag) {
+			writers.pop_front();
+			continue;
+		}
+		if (!state.compare_exchange_strong(current, current | shared_mutex_writer, std::memory_order_acquire, std::memory_order_relaxed))
+			continue;
+		writers.pop_front();
+		writer_owner = task.getPtr();
+		task->awaked = true;
+		transfer_task(task);
+		break;
+	}
+	if (waiting_writers) {
+		if (native_waiters)
+			native_notify.notify_all();
+		update_flags();
+		return;
+	}
+	//no writers, all parked readers woken in one pass
+	while (!readers.empty()) {
+		size_t current = state.load(std::memory_order_relaxed);
+		if (current & shared_mutex_writer)
+			break;
+		typed_lgr<Task> task = readers.front().task;
+		art::lock_guard lg(task->no_race);
+		if (task->time_end_flag) {
+			readers.pop_front();
+			continue;
+		}
+		if (!state.compare_exchange_strong(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+			continue;
+		readers.pop_front();
+		task->awaked = true;
+		transfer_task(task);
+	}
+	if (native_waiters)
+		native_notify.notify_all();
+	update_flags();
+}
+bool TaskSharedMutex::lock_slow(std::chrono::high_resolution_clock::time_point time_point) {
+	bool timed = time_point != std::chrono::high_resolution_clock::time_point::max();
+	art::unique_lock ul(no_race);
+	waiting_writers++;
+	update_flags();
+	while (true) {
+		if (try_own())
+			break;
+		if (loc.is_task_thread && !loc.context_in_swap) {
+			art::lock_guard guard(loc.curr_task->no_race);
+			writers.emplace_back(loc.curr_task, loc.curr_task->awake_check);
+			update_flags();
+			//lock could be released before parked flag set
+			if (try_own()) {
+				writers.pop_back();
+				break;
+			}
+			if (timed)
+				makeTimeWait(time_point);
+			else {
+				loc.curr_task->awaked = false;
+				loc.curr_task->time_end_flag = false;
+			}
+			swapCtxRelock(loc.curr_task->no_race, no_race);
+			if (loc.curr_task->awaked)
+				break;
+			writers.remove_if([](const __::resume_task& it) { return it.task.getPtr() == loc.curr_task.getPtr(); });
+			waiting_writers--;
+			release_parked();
+			return false;
+		}
+		else {
+			native_waiters++;
+			update_flags();
+			if (try_own()) {
+				native_waiters--;
+				break;
+			}
+			bool timeout = false;
+			if (timed)
+				timeout = native_notify.wait_until(ul, time_point) == art::cv_status::timeout;
+			else
+				native_notify.wait(ul);
+			native_waiters--;
+			if (timeout && !try_own()) {
+				waiting_writers--;
+				release_parked();
+				return false;
+			}
+			else if (timeout)
+				break;
+		}
+	}
+	waiting_writers--;
+	update_flags();
+	return true;
+}
+bool TaskSharedMutex::lock_shared_slow(std::chrono::high_resolution_clock::time_point time_point) {
+	bool timed = time_point != std::chrono::high_resolution_clock::time_point::max();
+	art::unique_lock ul(no_race);
+	while (true) {
+		if (try_own_shared())
+			return true;
+		if (loc.is_task_thread && !loc.context_in_swap) {
+			art::lock_guard guard(loc.curr_task->no_race);
+			readers.emplace_back(loc.curr_task, loc.curr_task->awake_check);
+			update_flags();
+			if (try_own_shared()) {
+				readers.pop_back();
+				update_flags();
+				return true;
+			}
+			if (timed)
+				makeTimeWait(time_point);
+			else {
+				loc.curr_task->awaked = false;
+				loc.curr_task->time_end_flag = false;
+			}
+			swapCtxRelock(loc.curr_task->no_race, no_race);
+			if (loc.curr_task->awaked)
+				return true;
+			readers.remove_if([](const __::resume_task& it) { return it.task.getPtr() == loc.curr_task.getPtr(); });
+			update_flags();
+			return false;
+		}
+		else {
+			native_waiters++;
+			update_flags();
+			bool timeout = false;
+			if (!try_own_shared()) {
+				if (timed)
+					timeout = native_notify.wait_until(ul, time_point) == art::cv_status::timeout;
+				else
+					native_notify.wait(ul);
+			}
+			else {
+				native_waiters--;
+				update_flags();
+				return true;
+			}
+			native_waiters--;
+			update_flags();
+			if (timeout)
+				return try_own_shared();
+		}
+	}
+}
+
+void TaskSharedMutex::lock() {
+	if (!try_own())
+		lock_slow(std::chrono::high_resolution_clock::time_point::max());
+}
+bool TaskSharedMutex::try_lock() {
+	return try_own();
+}
+bool TaskSharedMutex::try_lock_for(size_t milliseconds) {
+	return try_lock_until(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(milliseconds));
+}
+bool TaskSharedMutex::try_lock_until(std::chrono::high_resolution_clock::time_point time_point) {
+	return try_own() || lock_slow(time_point);
+}
+void TaskSharedMutex::unlock() {
+	if (!(state.load(std::memory_order_relaxed) & shared_mutex_writer) || writer_owner != mutex_owner_self(loc.is_task_thread))
+		throw InvalidOperation("Tried unlock non owned mutex");
+	writer_owner = nullptr;
+	if (state.fetch_and(~shared_mutex_writer, std::memory_order_release) & shared_mutex_parked) {
+		art::lock_guard lg(no_race);
+		release_parked();
+	}
+}
+void TaskSharedMutex::lock_shared() {
+	if (!try_own_shared())
+		lock_shared_slow(std::chrono::high_resolution_clock::time_point::max());
+}
+bool TaskSharedMutex::try_lock_shared() {
+	return try_own_shared();
+}
+bool TaskSharedMutex::try_lock_shared_for(size_t milliseconds) {
+	return try_lock_shared_until(std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(milliseconds));
+}
+bool TaskSharedMutex::try_lock_shared_until(std::chrono::high_resolution_clock::time_point time_point) {
+	return try_own_shared() || lock_shared_slow(time_point);
+}
+void TaskSharedMutex::unlock_shared() {
+	size_t current = state.load(std::memory_order_relaxed);
+	do {
+		if (!(current & shared_mutex_readers))
+			throw InvalidOperation("Tried unlock_shared not shared locked mutex");
+	} while (!state.compare_exchange_weak(current, current - 1, std::memory_order_release, std::memory_order_relaxed));
+	//last reader lets parked writer in
+	if ((current & shared_mutex_readers) == 1 && (current & shared_mutex_parked)) {
+		art::lock_guard lg(no_race);
+		release_parked();
+	}
+}
+bool TaskSharedMutex::is_locked() {
+	return state.load(std::memory_order_acquire) & shared_mutex_writer;
+}
+bool TaskSharedMutex::is_locked_shared() {
+	return state.load(std::memory_order_acquire) & shared_mutex_readers;
+}
+bool TaskSharedMutex::is_own() {
+	return is_locked() && writer_owner == mutex_owner_self(loc.is_task_thread);
+}
+#pragma endregion
+
 #pragma region TaskConditionVariable
 TaskConditionVariable::TaskConditionVariable() {}
 
@@ -1947,6 +2892,7 @@ TaskConditionVariable::~TaskConditionVariable() {
 
 void TaskConditionVariable::wait(art::unique_lock<MutexUnify>& mut) {
 	if (loc.is_task_thread) {
+		auto wait_start = metrics_now();
 		if (mut.mutex()->nmut == &no_race) {
 			resume_task.emplace_back(loc.curr_task, loc.curr_task->awake_check);
 			swapCtxRelock(no_race);
@@ -1956,6 +2902,7 @@ void TaskConditionVariable::wait(art::unique_lock<MutexUnify>& mut) {
 			resume_task.emplace_back(loc.curr_task, loc.curr_task->awake_check);
 			swapCtxRelock(*mut.mutex(),no_race);
 		}
+		metrics_record(local_metrics().condition_wait, wait_start);
 	}
 	else {
 		art::condition_variable_any cd;
@@ -1991,14 +2938,26 @@ bool TaskConditionVariable::wait_for(art::unique_lock<MutexUnify>& mut, size_t m
 
 bool TaskConditionVariable::wait_until(art::unique_lock<MutexUnify>& mut, std::chrono::high_resolution_clock::time_point time_point) {
 	if (loc.is_task_thread) {
-		art::lock_guard guard(loc.curr_task->no_race);
-		makeTimeWait(time_point);
+		auto now = std::chrono::high_resolution_clock::now();
+		//already expired, nothing to wait and no sample to record
+		if (time_point <= now)
+			return false;
+		auto wait_start = Task::enable_metrics ? now : std::chrono::high_resolution_clock::time_point::min();
+		bool timed_out;
 		{
-			art::lock_guard guard(no_race);
-			resume_task.emplace_back(loc.curr_task, loc.curr_task->awake_check);
+			art::lock_guard guard(loc.curr_task->no_race);
+			makeTimeWait(time_point);
+			{
+				art::lock_guard guard(no_race);
+				resume_task.emplace_back(loc.curr_task, loc.curr_task->awake_check);
+			}
+			//caller mutex released after registration and relocked before task mutex, like in wait
+			//relock done inside of swap, so caller lock stays owned when swap throws TaskCancellation
+			swapCtxRelock(*mut.mutex(), loc.curr_task->no_race);
+			timed_out = loc.curr_task->time_end_flag;
 		}
-		swapCtxRelock(loc.curr_task->no_race);
-		if (loc.curr_task->time_end_flag)
+		metrics_record(local_metrics().condition_wait, wait_start);
+		if (timed_out)
 			return false;
 	}
 	else {
@@ -2041,19 +3000,20 @@ void TaskConditionVariable::notify_all() {
 		if (revive_tasks.empty())
 			return;
 	}
+	//task lock taken before global one, transfer_task locks global queue itself
+	for (auto& resumer : revive_tasks) {
+		auto& it = resumer.task;
+		art::lock_guard guard_loc(it->no_race);
+		if(it->awake_check != resumer.awake_check)
+			continue;
+		if (!it->time_end_flag) {
+			it->awaked = true;
+			transfer_task(it);
+		}
+	}
 	bool to_yield = false;
 	{
 		art::lock_guard guard(glob.task_thread_safety);
-		for (auto& resumer : revive_tasks) {
-			auto& it = resumer.task;
-			art::lock_guard guard_loc(it->no_race);
-			if(resumer.awake_check != resumer.awake_check)
-				continue;
-			if (!it->time_end_flag) {
-				it->awaked = true;
-				transfer_task(it);
-			}
-		}
 		glob.tasks_notifier.notify_one();
 		if (Task::max_running_tasks && loc.is_task_thread) {
 			if (Task::max_running_tasks <= glob.in_run_tasks && loc.curr_task && !loc.curr_task->end_of_life)
@@ -2069,7 +3029,7 @@ void TaskConditionVariable::notify_one() {
 		art::lock_guard guard(no_race);
 		while (resume_task.size()) {
 			resume_task.back().task->no_race.lock();
-			if (resume_task.back().task->time_end_flag || resume_task.back().awake_check != resume_task.back().awake_check) {
+			if (resume_task.back().task->time_end_flag || resume_task.back().task->awake_check != resume_task.back().awake_check) {
 				resume_task.back().task->no_race.unlock();
 				resume_task.pop_back();
 			}
@@ -2079,7 +3039,7 @@ void TaskConditionVariable::notify_one() {
 				break;
 			}
 		}
-		if (resume_task.empty())
+		if (!tsk)
 			return;
 	}
 	bool to_yield = false;
@@ -2243,7 +3203,6 @@ void TaskSemaphore::release_all() {
 	art::lock_guard lg0(no_race);
 	if (allow_treeshold == max_treeshold)
 		return;
-	art::lock_guard lg1(glob.task_thread_safety);
 	allow_treeshold = max_treeshold;
 	native_notify.notify_all();
 	while (resume_task.size()) {
@@ -2507,8 +3466,8 @@ void EventSystem::join(const typed_lgr<FuncEnvironment>& func, bool async_mode,
 	art::lock_guard guard(no_race);
 	if (async_mode) {
 		switch (priorithy) {
-		case Priorithy::heigh:
-			async_heigh_priorihty.push_back(func);
+		case Priorithy::high:
+			async_high_priorihty.push_back(func);
 			break;
 		case Priorithy::upper_avg:
 			async_upper_avg_priorihty.push_back(func);
@@ -2528,8 +3487,8 @@ void EventSystem::join(const typed_lgr<FuncEnvironment>& func, bool async_mode,
 	}
 	else {
 		switch (priorithy) {
-		case Priorithy::heigh:
-			heigh_priorihty.push_back(func);
+		case Priorithy::high:
+			high_priorihty.push_back(func);
 			break;
 		case Priorithy::upper_avg:
 			upper_avg_priorihty.push_back(func);
@@ -2552,8 +3511,8 @@ bool EventSystem::leave(const typed_lgr<FuncEnvironment>& func, bool async_mode,
 	art::lock_guard guard(no_race);
 	if (async_mode) {
 		switch (priorithy) {
-		case Priorithy::heigh:
-			return removeOne(async_heigh_priorihty, func);
+		case Priorithy::high:
+			return removeOne(async_high_priorihty, func);
 		case Priorithy::upper_avg:
 			return removeOne(async_upper_avg_priorihty, func);
 		case Priorithy::avg:
@@ -2568,8 +3527,8 @@ bool EventSystem::leave(const typed_lgr<FuncEnvironment>& func, bool async_mode,
 	}
 	else {
 		switch (priorithy) {
-		case Priorithy::heigh:
-			return removeOne(heigh_priorihty, func);
+		case Priorithy::high:
+			return removeOne(high_priorihty, func);
 		case Priorithy::upper_avg:
 			return removeOne(upper_avg_priorihty, func);
 		case Priorithy::avg:
@@ -2585,13 +3544,13 @@ bool EventSystem::leave(const typed_lgr<FuncEnvironment>& func, bool async_mode,
 }
 
 bool EventSystem::await_notify(ValueItem& it) {
-	if(sync_call(heigh_priorihty, it)	) return true;
+	if(sync_call(high_priorihty, it)	) return true;
 	if(sync_call(upper_avg_priorihty, it)) return true;
 	if(sync_call(avg_priorihty, it)		) return true;
 	if(sync_call(lower_avg_priorihty, it)) return true;
 	if(sync_call(low_priorihty, it)		) return true;
 
-	if(awaitCall(async_heigh_priorihty, it)		) return true;
+	if(awaitCall(async_high_priorihty, it)		) return true;
 	if(awaitCall(async_upper_avg_priorihty, it)	) return true;
 	if(awaitCall(async_avg_priorihty, it)		) return true;
 	if(awaitCall(async_lower_avg_priorihty, it)	) return true;
@@ -2599,13 +3558,13 @@ bool EventSystem::await_notify(ValueItem& it) {
 	return false;
 }
 bool EventSystem::notify(ValueItem& it) {
-	if (sync_call(heigh_priorihty, it)) return true;
+	if (sync_call(high_priorihty, it)) return true;
 	if (sync_call(upper_avg_priorihty, it)) return true;
 	if (sync_call(avg_priorihty, it)) return true;
 	if (sync_call(lower_avg_priorihty, it)) return true;
 	if (sync_call(low_priorihty, it)) return true;
 
-	async_call(async_heigh_priorihty, it);
+	async_call(async_high_priorihty, it);
 	async_call(async_upper_avg_priorihty, it);
 	async_call(async_avg_priorihty, it);
 	async_call(async_lower_avg_priorihty, it);
@@ -2613,12 +3572,12 @@ bool EventSystem::notify(ValueItem& it) {
 	return false;
 }
 bool EventSystem::sync_notify(ValueItem& it) {
-	if(sync_call(heigh_priorihty, it)	) return true;
+	if(sync_call(high_priorihty, it)	) return true;
 	if(sync_call(upper_avg_priorihty, it)) return true;
 	if(sync_call(avg_priorihty, it)		) return true;
 	if(sync_call(lower_avg_priorihty, it)) return true;
 	if(sync_call(low_priorihty, it)		) return true;
-	if(sync_call(async_heigh_priorihty, it)		) return true;
+	if(sync_call(async_high_priorihty, it)		) return true;
 	if(sync_call(async_upper_avg_priorihty, it)	) return true;
 	if(sync_call(async_avg_priorihty, it)		) return true;
 	if(sync_call(async_lower_avg_priorihty, it)	) return true;
@@ -2629,12 +3588,12 @@ bool EventSystem::sync_notify(ValueItem& it) {
 ValueItem* __async_notify(ValueItem* vals, uint32_t) {
 	EventSystem* es = (EventSystem*)vals->val;
 	ValueItem& args = vals[1];
-	if (es->sync_call(es->heigh_priorihty, args)) return new ValueItem(true);
+	if (es->sync_call(es->high_priorihty, args)) return new ValueItem(true);
 	if (es->sync_call(es->upper_avg_priorihty, args)) return new ValueItem(true);
 	if (es->sync_call(es->avg_priorihty, args)) return new ValueItem(true);
 	if (es->sync_call(es->lower_avg_priorihty, args)) return new ValueItem(true);
 	if (es->sync_call(es->low_priorihty, args)) return new ValueItem(true);
-	if (es->awaitCall(es->async_heigh_priorihty, args)) return new ValueItem(true);
+	if (es->awaitCall(es->async_high_priorihty, args)) return new ValueItem(true);
 	if (es->awaitCall(es->async_upper_avg_priorihty, args)) return new ValueItem(true);
 	if (es->awaitCall(es->async_avg_priorihty, args)) return new ValueItem(true);
 	if (es->awaitCall(es->async_lower_avg_priorihty, args)) return new ValueItem(true);
@@ -2645,7 +3604,7 @@ typed_lgr<FuncEnvironment> _async_notify(new FuncEnvironment(__async_notify,fals
 
 typed_lgr<Task> EventSystem::async_notify(ValueItem& args) {
 	ValueItem vals{ ValueItem(this,VType::undefined_ptr), args };
-	typed_lgr<Task> res = new Task(_async_notify, vals);
+	typed_lgr<Task> res = make_lgr<Task>(_async_notify, vals);
 	Task::start(res);
 	return res;
 }
@@ -2674,12 +3633,13 @@ void __TaskQuery_add_task_leave(TaskQueryHandle* tqh, TaskQuery* tq){
 	}
 	else if(!tq->tasks.empty() && tq->is_running){
 		tq->handle->now_at_execution--;
-		while (tq->handle->now_at_execution <= tq->handle->at_execution_max) {
+		list_array<typed_lgr<Task>> awake_tasks;
+		while (tq->handle->now_at_execution <= tq->handle->at_execution_max && !tq->tasks.empty()) {
 			tq->handle->now_at_execution++;
-			auto awake_task = tq->tasks.front();
+			awake_tasks.push_back(std::move(tq->tasks.front()));
 			tq->tasks.pop_front();
-			Task::start(awake_task);
 		}
+		Task::start(awake_tasks);
 	}
 	else {
 		tq->handle->now_at_execution--;
@@ -2706,14 +3666,16 @@ ValueItem* __TaskQuery_add_task(ValueItem* args, uint32_t len){
 	return res;
 }
 typed_lgr<FuncEnvironment> _TaskQuery_add_task(new FuncEnvironment(__TaskQuery_add_task,false, false));
-typed_lgr<Task> TaskQuery::add_task(typed_lgr<class FuncEnvironment> call_func, ValueItem& arguments, bool used_task_local, typed_lgr<class FuncEnvironment> exception_handler, std::chrono::high_resolution_clock::time_point timeout) {
+typed_lgr<Task> makeTaskQueryTask(TaskQueryHandle* handle, typed_lgr<class FuncEnvironment>& call_func, ValueItem& arguments, bool used_task_local, typed_lgr<class FuncEnvironment>& exception_handler, std::chrono::high_resolution_clock::time_point timeout) {
 	ValueItem copy;
 	if (arguments.meta.vtype == VType::faarr || arguments.meta.vtype == VType::saarr)
 		copy = ValueItem((ValueItem*)arguments.getSourcePtr(), arguments.meta.val_len);
 	else
 		copy = ValueItem({ arguments });
-
-	typed_lgr<Task> res = new Task(_TaskQuery_add_task, ValueItem{(void*)handle, new typed_lgr<class FuncEnvironment>(call_func), copy }, used_task_local, exception_handler, timeout);
+	return make_lgr<Task>(_TaskQuery_add_task, ValueItem{(void*)handle, new typed_lgr<class FuncEnvironment>(call_func), copy }, used_task_local, exception_handler, timeout);
+}
+typed_lgr<Task> TaskQuery::add_task(typed_lgr<class FuncEnvironment> call_func, ValueItem& arguments, bool used_task_local, typed_lgr<class FuncEnvironment> exception_handler, std::chrono::high_resolution_clock::time_point timeout) {
+	typed_lgr<Task> res = makeTaskQueryTask(handle, call_func, arguments, used_task_local, exception_handler, timeout);
 	art::lock_guard lock(handle->no_race);
 	if(is_running && handle->now_at_execution <= handle->at_execution_max){
 		Task::start(res);
@@ -2723,15 +3685,33 @@ typed_lgr<Task> TaskQuery::add_task(typed_lgr<class FuncEnvironment> call_func,
 
 	return res;
 }
+list_array<typed_lgr<Task>> TaskQuery::add_task(typed_lgr<class FuncEnvironment> call_func, list_array<ValueItem>& arguments, bool used_task_local, typed_lgr<class FuncEnvironment> exception_handler, std::chrono::high_resolution_clock::time_point timeout) {
+	list_array<typed_lgr<Task>> res;
+	res.reserve_push_back(arguments.size());
+	for (auto& it : arguments)
+		res.push_back(makeTaskQueryTask(handle, call_func, it, used_task_local, exception_handler, timeout));
+	list_array<typed_lgr<Task>> to_start;
+	art::lock_guard lock(handle->no_race);
+	for (auto& it : res) {
+		if(is_running && handle->now_at_execution <= handle->at_execution_max){
+			to_start.push_back(it);
+			handle->now_at_execution++;
+		}
+		else tasks.push_back(it);
+	}
+	Task::start(to_start);
+	return res;
+}
 void TaskQuery::enable(){
 	art::lock_guard lock(handle->no_race);
 	is_running = true;
+	list_array<typed_lgr<Task>> awake_tasks;
 	while(handle->now_at_execution < handle->at_execution_max && !tasks.empty()){
-		auto awake_task = tasks.front();
+		awake_tasks.push_back(std::move(tasks.front()));
 		tasks.pop_front();
-		Task::start(awake_task);
 		handle->now_at_execution++;
 	}
+	Task::start(awake_tasks);
 }
 void TaskQuery::disable(){
 	art::lock_guard lock(handle->no_race);
@@ -2779,6 +3759,204 @@ TaskQuery::~TaskQuery(){
 }
 #pragma endregion
 
+#pragma region TaskGroup
+//called by worker when task ended, any result or exception
+void notifyTaskGroup(Task& task) {
+	TaskGroup* group;
+	{
+		art::lock_guard guard(task.no_race);
+		group = task.group;
+		task.group = nullptr;
+	}
+	if (group)
+		group->child_finished(task);
+}
+TaskGroup::TaskGroup(bool cancel_on_failure) : cancel_on_failure(cancel_on_failure) {}
+TaskGroup::~TaskGroup() {
+	cancel();
+	wait_all();
+}
+void TaskGroup::child_finished(Task& task) {
+	bool failed;
+	bool was_cancelled;
+	{
+		art::lock_guard task_guard(task.no_race);
+		was_cancelled = task.was_cancelled;
+		failed = !was_cancelled && !task.fres.results.empty() && task.fres.results.back().meta.vtype == VType::except_value;
+	}
+	art::lock_guard guard(no_race);
+	bool notify = !first_done;
+	if (!first_done)
+		first_done = &task;
+	//cancelled child has no result, so it is neither success nor failure
+	if (failed) {
+		if (!first_failure) {
+			first_failure = &task;
+			if (cancel_on_failure)
+				cancel_pending();
+		}
+	}
+	else if (!was_cancelled && !first_success) {
+		first_success = &task;
+		notify = true;
+	}
+	//decremented under no_race, waiters check counter under it, so group outlives this call
+	if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1 || notify)
+		notifier.notify_all();
+}
+//caller holds no_race
+void TaskGroup::cancel_pending() {
+	cancelled = true;
+	for (auto& task : tasks) {
+		if (!task->fres.end_of_life)
+			Task::notify_cancel(task);
+	}
+}
+//caller holds no_race
+typed_lgr<Task> TaskGroup::find(Task* task) {
+	for (auto& it : tasks) {
+		if (it.getPtr() == task)
+			return it;
+	}
+	return nullptr;
+}
+void TaskGroup::add(typed_lgr<Task> task) {
+	if (task->_task_local == (ValueEnvironment*)-1)
+		throw InvalidArguments("Callback tasks can not be added to TaskGroup");
+	bool finished;
+	{
+		art::lock_guard guard(no_race);
+		{
+			art::lock_guard task_guard(task->no_race);
+			if (task->group)
+				throw InvalidOperation("Task already belongs to group");
+			finished = task->fres.end_of_life;
+			if (!finished)
+				task->group = this;
+		}
+		pending.fetch_add(1, std::memory_order_relaxed);
+		if (cancelled && !finished)
+			Task::notify_cancel(task);
+		tasks.push_back(task);
+	}
+	//already ended task accounted immediately, so first_result and has_failure see it
+	if (finished)
+		child_finished(*task);
+}
+void TaskGroup::add(list_array<typed_lgr<Task>>& tasks) {
+	for (auto& task : tasks)
+		add(task);
+}
+void TaskGroup::start() {
+	list_array<typed_lgr<Task>> to_start;
+	{
+		art::lock_guard guard(no_race);
+		to_start = tasks;
+	}
+	Task::start(to_start);
+}
+void TaskGroup::wait_all() {
+	//no_race taken even when nothing pending, last child_finished may still hold it
+	if (pending.load(std::memory_order_acquire))
+		start();
+	MutexUnify unify(no_race);
+	art::unique_lock lock(unify);
+	while (pending.load(std::memory_order_acquire))
+		notifier.wait(lock);
+}
+bool TaskGroup::wait_all_until(std::chrono::high_resolution_clock::time_point time_point) {
+	if (pending.load(std::memory_order_acquire))
+		start();
+	MutexUnify unify(no_race);
+	art::unique_lock lock(unify);
+	while (pending.load(std::memory_order_acquire)) {
+		if (!notifier.wait_until(lock, time_point) && pending.load(std::memory_order_acquire)) {
+			cancel_pending();
+			return false;
+		}
+	}
+	return true;
+}
+typed_lgr<Task> TaskGroup::wait_any() {
+	start();
+	MutexUnify unify(no_race);
+	art::unique_lock lock(unify);
+	while (!first_done && pending.load(std::memory_order_acquire))
+		notifier.wait(lock);
+	return find(first_done);
+}
+typed_lgr<Task> TaskGroup::wait_any_until(std::chrono::high_resolution_clock::time_point time_point) {
+	start();
+	MutexUnify unify(no_race);
+	art::unique_lock lock(unify);
+	while (!first_done && pending.load(std::memory_order_acquire)) {
+		if (!notifier.wait_until(lock, time_point) && !first_done) {
+			cancel_pending();
+			return nullptr;
+		}
+	}
+	return find(first_done);
+}
+ValueItem TaskGroup::first_result() {
+	start();
+	typed_lgr<Task> res;
+	{
+		MutexUnify unify(no_race);
+		art::unique_lock lock(unify);
+		while (!first_success && pending.load(std::memory_order_acquire))
+			notifier.wait(lock);
+		if (!first_success) {
+			if (!first_failure)
+				return ValueItem();
+			res = find(first_failure);
+		}
+		else {
+			res = find(first_success);
+			cancel_pending();
+		}
+	}
+	art::lock_guard guard(res->no_race);
+	return res->fres.results.empty() ? ValueItem() : res->fres.results.back();
+}
+void TaskGroup::cancel() {
+	art::lock_guard guard(no_race);
+	cancel_pending();
+}
+void TaskGroup::clear() {
+	art::lock_guard guard(no_race);
+	if (pending.load(std::memory_order_acquire))
+		throw InvalidOperation("TaskGroup has pending children");
+	tasks.clear();
+	first_done = nullptr;
+	first_success = nullptr;
+	first_failure = nullptr;
+}
+list_array<ValueItem> TaskGroup::results() {
+	wait_all();
+	list_array<ValueItem> res;
+	art::lock_guard guard(no_race);
+	for (auto& task : tasks) {
+		art::lock_guard task_guard(task->no_race);
+		res.push_back(task->fres.results);
+	}
+	return res;
+}
+list_array<typed_lgr<Task>>& TaskGroup::children() {
+	return tasks;
+}
+size_t TaskGroup::size() {
+	art::lock_guard guard(no_race);
+	return tasks.size();
+}
+size_t TaskGroup::pending_count() {
+	return pending.load(std::memory_order_acquire);
+}
+bool TaskGroup::has_failure() {
+	art::lock_guard guard(no_race);
+	return first_failure;
+}
+#pragma endregion
+
 
 #pragma region Generator
 
@@ -2860,6 +4038,8 @@ TaskQuery::~TaskQuery(){
 	}
 
 	bool Generator::yield_iterate(typed_lgr<Generator>& generator){
+		//generator resumed by any thread, not only by workers
+		light_stack::prepare_thread();
 		if(generator->context == nullptr) {
 			*reinterpret_cast<ctx::continuation*>(&generator->context) = ctx::callcc(std::allocator_arg, light_stack(1048576/*1 mb*/), generator_execute);
 			if(generator->ex_ptr)
@@ -2879,6 +4059,7 @@ TaskQuery::~TaskQuery(){
 			return generator->results.take_front();
 		if(generator->end_of_life)
 			return nullptr;
+		light_stack::prepare_thread();
 		if(generator->context == nullptr) {
 			loc.on_load_generator_ref = generator;
 			*reinterpret_cast<ctx::continuation*>(&generator->context) = ctx::callcc(std::allocator_arg, light_stack(1048576/*1 mb*/), generator_execute);
@@ -2990,6 +4171,8 @@ namespace _Task_unsafe{
 		std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
 		while(true){
 			uint64_t all_sleep_count_avg;
+			glob.stuck_workers = countStuckWorkers();
+			compensateBlockedWorkers();
 			auto [sleep_count_avg, workers_diff] = _become_executor_count_manager_(lock, last_time, glob.workers_completions, glob.executor_manager_hill_climb);
 			all_sleep_count_avg = sleep_count_avg;
 			if(workers_diff == 0);
@@ -3000,7 +4183,7 @@ namespace _Task_unsafe{
 			else {
 				typed_lgr task = new Task(nullptr, nullptr);
 				for(uint32_t i = 0; i < workers_diff; i++)
-					glob.tasks.push(task);
+					glob.tasks.push(task, priority_aging_step());
 			}
 			lock.unlock();
 			{
@@ -3020,7 +4203,7 @@ namespace _Task_unsafe{
 						typed_lgr task = new Task(nullptr, nullptr);
 						task->bind_to_worker_id = contexts.first;
 						for(uint32_t i = 0; i < workers_diff; i++)
-							contexts.second.tasks.push_back(task);
+							contexts.second.tasks.push(task, priority_aging_step());
 					}
 				}
 				all_sleep_count_avg /= glob.binded_workers.size() + 1;
@@ -3032,9 +4215,12 @@ namespace _Task_unsafe{
 			lock.lock();
 
 			if(leave_after_finish)
-				if(!(glob.tasks.size() || glob.cold_tasks.size() || glob.timed_tasks.size() || glob.in_exec  || glob.tasks_in_swap))
+				if(!(glob.tasks.size() || glob.tasks_in_local_queues || glob.cold_tasks.size() || glob.timed_tasks.size() || glob.in_exec  || glob.tasks_in_swap))
 					break;
 		}
+		glob.stuck_workers = 0;
+		compensateBlockedWorkers();
+		glob.executor_manager_in_work = false;
 	}
 	void start_executor_count_manager(){
 		art::lock_guard lock(glob.task_thread_safety);
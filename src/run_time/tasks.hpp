@@ -13,6 +13,8 @@
 #include "attacha_abi_structs.hpp"
 #include <chrono>
 #include "util/enum_helper.hpp"
+#include "tasks_util/object_pool.hpp"
+#include "tasks_util/spin_wait.hpp"
 #pragma push_macro("min")
 #undef min
 namespace __{
@@ -35,13 +37,21 @@ public:
 
 
 
-#pragma pack (push)
-#pragma pack (1)
+//owner word changed by atomic exchange, no_race taken only by contended lock and by unlock with waiters
+//waiters linked through Task::mutex_wait_next, so parking does not allocate
 class TaskMutex {
 	friend class TaskRecursiveMutex;
-	std::list<__::resume_task> resume_task;
+	std::atomic<struct Task*> current_task = nullptr;
+	std::atomic_size_t waiters = 0;
+	run_time::tasks::util::adaptive_spin<> spin;
+	typed_lgr<struct Task> wait_head;
+	struct Task* wait_tail = nullptr;
 	art::timed_mutex no_race;
-	struct Task* current_task = nullptr;
+	bool try_own(struct Task* owner);
+	bool spin_own(struct Task* owner);
+	void link_waiter(typed_lgr<struct Task>& task);
+	void unlink_waiter(typed_lgr<struct Task>& task);
+	typed_lgr<struct Task> pop_waiter();
 public:
 	TaskMutex() {}
 	~TaskMutex();
@@ -75,6 +85,42 @@ public:
 	void sequence_lock(typed_lgr<struct Task> task);
 	bool is_own();
 };
+//readers and writer acquire by atomic update of state word, no_race taken only to park or to wake parked
+//writer preference: waiting writer blocks new readers, released lock goes to writer first, then to all parked readers at once
+class TaskSharedMutex {
+	std::atomic_size_t state = 0;//readers count and flags, see tasks.cpp
+	std::list<__::resume_task> readers;
+	std::list<__::resume_task> writers;
+	art::mutex no_race;
+	art::condition_variable_any native_notify;
+	struct Task* writer_owner = nullptr;
+	size_t waiting_writers = 0;
+	size_t native_waiters = 0;
+	bool try_own_shared();
+	bool try_own();
+	void release_parked();
+	void update_flags();
+	bool lock_slow(std::chrono::high_resolution_clock::time_point time_point);
+	bool lock_shared_slow(std::chrono::high_resolution_clock::time_point time_point);
+public:
+	TaskSharedMutex() {}
+	~TaskSharedMutex();
+	void lock();
+	bool try_lock();
+	bool try_lock_for(size_t milliseconds);
+	bool try_lock_until(std::chrono::high_resolution_clock::time_point time_point);
+	void unlock();
+	void lock_shared();
+	bool try_lock_shared();
+	bool try_lock_shared_for(size_t milliseconds);
+	bool try_lock_shared_until(std::chrono::high_resolution_clock::time_point time_point);
+	void unlock_shared();
+	bool is_locked();
+	bool is_locked_shared();
+	bool is_own();
+};
+#pragma pack (push)
+#pragma pack (1)
 
 ENUM_t(MutexUnifyType, uint8_t,
 	(noting)
@@ -83,6 +129,8 @@ ENUM_t(MutexUnifyType, uint8_t,
 	(nrec)
 	(umut)
 	(mmut)
+	(rwmut)
+	(rwmut_shared)
 );
 struct MutexUnify {
 	union {
@@ -91,6 +139,7 @@ struct MutexUnify {
 		art::recursive_mutex* nrec;
 		TaskMutex* umut;
 		struct MultiplyMutex* mmut;
+		TaskSharedMutex* rwmut;
 	};
 	MutexUnify();
 	MutexUnify(const MutexUnify& mut);
@@ -98,6 +147,8 @@ struct MutexUnify {
 	MutexUnify(art::timed_mutex& smut);
 	MutexUnify(art::recursive_mutex& smut);
 	MutexUnify(TaskMutex& smut);
+	//shared mode locks TaskSharedMutex as reader
+	MutexUnify(TaskSharedMutex& smut, bool shared = false);
 	MutexUnify(struct MultiplyMutex& mmut);
 	MutexUnify(nullptr_t);
 
@@ -107,6 +158,7 @@ struct MutexUnify {
 	MutexUnify& operator=(art::timed_mutex& smut);
 	MutexUnify& operator=(art::recursive_mutex& smut);
 	MutexUnify& operator=(TaskMutex& smut);
+	MutexUnify& operator=(TaskSharedMutex& smut);
 	MutexUnify& operator=(struct MultiplyMutex& mmut);
 	MutexUnify& operator=(nullptr_t);
 
@@ -167,10 +219,24 @@ struct TaskResult {
 	TaskResult(TaskResult&& move) noexcept;
 	~TaskResult();
 };
+//lower value served first, see configuration::tasks::priority_aging_step for anti starvation
+enum class TaskPriority : uint8_t {
+	high,
+	upper_avg,
+	avg,
+	lower_avg,
+	low
+};
 struct Task {
 	static size_t max_running_tasks;
 	static size_t max_planned_tasks;
 	static bool enable_task_naming;
+	static bool enable_work_stealing;//tasks started or awaken from worker pushed to its local queue
+	static size_t priority_aging_step;//milliseconds, waiting task gains one priority level per step, 0 disables aging
+	static bool pin_workers;//workers created after change pinned to processors, see configuration::tasks::numa
+	static bool enable_task_affinity;//resumed task queued to worker that executed it last time
+	static size_t blocking_stuck_threshold;//milliseconds, see configuration::tasks::blocking
+	static bool enable_metrics;//latency histograms, clock not read while disabled
 
 	TaskResult fres;
 	typed_lgr<class FuncEnvironment> ex_handle;//if ex_handle is nullptr then exception will be stored in fres
@@ -183,8 +249,16 @@ struct Task {
 	MutexUnify relock_2;
 	class ValueEnvironment* _task_local = nullptr;
 	std::chrono::high_resolution_clock::time_point timeout = std::chrono::high_resolution_clock::time_point::min();
+	//when pushed to ready queue, for metrics, written by waker and read by worker, natural alignment keeps it lock free
+	alignas(sizeof(std::chrono::high_resolution_clock::time_point)) std::atomic<std::chrono::high_resolution_clock::time_point> ready_since = std::chrono::high_resolution_clock::time_point::min();
+	std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::min();//if set, task ordered by earliest deadline inside own priority
 	uint16_t awake_check = 0;
 	uint16_t bind_to_worker_id = -1;//-1 - not binded
+	uint32_t last_worker = 0;//id of worker local queue that executed task last time, 0 - none
+	class TaskGroup* group = nullptr;//notified when task ends, guarded by no_race
+	typed_lgr<Task> mutex_wait_next;//TaskMutex wait list link, guarded by no_race of waited mutex
+	Task* mutex_wait_prev = nullptr;
+	TaskPriority priority = TaskPriority::avg;
 	bool time_end_flag : 1 = false;
 	bool awaked : 1 = false;
 	bool started : 1 = false;
@@ -192,17 +266,33 @@ struct Task {
 	bool end_of_life : 1 = false;
 	bool make_cancel : 1 = false;
 	bool auto_bind_worker : 1 = false;//can be binded to regular worker
+	bool mutex_waiting : 1 = false;//linked in TaskMutex wait list
+	bool was_cancelled : 1 = false;//ended by cancellation, has no final result
 	Task(typed_lgr<class FuncEnvironment> call_func, const ValueItem& arguments, bool used_task_local = false, typed_lgr<class FuncEnvironment> exception_handler = nullptr, std::chrono::high_resolution_clock::time_point timeout = std::chrono::high_resolution_clock::time_point::min());
 	Task(typed_lgr<class FuncEnvironment> call_func, ValueItem&& arguments, bool used_task_local = false, typed_lgr<class FuncEnvironment> exception_handler = nullptr, std::chrono::high_resolution_clock::time_point timeout = std::chrono::high_resolution_clock::time_point::min());
 	Task(Task&& mov) noexcept;
 	~Task();
+	//tasks allocated from per thread pool, see configuration::tasks::task_pool
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+	//used by make_lgr, task and its counters share one pooled block
+	static void* allocate_lgr_block(size_t size);
+	static void free_lgr_block(void* ptr);
+	static run_time::tasks::util::object_pool_stats allocation_stats();
+	//scheduler counters and latency histograms, map with "global", "totals" and "workers" entries
+	static ValueItem metrics();
 	void auto_bind_worker_enable(bool enable = true);
 	void set_worker_id(uint16_t id);//disables auto_bind_worker and manualy bind task to worker
+	//applied when task queued next time, tasks with non avg priority or deadline bypass worker local queues
+	void set_priority(TaskPriority priority);
+	void set_deadline(std::chrono::high_resolution_clock::time_point deadline);
 
 
 
 	static void start(typed_lgr<Task>&& lgr_task);
+	//batch queued under one lock and wakes at most batch size idle workers
 	static void start(list_array<typed_lgr<Task>>& lgr_task);
+	static void start(typed_lgr<Task>* lgr_task, size_t len);
 	static void start(const typed_lgr<Task>& lgr_task);
 	
 	//if count zero then threads count will be dynamicaly calculated
@@ -238,6 +328,10 @@ struct Task {
 	static void check_cancelation();
 	static void self_cancel();
 	static bool is_task();
+	//marks native blocking call of current task, regular worker gets compensating worker while queued tasks wait
+	//task must not suspend inside region, regions can be nested
+	static void enter_blocking_region();
+	static void leave_blocking_region();
 
 
 	//clean unused memory, used for debug pruproses, ie memory leak
@@ -258,14 +352,23 @@ struct Task {
 	static typed_lgr<Task> fullifed_task(ValueItem&& result);
 
 	static typed_lgr<Task> create_native_task(typed_lgr<class FuncEnvironment> func);
-	static typed_lgr<Task> create_native_task(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments);
-	static typed_lgr<Task> create_native_task(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments);
-	static typed_lgr<Task> create_native_task(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout = std::chrono::high_resolution_clock::time_point::min());
-	static typed_lgr<Task> create_native_task(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout = std::chrono::high_resolution_clock::time_point::min());
+	//native tasks picked by priority and deadline from shared queue when native worker becomes free
+	static typed_lgr<Task> create_native_task(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments, TaskPriority priority = TaskPriority::avg, std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::min());
+	static typed_lgr<Task> create_native_task(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments, TaskPriority priority = TaskPriority::avg, std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::min());
+	static typed_lgr<Task> create_native_task(typed_lgr<class FuncEnvironment> func, const ValueItem& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout = std::chrono::high_resolution_clock::time_point::min(), TaskPriority priority = TaskPriority::avg, std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::min());
+	static typed_lgr<Task> create_native_task(typed_lgr<class FuncEnvironment> func, ValueItem&& arguments, ValueItem& dummy_data, void(*on_await)(ValueItem&), void(*on_cancel)(ValueItem&), void(*on_timeout)(ValueItem&), void(*on_destruct)(ValueItem&), std::chrono::high_resolution_clock::time_point timeout = std::chrono::high_resolution_clock::time_point::min(), TaskPriority priority = TaskPriority::avg, std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::min());
 
 	static void explicitStartTimer();
 };
 #pragma pack (pop)
+struct TaskBlockingRegion {
+	TaskBlockingRegion() {
+		Task::enter_blocking_region();
+	}
+	~TaskBlockingRegion() {
+		Task::leave_blocking_region();
+	}
+};
 class TaskSemaphore {
 	std::list<__::resume_task> resume_task;
 	art::timed_mutex no_race;
@@ -286,13 +389,13 @@ public:
 class EventSystem {
 	friend ValueItem* __async_notify(ValueItem* vals, uint32_t);
 	TaskMutex no_race;
-	std::list<typed_lgr<class FuncEnvironment>> heigh_priorihty;
+	std::list<typed_lgr<class FuncEnvironment>> high_priorihty;
 	std::list<typed_lgr<class FuncEnvironment>> upper_avg_priorihty;
 	std::list<typed_lgr<class FuncEnvironment>> avg_priorihty;
 	std::list<typed_lgr<class FuncEnvironment>> lower_avg_priorihty;
 	std::list<typed_lgr<class FuncEnvironment>> low_priorihty;
 
-	std::list<typed_lgr<class FuncEnvironment>> async_heigh_priorihty;
+	std::list<typed_lgr<class FuncEnvironment>> async_high_priorihty;
 	std::list<typed_lgr<class FuncEnvironment>> async_upper_avg_priorihty;
 	std::list<typed_lgr<class FuncEnvironment>> async_avg_priorihty;
 	std::list<typed_lgr<class FuncEnvironment>> async_lower_avg_priorihty;
@@ -305,7 +408,7 @@ class EventSystem {
 	bool sync_call(std::list<typed_lgr<class FuncEnvironment>>& list, ValueItem& args);
 public:
 	enum class Priorithy {
-		heigh,
+		high,
 		upper_avg,
 		avg,
 		lower_avg,
@@ -370,6 +473,8 @@ public:
 	TaskQuery(size_t at_execution_max = 0);
 	~TaskQuery();
 	typed_lgr<Task> add_task(typed_lgr<class FuncEnvironment> call_func, ValueItem& arguments, bool used_task_local = false, typed_lgr<class FuncEnvironment> exception_handler = nullptr, std::chrono::high_resolution_clock::time_point timeout = std::chrono::high_resolution_clock::time_point::min());
+	//one task per arguments item, tasks allowed to run started as one batch
+	list_array<typed_lgr<Task>> add_task(typed_lgr<class FuncEnvironment> call_func, list_array<ValueItem>& arguments, bool used_task_local = false, typed_lgr<class FuncEnvironment> exception_handler = nullptr, std::chrono::high_resolution_clock::time_point timeout = std::chrono::high_resolution_clock::time_point::min());
 	void enable();
 	void disable();
 	bool in_query(typed_lgr<Task> task);
@@ -380,6 +485,52 @@ public:
 	bool wait_until(std::chrono::high_resolution_clock::time_point time_point);
 };
 
+//owns child tasks, children ends counted by one atomic, so waiters woken once instead of awaiting each TaskResult
+//first child failure (exception) or wait timeout cancels children that not finished yet
+//destructor cancels and awaits unfinished children, so children never outlive group
+class TaskGroup {
+	friend void notifyTaskGroup(struct Task& task);
+	list_array<typed_lgr<Task>> tasks;
+	TaskConditionVariable notifier;
+	art::mutex no_race;
+	std::atomic_size_t pending = 0;
+	Task* first_done = nullptr;
+	Task* first_success = nullptr;
+	Task* first_failure = nullptr;
+	bool cancel_on_failure;
+	bool cancelled = false;
+	void child_finished(Task& task);
+	void cancel_pending();
+	typed_lgr<Task> find(Task* task);
+public:
+	TaskGroup(bool cancel_on_failure = true);
+	~TaskGroup();
+	//callback tasks not supported, task can belong to one group
+	void add(typed_lgr<Task> task);
+	void add(list_array<typed_lgr<Task>>& tasks);
+	//starts not started children as one batch
+	void start();
+	void wait_all();
+	//false when timed out, not finished children cancelled
+	bool wait_all_until(std::chrono::high_resolution_clock::time_point time_point);
+	//first finished child, nullptr when group is empty
+	typed_lgr<Task> wait_any();
+	//nullptr when timed out, not finished children cancelled
+	typed_lgr<Task> wait_any_until(std::chrono::high_resolution_clock::time_point time_point);
+	//final result of first child finished without exception, other children cancelled
+	//if all children failed returns exception of first failed child
+	ValueItem first_result();
+	void cancel();
+	//forgets finished children, throws if some child still pending
+	void clear();
+	//waits all children, results in order of adding
+	list_array<ValueItem> results();
+	list_array<typed_lgr<Task>>& children();
+	size_t size();
+	size_t pending_count();
+	bool has_failure();
+};
+
 //task unsafe, TO-DO: compatible with task sync classes
 class Generator {
 	friend void prepare_generator(ValueItem& args,typed_lgr<FuncEnvironment>& func, typed_lgr<FuncEnvironment>& ex_handler, Generator*& weak_ref);
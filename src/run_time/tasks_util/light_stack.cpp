@@ -4,9 +4,18 @@
 // (See accompanying file LICENSE or copy at
 // http://www.boost.org/LICENSE_1_0.txt)
 
+#if defined(_WIN32) || defined(_WIN64)
 #include <Windows.h>
 #include <intrin.h>//_AddressOfReturnAddress
+#else
+#include <sys/mman.h>
+#include <pthread.h>
+#include <signal.h>
+#include <cstring>
+#include <mutex>
+#endif
 #include "light_stack.hpp"
+#include "numa.hpp"
 #include "../../run_time.hpp"
 #include "../library/console.hpp"
 #include "../library/exceptions.hpp"
@@ -17,38 +26,96 @@
 #include <vector>
 typedef boost::context::stack_context stack_context;
 
-boost::lockfree::queue<light_stack::stack_context> stack_allocations(configuration::tasks::light_stack::inital_buffer_size);
-std::atomic_size_t stack_allocations_buffer = configuration::tasks::light_stack::inital_buffer_size;
+struct stack_pool{
+    boost::lockfree::queue<light_stack::stack_context> stack_allocations{configuration::tasks::light_stack::inital_buffer_size};
+    std::atomic_size_t stack_allocations_buffer = 0;
+};
+constexpr size_t size_classes_count = std::size(configuration::tasks::light_stack::size_classes);
+constexpr size_t pool_nodes_count = configuration::tasks::numa::node_local_stacks ? configuration::tasks::numa::max_nodes : 1;
+//stack returned to pool of node where it allocated, so pools of one node does not fill with remote memory
+stack_pool stack_pools[pool_nodes_count][size_classes_count];
 bool light_stack::flush_used_stacks = configuration::tasks::light_stack::flush_used_stacks;
 size_t light_stack::max_buffer_size = configuration::tasks::light_stack::max_buffer_size;
+bool light_stack::learn_stack_size = configuration::tasks::light_stack::learn_stack_size;
+//committed at creation, needs at least 3 pages to fully construct the coroutine and switch to it
+constexpr size_t initial_commit_pages = 3;
 
+size_t stack_node(){
+    if constexpr (!configuration::tasks::numa::node_local_stacks)
+        return 0;
+    else
+        return run_time::tasks::numa::nodes_count() > 1 ? run_time::tasks::numa::current_node() : 0;
+}
+//nullptr for sizes without class
+stack_pool* pool_of(size_t size, size_t node){
+    size_t pool_node = node < pool_nodes_count ? node : pool_nodes_count - 1;
+    for(size_t i = 0; i < size_classes_count; i++)
+        if(configuration::tasks::light_stack::size_classes[i] == size)
+            return &stack_pools[pool_node][i];
+    return nullptr;
+}
 
 
 
-stack_context create_stack(size_t size){
+#if defined(_WIN32) || defined(_WIN64)
+//preferred node applied when pages committed, so reserve and first commits passes it explicitly
+void* stack_virtual_alloc(void* ptr, size_t size, DWORD type, DWORD protect, size_t node){
+    if(run_time::tasks::numa::nodes_count() > 1)
+        return ::VirtualAllocExNuma(GetCurrentProcess(), ptr, size, type, protect, (DWORD)node);
+    return ::VirtualAlloc(ptr, size, type, protect);
+}
+stack_context create_stack(size_t size, size_t node){
     // calculate how many pages are required
     const size_t guard_page_size = (size_t(fault_reserved_pages) + 1) * page_size;
 
-    void* vp = ::VirtualAlloc(0, size, MEM_RESERVE, PAGE_READWRITE);
+    void* vp = stack_virtual_alloc(0, size, MEM_RESERVE, PAGE_READWRITE, node);
     if (!vp) 
         throw AllocationException("VirtualAlloc failed");
 
-    // needs at least 3 pages to fully construct the coroutine and switch to it
-    const auto init_commit_size = page_size * 3;
+    const auto init_commit_size = page_size * initial_commit_pages;
     auto pPtr = static_cast<PBYTE>(vp) + size;
     pPtr -= init_commit_size;
-    if (!VirtualAlloc(pPtr, init_commit_size, MEM_COMMIT, PAGE_READWRITE)) 
+    if (!stack_virtual_alloc(pPtr, init_commit_size, MEM_COMMIT, PAGE_READWRITE, node)) 
         throw AllocationException("VirtualAlloc failed");
 
     // create guard page so the OS can catch page faults and grow our stack
     pPtr -= guard_page_size;
-    if (!VirtualAlloc(pPtr, guard_page_size, MEM_COMMIT, PAGE_READWRITE | PAGE_GUARD))
+    if (!stack_virtual_alloc(pPtr, guard_page_size, MEM_COMMIT, PAGE_READWRITE | PAGE_GUARD, node))
         throw AllocationException("VirtualAlloc failed");
     stack_context sctx;
     sctx.size = size;
     sctx.sp = static_cast<char*>(vp) + sctx.size;
     return sctx;
 }
+void release_stack(stack_context& sctx){
+    ::VirtualFree(static_cast<char*>(sctx.sp) - sctx.size, 0, MEM_RELEASE);
+}
+//pages committed deeper than keep decommitted and guard pages placed right below keep again,
+//stack used less than keep has guard pages or reserve below keep and not touched
+void trim_stack(stack_context& sctx, size_t keep, size_t node){
+    const size_t guard_page_size = (size_t(fault_reserved_pages) + 1) * page_size;
+    char* base = static_cast<char*>(sctx.sp) - sctx.size;
+    char* keep_end = static_cast<char*>(sctx.sp) - keep;
+    if(keep >= sctx.size || keep_end - guard_page_size <= base + page_size)
+        return;
+    MEMORY_BASIC_INFORMATION info;
+    if(!::VirtualQuery(keep_end - page_size, &info, sizeof(info)))
+        return;
+    if(info.State != MEM_COMMIT || (info.Protect & PAGE_GUARD))
+        return;
+    ::VirtualFree(base, keep_end - base, MEM_DECOMMIT);
+    stack_virtual_alloc(keep_end - guard_page_size, guard_page_size, MEM_COMMIT, PAGE_READWRITE | PAGE_GUARD, node);
+}
+//only committed part flushed, touching reserve would commit whole stack
+void flush_stack(stack_context& sctx){
+    char* top = static_cast<char*>(sctx.sp);
+    char* committed = top;
+    MEMORY_BASIC_INFORMATION info;
+    while(committed > top - sctx.size && ::VirtualQuery(committed - page_size, &info, sizeof(info)) && info.State == MEM_COMMIT && !(info.Protect & PAGE_GUARD))
+        committed = static_cast<char*>(info.BaseAddress);
+    memset(committed, 0xCC, top - committed);
+}
+void prepare_thread_stack(){}
 
 
 BOOST_NOINLINE PBYTE get_current_stack_pointer() {
@@ -88,6 +155,217 @@ bool set_lock_pages_priv( HANDLE hProcess, BOOL bEnable ) {
 }
 
 size_t large_page_size = GetLargePageMinimum();
+#else
+//linux not have PAGE_GUARD, so stack reserved as PROT_NONE and committed from top by SIGSEGV handler,
+//handler runs on alternate signal stack because faulting stack has no space for signal frame
+//guard pages at bottom never committed, fault in them is stack overflow and goes to previous handler
+//registry read by handler, so it is fixed array changed only by atomics, no locks and no allocations
+//stack may be created or released on task stack that faults meanwhile, handler must not wait for that thread
+struct stack_slot{
+    std::atomic_uint32_t version = 0;//odd while slot fields changed, reader retries or skips
+    std::atomic<char*> top = nullptr;//nullptr for free slot
+    std::atomic<char*> base = nullptr;//start of mapping, guard pages first
+    std::atomic<char*> committed = nullptr;//lowest read/write address, changed only by thread that owns stack now
+    std::atomic_flag used = ATOMIC_FLAG_INIT;
+};
+constexpr size_t stack_slots_count = configuration::tasks::light_stack::max_growable_stacks;
+constexpr uint32_t no_stack_slot = UINT32_MAX;
+//slot index stored above sctx.sp, so release, trim and flush find slot without search
+constexpr size_t stack_header_size = 64;
+stack_slot stack_slots[stack_slots_count];
+std::atomic_size_t stack_slots_high = 0;//slots from this index never used, bounds search
+//pages committed by one fault below faulting address
+constexpr size_t commit_step_pages = 4;
+struct sigaction previous_segv_action;
+
+size_t stack_guard_size(){
+    return (size_t(fault_reserved_pages) + 1) * page_size;
+}
+uint32_t& stack_slot_index(const stack_context& sctx){
+    return *reinterpret_cast<uint32_t*>(sctx.sp);
+}
+stack_slot* slot_of(const stack_context& sctx){
+    uint32_t index = stack_slot_index(sctx);
+    return index == no_stack_slot ? nullptr : &stack_slots[index];
+}
+uint32_t register_stack(char* top, char* base, char* committed){
+    for(size_t i = 0; i < stack_slots_count; i++){
+        stack_slot& slot = stack_slots[i];
+        if(slot.used.test(std::memory_order_relaxed) || slot.used.test_and_set(std::memory_order_acquire))
+            continue;
+        slot.version.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.base.store(base, std::memory_order_relaxed);
+        slot.committed.store(committed, std::memory_order_relaxed);
+        slot.top.store(top, std::memory_order_relaxed);
+        slot.version.fetch_add(1, std::memory_order_release);
+        size_t high = stack_slots_high.load(std::memory_order_relaxed);
+        while(high <= i && !stack_slots_high.compare_exchange_weak(high, i + 1, std::memory_order_release, std::memory_order_relaxed));
+        return (uint32_t)i;
+    }
+    return no_stack_slot;
+}
+void unregister_stack(stack_slot& slot){
+    slot.version.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.top.store(nullptr, std::memory_order_relaxed);
+    slot.base.store(nullptr, std::memory_order_relaxed);
+    slot.committed.store(nullptr, std::memory_order_relaxed);
+    slot.version.fetch_add(1, std::memory_order_release);
+    slot.used.clear(std::memory_order_release);
+}
+//slot of stack that contains address, nullptr if address not in task stack, async signal safe
+stack_slot* find_slot(char* address, char*& top, char*& base){
+    size_t high = stack_slots_high.load(std::memory_order_acquire);
+    for(size_t i = 0; i < high; i++){
+        stack_slot& slot = stack_slots[i];
+        uint32_t version = slot.version.load(std::memory_order_acquire);
+        if(version & 1)
+            continue;
+        top = slot.top.load(std::memory_order_relaxed);
+        base = slot.base.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.version.load(std::memory_order_relaxed) != version)
+            continue;
+        if(top && base <= address && address <= top)
+            return &slot;
+    }
+    return nullptr;
+}
+//commits pages from address up to already committed part, false if address not in reserved part of task stack
+bool commit_stack_to(char* address){
+    char* top;
+    char* base;
+    stack_slot* slot = find_slot(address, top, base);
+    if(!slot)
+        return false;
+    char* bottom = base + stack_guard_size();
+    char* committed = slot->committed.load(std::memory_order_relaxed);
+    if(address < bottom || address >= committed)
+        return false;
+    char* new_committed = (char*)((size_t)address & ~(page_size - 1));
+    new_committed = size_t(new_committed - bottom) > commit_step_pages * page_size ? new_committed - commit_step_pages * page_size : bottom;
+    if(::mprotect(new_committed, committed - new_committed, PROT_READ | PROT_WRITE))
+        return false;
+    slot->committed.store(new_committed, std::memory_order_relaxed);
+    return true;
+}
+void stack_fault_handler(int sig, siginfo_t* info, void* context){
+    if(commit_stack_to((char*)info->si_addr))
+        return;
+    if(previous_segv_action.sa_flags & SA_SIGINFO){
+        if(previous_segv_action.sa_sigaction){
+            previous_segv_action.sa_sigaction(sig, info, context);
+            return;
+        }
+    }
+    else if(previous_segv_action.sa_handler != SIG_DFL && previous_segv_action.sa_handler != SIG_IGN){
+        previous_segv_action.sa_handler(sig);
+        return;
+    }
+    //faulting instruction repeated with default action, process terminated as without handler
+    ::signal(sig, SIG_DFL);
+}
+void install_stack_fault_handler(){
+    static std::once_flag installed;
+    std::call_once(installed, [](){
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = stack_fault_handler;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        ::sigaction(SIGSEGV, &action, &previous_segv_action);
+    });
+}
+stack_context create_stack(size_t size, size_t node){
+    install_stack_fault_handler();
+    void* vp = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (vp == MAP_FAILED)
+        throw AllocationException("mmap failed");
+    char* base = static_cast<char*>(vp);
+    char* top = base + size - stack_header_size;
+    const size_t init_commit_size = std::min(initial_commit_pages * page_size, size - stack_guard_size());
+    char* committed = base + size - init_commit_size;
+    if (::mprotect(committed, init_commit_size, PROT_READ | PROT_WRITE)) {
+        ::munmap(vp, size);
+        throw AllocationException("mprotect failed");
+    }
+    //policy stays with mapping, so pages committed later and after trim_stack also come from this node
+    if (run_time::tasks::numa::nodes_count() > 1)
+        run_time::tasks::numa::bind_memory(vp, size, node);
+    stack_context sctx;
+    sctx.size = size - stack_header_size;
+    sctx.sp = top;
+    uint32_t index = register_stack(top, base, committed);
+    //no free slot, handler can not grow this stack, so it committed whole
+    if (index == no_stack_slot && ::mprotect(base + stack_guard_size(), committed - base - stack_guard_size(), PROT_READ | PROT_WRITE)) {
+        ::munmap(vp, size);
+        throw AllocationException("mprotect failed");
+    }
+    stack_slot_index(sctx) = index;
+    return sctx;
+}
+void release_stack(stack_context& sctx){
+    if (stack_slot* slot = slot_of(sctx))
+        unregister_stack(*slot);
+    ::munmap(static_cast<char*>(sctx.sp) - sctx.size, sctx.size + stack_header_size);
+}
+//pages committed deeper than keep returned to system and reserved again, stack used less than keep not touched
+void trim_stack(stack_context& sctx, size_t keep, size_t node){
+    stack_slot* slot = slot_of(sctx);
+    if(!slot)
+        return;
+    char* keep_end = static_cast<char*>(sctx.sp) - std::min(keep, sctx.size - stack_guard_size());
+    char* committed = slot->committed.load(std::memory_order_relaxed);
+    if(committed >= keep_end)
+        return;
+    ::madvise(committed, keep_end - committed, MADV_DONTNEED);
+    ::mprotect(committed, keep_end - committed, PROT_NONE);
+    slot->committed.store(keep_end, std::memory_order_relaxed);
+}
+//committed part of stack kept by trim_stack, so flush it whole
+void flush_stack(stack_context& sctx){
+    stack_slot* slot = slot_of(sctx);
+    char* committed = slot ? slot->committed.load(std::memory_order_relaxed) : static_cast<char*>(sctx.sp) - sctx.size + stack_guard_size();
+    memset(committed, 0xCC, static_cast<char*>(sctx.sp) - committed);
+}
+void prepare_thread_stack(){
+    //alternate stack lives until thread exit, stack growth handler runs on it
+    thread_local struct fault_stack{
+        void* memory = nullptr;
+        fault_stack(){
+            stack_t current;
+            if(!::sigaltstack(nullptr, &current) && !(current.ss_flags & SS_DISABLE))
+                return;
+            size_t size = std::max<size_t>(SIGSTKSZ, 65536);
+            memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+            if(memory == MAP_FAILED){
+                memory = nullptr;
+                return;
+            }
+            stack_t alt;
+            alt.ss_sp = memory;
+            alt.ss_size = size;
+            alt.ss_flags = 0;
+            if(::sigaltstack(&alt, nullptr)){
+                ::munmap(memory, size);
+                memory = nullptr;
+            }
+        }
+        ~fault_stack(){
+            if(!memory)
+                return;
+            stack_t alt;
+            alt.ss_sp = nullptr;
+            alt.ss_size = 0;
+            alt.ss_flags = SS_DISABLE;
+            ::sigaltstack(&alt, nullptr);
+            ::munmap(memory, std::max<size_t>(SIGSTKSZ, 65536));
+        }
+    } instance;
+    (void)instance;
+}
+#endif
 
 light_stack::light_stack(size_t size) BOOST_NOEXCEPT_OR_NOTHROW : size(size) {}
 
@@ -98,49 +376,79 @@ stack_context light_stack::allocate() {
     const size_t size__ = (pages + 1) * page_size;
 
     stack_context result;
-    if (stack_allocations.pop(result)) {
-        stack_allocations_buffer--;
+    node = stack_node();
+    stack_pool* pool = pool_of(size, node);
+    if (pool && pool->stack_allocations.pop(result)) {
+        pool->stack_allocations_buffer--;
+        //committed size of stack is usage mark, pages kept from previous task would inflate it
+        if(learn_stack_size)
+            trim_stack(result, initial_commit_pages * page_size, node);
         if(!flush_used_stacks)
             return result;
         else {
-            memset(static_cast<char*>(result.sp) - result.size, 0xCC, result.size);
+            flush_stack(result);
             return result;
         }
     }
     else
-        return create_stack(size__);
+        return create_stack(size__, node);
 }
 
-void unlimited_beffer(stack_context& sctx ){
-    if (!stack_allocations.push(sctx)) 
-        ::VirtualFree(static_cast<char*>(sctx.sp) - sctx.size, 0, MEM_RELEASE);
+//stack used deeper than keep size trimmed, others go to pool without system calls
+void unlimited_beffer(stack_pool& pool, stack_context& sctx, size_t node){
+    trim_stack(sctx, configuration::tasks::light_stack::recycle_keep_size, node);
+    if (!pool.stack_allocations.push(sctx)) 
+        release_stack(sctx);
     else
-        stack_allocations_buffer++;
+        pool.stack_allocations_buffer++;
 }
-void limited_beffer(stack_context& sctx ){
-   if (++stack_allocations_buffer < light_stack::max_buffer_size) {
-        if (!stack_allocations.push(sctx)) {
-            ::VirtualFree(static_cast<char*>(sctx.sp) - sctx.size, 0, MEM_RELEASE);
-            stack_allocations_buffer--;
+void limited_beffer(stack_pool& pool, stack_context& sctx, size_t node){
+   if (++pool.stack_allocations_buffer < light_stack::max_buffer_size) {
+        trim_stack(sctx, configuration::tasks::light_stack::recycle_keep_size, node);
+        if (!pool.stack_allocations.push(sctx)) {
+            release_stack(sctx);
+            pool.stack_allocations_buffer--;
         }
     }
     else {
-        ::VirtualFree(static_cast<char*>(sctx.sp) - sctx.size, 0, MEM_RELEASE);
-        stack_allocations_buffer--;
+        release_stack(sctx);
+        pool.stack_allocations_buffer--;
     }
 }
 
 void light_stack::deallocate(stack_context& sctx ) {
     assert(sctx.sp);
-    if(!max_buffer_size)
-        unlimited_beffer(sctx);
+    stack_pool* pool = pool_of(size, node);
+    if(!pool)
+        release_stack(sctx);
+    else if(!max_buffer_size)
+        unlimited_beffer(*pool, sctx, node);
     else if(max_buffer_size != SIZE_MAX)
-        limited_beffer(sctx);
+        limited_beffer(*pool, sctx, node);
     else
-        ::VirtualFree(static_cast<char*>(sctx.sp) - sctx.size, 0, MEM_RELEASE);
+        release_stack(sctx);
 }
 
+void light_stack::prepare_thread(){
+    prepare_thread_stack();
+}
+
+size_t light_stack::size_class(size_t bytes){
+    for(size_t class_size : configuration::tasks::light_stack::size_classes)
+        if(bytes <= class_size)
+            return class_size;
+    return bytes;
+}
+size_t light_stack::buffered_stacks(size_t size_class){
+    size_t res = 0;
+    for(auto& node_pools : stack_pools)
+        for(size_t i = 0; i < size_classes_count; i++)
+            if(!size_class || configuration::tasks::light_stack::size_classes[i] == size_class)
+                res += node_pools[i].stack_allocations_buffer;
+    return res;
+}
 
+#if defined(_WIN32) || defined(_WIN64)
 const char* fmt_state(DWORD state) {
     switch (state) {
     case MEM_COMMIT: return "COMMIT";
@@ -472,6 +780,9 @@ void light_stack::dump_out(void* ptr){
 size_t light_stack::allocated_size(){
     return get_stack_detail<stack_item::committed>(GetStackPointer()).length;
 }
+size_t light_stack::high_water_size(){
+    return allocated_size();
+}
 size_t light_stack::free_size(){
     return get_stack_detail<stack_item::reserved>(GetStackPointer()).length;
 }
@@ -486,4 +797,226 @@ size_t light_stack::unused_size(){
     return detail.length - size_t((detail.base + detail.length) - pPtr);
 }
 
-bool light_stack::is_supported(){return true;}
\ No newline at end of file
+bool light_stack::is_supported(){return true;}
+#else
+struct stack_bounds{
+    bool* bottom = nullptr;//lowest usable address, guard pages below
+    bool* top = nullptr;
+    size_t guard = 0;
+    bool valid = false;
+};
+struct allocation_details{
+    bool* base;
+    size_t length;
+    bool guard;
+    bool resident;
+};
+
+BOOST_NOINLINE bool* GetStackPointer() {
+    return (bool*)__builtin_frame_address(0) + sizeof(void*) * 2;
+}
+bool* page_down(bool* ptr){
+    return (bool*)((size_t)ptr & ~(page_size - 1));
+}
+bool* page_up(bool* ptr){
+    return (bool*)(((size_t)ptr + page_size - 1) & ~(page_size - 1));
+}
+
+//task stacks found in registry, otherwise stack of current thread
+stack_bounds find_stack(bool* ptr){
+    stack_bounds res;
+    char* top;
+    char* base;
+    if(find_slot((char*)ptr, top, base)){
+        res.guard = stack_guard_size();
+        res.top = (bool*)top;
+        res.bottom = (bool*)base + res.guard;
+        res.valid = true;
+        return res;
+    }
+    pthread_attr_t attr;
+    if(pthread_getattr_np(pthread_self(), &attr))
+        return res;
+    void* addr;
+    size_t size;
+    size_t guard_size = 0;
+    if(!pthread_attr_getstack(&attr, &addr, &size)){
+        pthread_attr_getguardsize(&attr, &guard_size);
+        if((bool*)addr <= ptr && ptr <= (bool*)addr + size){
+            res.bottom = (bool*)addr;
+            res.top = (bool*)addr + size;
+            res.guard = guard_size;
+            res.valid = true;
+        }
+    }
+    pthread_attr_destroy(&attr);
+    return res;
+}
+
+//guard region followed by runs of resident and not resident pages
+std::vector<allocation_details> stack_regions(const stack_bounds& bounds){
+    std::vector<allocation_details> res;
+    if(bounds.guard)
+        res.push_back({bounds.bottom - bounds.guard, bounds.guard, true, false});
+    size_t pages = (bounds.top - bounds.bottom) / page_size;
+    std::vector<unsigned char> residency(pages);
+    if(::mincore(bounds.bottom, pages * page_size, residency.data())){
+        //thread stack may be not mapped whole, show it as one region
+        res.push_back({bounds.bottom, pages * page_size, false, false});
+        return res;
+    }
+    for(size_t i = 0; i < pages; i++){
+        bool resident = residency[i] & 1;
+        if(res.size() && !res.back().guard && res.back().resident == resident)
+            res.back().length += page_size;
+        else
+            res.push_back({bounds.bottom + i * page_size, page_size, false, resident});
+    }
+    return res;
+}
+size_t resident_size(const stack_bounds& bounds){
+    size_t res = 0;
+    for(auto& region : stack_regions(bounds))
+        if(region.resident)
+            res += region.length;
+    return res;
+}
+const char* fmt_region(const allocation_details& region){
+    if(region.guard)
+        return "NOACCESS GUARD";
+    return region.resident ? "READWRITE COMMIT" : "READWRITE RESERVE";
+}
+
+std::string dump_stack(bool* pPtr) {
+    stack_bounds bounds = find_stack(pPtr);
+    if(!bounds.valid)
+        return "";
+    std::string res;
+    for(auto& region : stack_regions(bounds)){
+        res += "Range: " + string_help::hexstr((size_t)region.base);
+        res += " - " + string_help::hexstr((size_t)region.base + region.length);
+        res += " State: "; res += fmt_region(region);
+        res += " Pages: " + std::to_string(region.length / page_size);
+        res += "\n";
+    }
+    return res;
+}
+std::string dump_stack() {
+    return dump_stack(GetStackPointer());
+}
+
+bool light_stack::shrink_current(size_t bytes_treeshold){
+    bool* pPtr = GetStackPointer();
+    stack_bounds bounds = find_stack(pPtr);
+    if(!bounds.valid)
+        return false;
+    //at least one page left for madvise call frame
+    bool* end = page_down(pPtr - std::max(bytes_treeshold, page_size));
+    if(end <= bounds.bottom)
+        return false;
+    return !::madvise(bounds.bottom, end - bounds.bottom, MADV_DONTNEED);
+}
+
+//touch pages in range to avoid page faults later, writes same value so used part of stack not changed
+bool populate_stack(bool* begin, bool* end){
+    if(begin >= end)
+        return true;
+    //reserved part of task stack committed at once instead of fault per step
+    commit_stack_to((char*)begin);
+#ifdef MADV_POPULATE_WRITE
+    if(!::madvise(begin, end - begin, MADV_POPULATE_WRITE))
+        return true;
+#endif
+    for(volatile char* it = (char*)begin; it < (char*)end; it += page_size)
+        *it = *it;
+    return true;
+}
+
+bool light_stack::prepare(){
+    bool* pPtr = GetStackPointer();
+    stack_bounds bounds = find_stack(pPtr);
+    if(!bounds.valid)
+        return false;
+    return populate_stack(bounds.bottom, page_up(pPtr));
+}
+
+bool light_stack::prepare(size_t bytes_to_use){
+    bool* pPtr = GetStackPointer();
+    stack_bounds bounds = find_stack(pPtr);
+    if(!bounds.valid)
+        return false;
+    if(size_t(pPtr - bounds.bottom) < bytes_to_use)
+        return false;
+    return populate_stack(page_down(pPtr - bytes_to_use), page_up(pPtr));
+}
+
+
+ValueItem* light_stack::dump_current(){
+    return dump(GetStackPointer());
+}
+std::string light_stack::dump_current_str(){
+    return dump_stack();
+}
+void light_stack::dump_current_out(){
+    ValueItem item("####### Stack Dump Start #######\n" + dump_stack() + "####### Stack Dump End #######\n");
+    console::print(&item, 1);
+}
+
+ValueItem* light_stack::dump(void* ptr){
+    stack_bounds bounds = find_stack((bool*)ptr);
+    if(!bounds.valid)
+        return new ValueItem(false);
+    list_array<ValueItem> stack;
+    for(auto& a : stack_regions(bounds)){
+        list_array<ValueItem> item;
+        item.push_back(new ValueItem(a.base));
+        item.push_back(new ValueItem(a.base + a.length));
+        item.push_back(new ValueItem(a.length));
+        item.push_back(new ValueItem(std::string(fmt_region(a))));
+        item.push_back(new ValueItem(a.guard));
+        stack.push_back(new ValueItem(std::move(item)));
+    }
+    return new ValueItem(std::move(stack));
+}
+//default formated string
+std::string light_stack::dump_str(void* ptr){
+    return dump_stack((bool*)ptr);
+}
+//console
+void light_stack::dump_out(void* ptr){
+    ValueItem item("####### Stack Dump Start #######\n" + dump_stack((bool*)ptr) + "####### Stack Dump End #######\n");
+    console::print(&item, 1);
+}
+size_t light_stack::allocated_size(){
+    stack_bounds bounds = find_stack(GetStackPointer());
+    return bounds.valid ? resident_size(bounds) : 0;
+}
+size_t light_stack::high_water_size(){
+    char* pPtr = (char*)GetStackPointer();
+    char* top;
+    char* base;
+    if(stack_slot* slot = find_slot(pPtr, top, base))
+        return top - slot->committed.load(std::memory_order_relaxed);
+    return allocated_size();
+}
+size_t light_stack::free_size(){
+    stack_bounds bounds = find_stack(GetStackPointer());
+    return bounds.valid ? size_t(bounds.top - bounds.bottom) - resident_size(bounds) : 0;
+}
+size_t light_stack::used_size(){
+    bool* pPtr = GetStackPointer();
+    stack_bounds bounds = find_stack(pPtr);
+    return bounds.valid ? size_t(bounds.top - pPtr) : 0;
+}
+size_t light_stack::unused_size(){
+    bool* pPtr = GetStackPointer();
+    stack_bounds bounds = find_stack(pPtr);
+    if(!bounds.valid)
+        return 0;
+    size_t allocated = resident_size(bounds);
+    size_t used = bounds.top - pPtr;
+    return allocated > used ? allocated - used : 0;
+}
+
+bool light_stack::is_supported(){return true;}
+#endif
@@ -54,13 +54,26 @@ struct light_stack {
     static size_t unused_size();
     static size_t allocated_size();
     static size_t free_size();
+    //committed bytes of current stack, task stacks commit pages only while grow so it is deepest usage since stack trimmed
+    static size_t high_water_size();
 
 
     static bool is_supported();
+    //thread that switches to light stacks calls it once, on linux stack growth handled on alternate signal stack of thread
+    static void prepare_thread();
+
+    //smallest size class that fits bytes, bytes itself if no class fits, stacks without class not buffered
+    static size_t size_class(size_t bytes);
+    //total buffered stacks for size class, all classes if zero
+    static size_t buffered_stacks(size_t size_class = 0);
 
     //set in stack bytes from buffer to 0xCCCC, by default false
     static bool flush_used_stacks;
     static size_t max_buffer_size;
+    //tasks without stack hint use recorded stack usage of function, by default false
+    static bool learn_stack_size;
 private:
     std::size_t size;
+    //node of pool that gave stack, boost keeps allocator copy in context record and deallocates through it
+    std::size_t node = 0;
 };
\ No newline at end of file
@@ -162,7 +162,465 @@ public:
     }
 };
 
-#else // DEBUG
+#else
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+
+class NativeWorkerManager {
+public:
+    //for multishot operations check handle->cqe_flags & IORING_CQE_F_MORE, handle must be alive until last completion
+    virtual void handle(void* data, class NativeWorkerHandle* overlapped, unsigned long dwBytesTransferred, bool status) = 0;
+    virtual ~NativeWorkerManager() = default;
+};
+class NativeWorkerHandle {
+    friend class NativeWorkersSingleton;
+    NativeWorkerManager* manager;
+    void* data = nullptr;
+public:
+    //result of last completion, negative value is -errno
+    int32_t result = 0;
+    uint32_t cqe_flags = 0;
+    NativeWorkerHandle(NativeWorkerManager* manager) : manager(manager) {}
+    NativeWorkerHandle() = delete;
+    NativeWorkerHandle(const NativeWorkerHandle&) = delete;
+    NativeWorkerHandle(NativeWorkerHandle&&) = delete;
+    NativeWorkerHandle& operator=(const NativeWorkerHandle&) = delete;
+    NativeWorkerHandle& operator=(NativeWorkerHandle&&) = delete;
+};
+
+//not consume resources if not used
+//io_uring based, works without liburing, sqes collected and submitted in batches by flush or by dispatchers before wait
+//idle dispatchers sleep in io_uring_enter, so first deferred sqe wakes one of them by eventfd read armed in ring
+class NativeWorkersSingleton {
+    class CancelationNotify{};
+    class CancelationManager : public NativeWorkerManager{
+        public:
+        virtual void handle(void* data, class NativeWorkerHandle* overlapped, unsigned long dwBytesTransferred, bool status) override {
+            delete overlapped;
+            throw CancelationNotify();
+        }
+        CancelationManager() = default;
+        ~CancelationManager() = default;
+    };
+    class CancelationHandle : public NativeWorkerHandle{
+        public:
+        CancelationHandle(CancelationManager& ref) : NativeWorkerHandle(&ref) {}
+    };
+    //read of wake eventfd completed, rearmed with flush, so deferred sqes submitted by woken dispatcher
+    class WakeManager : public NativeWorkerManager{
+        public:
+        NativeWorkersSingleton* owner = nullptr;
+        virtual void handle(void* data, class NativeWorkerHandle* overlapped, unsigned long dwBytesTransferred, bool status) override {
+            owner->arm_wake();
+        }
+    };
+    static constexpr uint32_t ring_entries = 4096;
+    static constexpr uint32_t reap_batch = 64;
+public:
+    //registered once at ring setup, kernel skips page pinning for requests that use them
+    static constexpr uint32_t fixed_buffer_count = 32;
+    static constexpr uint32_t fixed_buffer_size = 64 * 1024;
+private:
+
+    static inline CancelationManager cancelation_manager_instance;
+    static inline NativeWorkersSingleton* instance = nullptr;
+    static inline art::mutex instance_mutex;
+    run_time::tasks::util::hill_climb hill_climb;
+    art::mutex hill_climb_mutex;
+    std::list<uint32_t> hill_climb_processed;
+
+    int ring_fd = -1;
+    void* sq_ptr = nullptr;
+    size_t sq_ptr_size = 0;
+    void* cq_ptr = nullptr;
+    size_t cq_ptr_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+
+    uint32_t* sq_head;
+    uint32_t* sq_tail;
+    uint32_t* sq_mask;
+    uint32_t* sq_array;
+    uint32_t sq_entries;
+    uint32_t* cq_head;
+    uint32_t* cq_tail;
+    uint32_t* cq_mask;
+    io_uring_cqe* cqes;
+
+    art::mutex sq_mutex;
+    art::mutex cq_mutex;
+    uint32_t sq_pending = 0;
+
+    char* fixed_buffers = nullptr;
+    uint16_t free_fixed[fixed_buffer_count];
+    uint32_t free_fixed_count = 0;
+    art::mutex fixed_mutex;
+
+    int wake_fd = -1;//-1 when eventfd not available, then deferred sqes submitted at once
+    uint64_t wake_value = 0;
+    WakeManager wake_manager;
+    NativeWorkerHandle wake_handle{&wake_manager};
+
+    static int io_uring_setup(uint32_t entries, io_uring_params* params){
+        return (int)syscall(__NR_io_uring_setup, entries, params);
+    }
+    static int io_uring_enter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags){
+        return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+    }
+    static int io_uring_register(int fd, uint32_t opcode, void* arg, uint32_t nr_args){
+        return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+    }
+    //fails with locked memory limit, then requests use own buffers
+    void register_fixed_buffers(){
+        void* memory = nullptr;
+        //page aligned, so buffers suitable for O_DIRECT
+        if(posix_memalign(&memory, 4096, (size_t)fixed_buffer_count * fixed_buffer_size))
+            return;
+        iovec vectors[fixed_buffer_count];
+        for(uint32_t i = 0; i < fixed_buffer_count; i++){
+            vectors[i].iov_base = (char*)memory + (size_t)i * fixed_buffer_size;
+            vectors[i].iov_len = fixed_buffer_size;
+        }
+        if(io_uring_register(ring_fd, IORING_REGISTER_BUFFERS, vectors, fixed_buffer_count) < 0){
+            free(memory);
+            return;
+        }
+        fixed_buffers = (char*)memory;
+        for(uint32_t i = 0; i < fixed_buffer_count; i++)
+            free_fixed[i] = (uint16_t)i;
+        free_fixed_count = fixed_buffer_count;
+    }
+
+    NativeWorkersSingleton(){
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ring_fd = io_uring_setup(ring_entries, &params);
+        if(ring_fd < 0)
+            throw std::runtime_error("io_uring_setup failed");
+        sq_ptr_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        cq_ptr_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if(single_mmap){
+            if(cq_ptr_size > sq_ptr_size)
+                sq_ptr_size = cq_ptr_size;
+            cq_ptr_size = sq_ptr_size;
+        }
+        sq_ptr = mmap(nullptr, sq_ptr_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if(sq_ptr == MAP_FAILED){
+            close(ring_fd);
+            throw std::runtime_error("io_uring sq ring mmap failed");
+        }
+        if(single_mmap)
+            cq_ptr = sq_ptr;
+        else{
+            cq_ptr = mmap(nullptr, cq_ptr_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+            if(cq_ptr == MAP_FAILED){
+                munmap(sq_ptr, sq_ptr_size);
+                close(ring_fd);
+                throw std::runtime_error("io_uring cq ring mmap failed");
+            }
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe*)mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        if(sqes == MAP_FAILED){
+            if(!single_mmap)
+                munmap(cq_ptr, cq_ptr_size);
+            munmap(sq_ptr, sq_ptr_size);
+            close(ring_fd);
+            throw std::runtime_error("io_uring sqes mmap failed");
+        }
+        sq_head = (uint32_t*)((char*)sq_ptr + params.sq_off.head);
+        sq_tail = (uint32_t*)((char*)sq_ptr + params.sq_off.tail);
+        sq_mask = (uint32_t*)((char*)sq_ptr + params.sq_off.ring_mask);
+        sq_array = (uint32_t*)((char*)sq_ptr + params.sq_off.array);
+        sq_entries = params.sq_entries;
+        cq_head = (uint32_t*)((char*)cq_ptr + params.cq_off.head);
+        cq_tail = (uint32_t*)((char*)cq_ptr + params.cq_off.tail);
+        cq_mask = (uint32_t*)((char*)cq_ptr + params.cq_off.ring_mask);
+        cqes = (io_uring_cqe*)((char*)cq_ptr + params.cq_off.cqes);
+        register_fixed_buffers();
+        wake_manager.owner = this;
+        wake_fd = eventfd(0, EFD_CLOEXEC);
+        if(wake_fd >= 0)
+            arm_wake();
+
+        for(ptrdiff_t i = art::thread::hardware_concurrency()/3 + 1; i > 0; i--)
+            art::thread(&NativeWorkersSingleton::dispatch, this).detach();
+    }
+
+    std::pair<uint32_t, uint32_t> proceed_hill_climb(double sample_seconds){
+        const uint32_t max_threads = art::thread::hardware_concurrency();
+        std::lock_guard<art::mutex> lock(hill_climb_mutex);
+        uint32_t recomended_thread_count = 0;
+        uint32_t recomended_sleep_count = 0;
+        if(hill_climb_processed.empty()){
+            art::thread(&NativeWorkersSingleton::dispatch, this).detach();
+            return { 100, 1 };
+        }
+        for(auto& item : hill_climb_processed){
+            auto [thread_count, sleep_count] = hill_climb.climb(hill_climb_processed.size(), sample_seconds, item, 1, max_threads);
+            recomended_thread_count += thread_count;
+            recomended_sleep_count += sleep_count;
+            item = 0;
+        }
+        recomended_thread_count /= hill_climb_processed.size();
+        recomended_sleep_count /= hill_climb_processed.size();
+
+        ptrdiff_t diff = recomended_thread_count - hill_climb_processed.size();
+        if(diff > 0){
+            for(ptrdiff_t i = diff; i > 0; i--)
+                art::thread(&NativeWorkersSingleton::dispatch, this).detach();
+        }else if(diff < 0){
+            for(ptrdiff_t i = diff; i < 0; i++)
+                post_work(new CancelationHandle(cancelation_manager_instance), 0);
+        }
+        return { recomended_thread_count, 1 };
+    }
+    void arm_wake(){
+        if(!_submit(&wake_handle, nullptr, prepare_read(wake_fd, &wake_value, sizeof(wake_value), (uint64_t)-1), true)){
+            ValueItem notify{ "io_uring wake read submit failed with error ", (uint32_t)errno };
+            errors.async_notify(notify);
+        }
+    }
+    uint32_t take_pending(){
+        std::lock_guard<art::mutex> lock(sq_mutex);
+        uint32_t res = sq_pending;
+        sq_pending = 0;
+        return res;
+    }
+    //moves completions from cq ring to local buffer, so other dispatchers can reap next ones
+    uint32_t reap(io_uring_cqe* buffer){
+        std::lock_guard<art::mutex> lock(cq_mutex);
+        uint32_t head = std::atomic_ref<uint32_t>(*cq_head).load(std::memory_order_relaxed);
+        uint32_t tail = std::atomic_ref<uint32_t>(*cq_tail).load(std::memory_order_acquire);
+        uint32_t count = 0;
+        while(head != tail && count < reap_batch)
+            buffer[count++] = cqes[head++ & *cq_mask];
+        std::atomic_ref<uint32_t>(*cq_head).store(head, std::memory_order_release);
+        return count;
+    }
+    void dispatch() {
+        if(enable_thread_naming)
+            _set_name_thread_dbg("NativeWorker Dispatch");
+        art::unique_lock<art::mutex> lock(hill_climb_mutex);
+        uint32_t& item = hill_climb_processed.emplace_back();
+        auto item_ptr = hill_climb_processed.begin();
+        lock.unlock();
+        io_uring_cqe buffer[reap_batch];
+        bool canceled = false;
+        while(!canceled){
+            uint32_t count = reap(buffer);
+            if(!count){
+                //submit collected sqes and wait in one syscall
+                uint32_t to_submit = take_pending();
+                if(io_uring_enter(ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS) < 0){
+                    if(errno != EINTR && errno != EAGAIN && errno != EBUSY){
+                        ValueItem notify{ "io_uring_enter failed with error ", (uint32_t)errno };
+                        errors.async_notify(notify);
+                    }
+                }
+                continue;
+            }
+            for(uint32_t i = 0; i < count; i++){
+                NativeWorkerHandle* handle = (NativeWorkerHandle*)buffer[i].user_data;
+                if(!handle){
+                    ValueItem notify{ "io_uring completion user_data is null" };
+                    errors.async_notify(notify);
+                    continue;
+                }
+                handle->result = buffer[i].res;
+                handle->cqe_flags = buffer[i].flags;
+                try{
+                    handle->manager->handle(handle->data, handle, buffer[i].res < 0 ? 0 : (unsigned long)buffer[i].res, buffer[i].res >= 0);
+                }catch(const CancelationNotify&){
+                    //completions already taken from ring must be handled
+                    canceled = true;
+                }
+                item++;
+            }
+        }
+        lock.lock();
+        hill_climb_processed.erase(item_ptr);
+    }
+    bool _submit(NativeWorkerHandle* handle, void* data, const io_uring_sqe& sqe, bool flush){
+        uint32_t to_submit = 0;
+        bool wake = false;
+        if(wake_fd < 0)
+            flush = true;
+        {
+            std::lock_guard<art::mutex> lock(sq_mutex);
+            uint32_t tail = *sq_tail;
+            if(tail - std::atomic_ref<uint32_t>(*sq_head).load(std::memory_order_acquire) >= sq_entries){
+                //ring full, kernel consumes sqes only on enter
+                if(io_uring_enter(ring_fd, sq_pending, 0, 0) < 0)
+                    return false;
+                sq_pending = 0;
+                if(tail - std::atomic_ref<uint32_t>(*sq_head).load(std::memory_order_acquire) >= sq_entries)
+                    return false;
+            }
+            handle->data = data;
+            uint32_t index = tail & *sq_mask;
+            sqes[index] = sqe;
+            sqes[index].user_data = (uint64_t)handle;
+            sq_array[index] = index;
+            std::atomic_ref<uint32_t>(*sq_tail).store(tail + 1, std::memory_order_release);
+            sq_pending++;
+            if(flush){
+                to_submit = sq_pending;
+                sq_pending = 0;
+            }
+            else
+                wake = sq_pending == 1;
+        }
+        if(to_submit)
+            return io_uring_enter(ring_fd, to_submit, 0, 0) >= 0;
+        if(wake){
+            uint64_t one = 1;
+            return ::write(wake_fd, &one, sizeof(one)) == sizeof(one);
+        }
+        return true;
+    }
+    bool _flush(){
+        uint32_t to_submit = take_pending();
+        if(to_submit)
+            return io_uring_enter(ring_fd, to_submit, 0, 0) >= 0;
+        return true;
+    }
+    static NativeWorkersSingleton& get_instance(){
+        if(instance) return *instance;
+        else {
+            std::lock_guard<art::mutex> lock(instance_mutex);
+            if(!instance)
+                instance = new NativeWorkersSingleton();
+            return *instance;
+        }
+    }
+public:
+    ~NativeWorkersSingleton(){
+        munmap(sqes, sqes_size);
+        if(cq_ptr != sq_ptr)
+            munmap(cq_ptr, cq_ptr_size);
+        munmap(sq_ptr, sq_ptr_size);
+        close(ring_fd);
+        if(wake_fd >= 0)
+            close(wake_fd);
+        if(fixed_buffers)
+            free(fixed_buffers);
+    }
+    //user_data of sqe replaced by handle, data passed to NativeWorkerManager::handle like completion key in windows
+    //if flush is false, sqe queued for batch, first deferred sqe wakes idle dispatcher that submits batch,
+    //so sqe never waits for flush call, flush only submits batch earlier from caller thread
+    static bool submit(NativeWorkerHandle* handle, void* data, const io_uring_sqe& sqe, bool flush = true){
+        return get_instance()._submit(handle, data, sqe, flush);
+    }
+    static bool flush(){
+        return get_instance()._flush();
+    }
+    static bool post_work(NativeWorkerHandle* overlapped, uint32_t dwBytesTransferred = 0){
+        io_uring_sqe sqe;
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_NOP;
+        return submit(overlapped, overlapped, sqe);
+    }
+
+    static io_uring_sqe prepare_rw(uint8_t opcode, int fd, const void* addr, uint32_t len, uint64_t offset){
+        io_uring_sqe sqe;
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.addr = (uint64_t)addr;
+        sqe.len = len;
+        sqe.off = offset;
+        return sqe;
+    }
+    //returns -1 when size too big or all registered buffers in use
+    static int32_t acquire_fixed_buffer(uint32_t size, char*& buffer){
+        NativeWorkersSingleton& self = get_instance();
+        if(size > fixed_buffer_size)
+            return -1;
+        std::lock_guard<art::mutex> lock(self.fixed_mutex);
+        if(!self.free_fixed_count)
+            return -1;
+        uint16_t index = self.free_fixed[--self.free_fixed_count];
+        buffer = self.fixed_buffers + (size_t)index * fixed_buffer_size;
+        return index;
+    }
+    static void release_fixed_buffer(int32_t index){
+        NativeWorkersSingleton& self = get_instance();
+        std::lock_guard<art::mutex> lock(self.fixed_mutex);
+        self.free_fixed[self.free_fixed_count++] = (uint16_t)index;
+    }
+    static io_uring_sqe prepare_read_fixed(int fd, void* buffer, uint32_t len, uint64_t offset, uint16_t buffer_index){
+        io_uring_sqe sqe = prepare_rw(IORING_OP_READ_FIXED, fd, buffer, len, offset);
+        sqe.buf_index = buffer_index;
+        return sqe;
+    }
+    static io_uring_sqe prepare_write_fixed(int fd, const void* buffer, uint32_t len, uint64_t offset, uint16_t buffer_index){
+        io_uring_sqe sqe = prepare_rw(IORING_OP_WRITE_FIXED, fd, buffer, len, offset);
+        sqe.buf_index = buffer_index;
+        return sqe;
+    }
+    static io_uring_sqe prepare_read(int fd, void* buffer, uint32_t len, uint64_t offset){
+        return prepare_rw(IORING_OP_READ, fd, buffer, len, offset);
+    }
+    static io_uring_sqe prepare_write(int fd, const void* buffer, uint32_t len, uint64_t offset){
+        return prepare_rw(IORING_OP_WRITE, fd, buffer, len, offset);
+    }
+    static io_uring_sqe prepare_recv(int fd, void* buffer, uint32_t len, int flags = 0){
+        io_uring_sqe sqe = prepare_rw(IORING_OP_RECV, fd, buffer, len, 0);
+        sqe.msg_flags = flags;
+        return sqe;
+    }
+    static io_uring_sqe prepare_send(int fd, const void* buffer, uint32_t len, int flags = 0){
+        io_uring_sqe sqe = prepare_rw(IORING_OP_SEND, fd, buffer, len, 0);
+        sqe.msg_flags = flags;
+        return sqe;
+    }
+    //multishot accept generates completion for every new connection until canceled or error
+    static io_uring_sqe prepare_accept(int fd, void* addr, void* addr_len, bool multishot){
+        io_uring_sqe sqe = prepare_rw(IORING_OP_ACCEPT, fd, addr, 0, (uint64_t)addr_len);
+        if(multishot)
+            sqe.ioprio |= IORING_ACCEPT_MULTISHOT;
+        return sqe;
+    }
+    static io_uring_sqe prepare_connect(int fd, const void* addr, uint32_t addr_len){
+        return prepare_rw(IORING_OP_CONNECT, fd, addr, 0, addr_len);
+    }
+    //for pipes and sockets offset must be -1, one of fds must be pipe
+    static io_uring_sqe prepare_splice(int fd_in, int64_t offset_in, int fd_out, int64_t offset_out, uint32_t len, uint32_t flags){
+        io_uring_sqe sqe = prepare_rw(IORING_OP_SPLICE, fd_out, nullptr, len, (uint64_t)offset_out);
+        sqe.splice_off_in = (uint64_t)offset_in;
+        sqe.splice_fd_in = fd_in;
+        sqe.splice_flags = flags;
+        return sqe;
+    }
+    static io_uring_sqe prepare_fsync(int fd){
+        return prepare_rw(IORING_OP_FSYNC, fd, nullptr, 0, 0);
+    }
+    static io_uring_sqe prepare_close(int fd){
+        return prepare_rw(IORING_OP_CLOSE, fd, nullptr, 0, 0);
+    }
+    static io_uring_sqe prepare_cancel(NativeWorkerHandle* handle){
+        return prepare_rw(IORING_OP_ASYNC_CANCEL, -1, handle, 0, 0);
+    }
+
+    static std::pair<uint32_t, uint32_t> hill_climb_proceed(std::chrono::steady_clock::duration sample_time){
+        std::lock_guard<art::mutex> lock(instance_mutex);
+        if(!instance)
+            return { 0, 0 };
+        else
+            return instance->proceed_hill_climb(std::chrono::duration<double>(sample_time).count());
+        
+    }
+};
 #endif
 
 #endif /* RUN_TIME_TASKS_UTIL_NATIVE_WORKERS_SINGLETON */
@@ -0,0 +1,187 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+#include "numa.hpp"
+#include <vector>
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+
+namespace run_time{
+    namespace tasks{
+        namespace numa{
+            struct topology{
+                std::vector<PROCESSOR_NUMBER> processors;
+                std::vector<size_t> processor_nodes;
+                std::vector<size_t> group_offsets;
+                size_t nodes = 1;
+                topology(){
+                    WORD groups = GetActiveProcessorGroupCount();
+                    for(WORD group = 0; group < groups; group++){
+                        group_offsets.push_back(processors.size());
+                        DWORD count = GetActiveProcessorCount(group);
+                        for(DWORD i = 0; i < count; i++){
+                            PROCESSOR_NUMBER number{};
+                            number.Group = group;
+                            number.Number = (BYTE)i;
+                            USHORT node = 0;
+                            if(!GetNumaProcessorNodeEx(&number, &node) || node == 0xFFFF)
+                                node = 0;
+                            processors.push_back(number);
+                            processor_nodes.push_back(node);
+                            if(nodes <= node)
+                                nodes = size_t(node) + 1;
+                        }
+                    }
+                }
+            };
+            static topology& get_topology(){
+                static topology instance;
+                return instance;
+            }
+
+            size_t nodes_count(){
+                return get_topology().nodes;
+            }
+            size_t processors_count(){
+                size_t count = get_topology().processors.size();
+                return count ? count : 1;
+            }
+            size_t node_of_processor(size_t processor){
+                auto& top = get_topology();
+                return processor < top.processor_nodes.size() ? top.processor_nodes[processor] : 0;
+            }
+            size_t current_processor(){
+                PROCESSOR_NUMBER number;
+                GetCurrentProcessorNumberEx(&number);
+                auto& top = get_topology();
+                if(number.Group >= top.group_offsets.size())
+                    return 0;
+                return top.group_offsets[number.Group] + number.Number;
+            }
+            size_t current_node(){
+                if(nodes_count() == 1)
+                    return 0;
+                return node_of_processor(current_processor());
+            }
+            bool pin_current_thread(size_t processor){
+                auto& top = get_topology();
+                if(processor >= top.processors.size())
+                    return false;
+                GROUP_AFFINITY affinity{};
+                affinity.Group = top.processors[processor].Group;
+                affinity.Mask = KAFFINITY(1) << top.processors[processor].Number;
+                return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+            }
+            //windows selects node at reserve time, see VirtualAllocExNuma
+            bool bind_memory(void* ptr, size_t size, size_t node){
+                return false;
+            }
+        }
+    }
+}
+#else
+#include <fstream>
+#include <string>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+namespace run_time{
+    namespace tasks{
+        namespace numa{
+            //parses sysfs list format, like "0-3,8,10-11"
+            static std::vector<size_t> parse_list(const std::string& list){
+                std::vector<size_t> res;
+                size_t pos = 0;
+                while(pos < list.size()){
+                    size_t end = list.find(',', pos);
+                    if(end == std::string::npos)
+                        end = list.size();
+                    std::string item = list.substr(pos, end - pos);
+                    size_t dash = item.find('-');
+                    try{
+                        if(dash == std::string::npos)
+                            res.push_back(std::stoull(item));
+                        else{
+                            size_t from = std::stoull(item.substr(0, dash));
+                            size_t to = std::stoull(item.substr(dash + 1));
+                            for(size_t i = from; i <= to; i++)
+                                res.push_back(i);
+                        }
+                    }catch(...){}
+                    pos = end + 1;
+                }
+                return res;
+            }
+            static std::string read_line(const std::string& path){
+                std::ifstream file(path);
+                std::string line;
+                std::getline(file, line);
+                return line;
+            }
+            struct topology{
+                std::vector<size_t> processor_nodes;
+                size_t nodes = 1;
+                topology(){
+                    long count = sysconf(_SC_NPROCESSORS_CONF);
+                    processor_nodes.resize(count > 0 ? count : 1, 0);
+                    for(size_t node : parse_list(read_line("/sys/devices/system/node/online"))){
+                        for(size_t processor : parse_list(read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"))){
+                            if(processor >= processor_nodes.size())
+                                processor_nodes.resize(processor + 1, 0);
+                            processor_nodes[processor] = node;
+                        }
+                        if(nodes <= node)
+                            nodes = node + 1;
+                    }
+                }
+            };
+            static topology& get_topology(){
+                static topology instance;
+                return instance;
+            }
+
+            size_t nodes_count(){
+                return get_topology().nodes;
+            }
+            size_t processors_count(){
+                return get_topology().processor_nodes.size();
+            }
+            size_t node_of_processor(size_t processor){
+                auto& top = get_topology();
+                return processor < top.processor_nodes.size() ? top.processor_nodes[processor] : 0;
+            }
+            size_t current_processor(){
+                int processor = sched_getcpu();
+                return processor < 0 ? 0 : processor;
+            }
+            size_t current_node(){
+                if(nodes_count() == 1)
+                    return 0;
+                return node_of_processor(current_processor());
+            }
+            bool pin_current_thread(size_t processor){
+                if(processor >= CPU_SETSIZE)
+                    return false;
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(processor, &set);
+                return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+            }
+            //mbind without libnuma dependency
+            bool bind_memory(void* ptr, size_t size, size_t node){
+                constexpr size_t mask_bits = sizeof(unsigned long) * 8;
+                if(node >= mask_bits * 16)
+                    return false;
+                unsigned long mask[16] = {};
+                mask[node / mask_bits] = 1ul << (node % mask_bits);
+                return syscall(SYS_mbind, ptr, size, MPOL_PREFERRED, mask, mask_bits * 16, 0) == 0;
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,28 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+#ifndef RUN_TIME_TASKS_UTIL_NUMA
+#define RUN_TIME_TASKS_UTIL_NUMA
+//processor and numa node topology, read once on first use
+//processors numbered from 0 across all processor groups, without numa support whole system is node 0
+#include <cstddef>
+namespace run_time{
+    namespace tasks{
+        namespace numa{
+            size_t nodes_count();
+            size_t processors_count();
+            size_t node_of_processor(size_t processor);
+            size_t current_processor();
+            size_t current_node();
+            //returns false if pinning not supported or failed
+            bool pin_current_thread(size_t processor);
+            //prefer node for pages of range that not faulted yet, returns false if not supported
+            bool bind_memory(void* ptr, size_t size, size_t node);
+        }
+    }
+}
+
+
+#endif /* RUN_TIME_TASKS_UTIL_NUMA */
@@ -0,0 +1,252 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RUN_TIME_TASKS_UTIL_OBJECT_POOL
+#define RUN_TIME_TASKS_UTIL_OBJECT_POOL
+//fixed size blocks recycled through per thread free lists, overflow moved in batches to shared depot
+//block freed on other thread goes to that thread cache, so producer/consumer pairs exchange blocks through depot
+//after thread cache destroyed, blocks of that thread served from depot directly, so other thread_local destructors can still use pool
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <new>
+namespace run_time{
+    namespace tasks{
+        namespace util{
+            struct object_pool_stats{
+                size_t allocated = 0;//taken from global allocator
+                size_t reused = 0;//served from thread cache or depot
+                size_t recycled = 0;//returned to thread cache or depot
+                size_t released = 0;//returned to global allocator
+            };
+            template<size_t block_size, size_t thread_cache_limit, size_t depot_limit>
+            class object_pool{
+                static_assert(block_size >= sizeof(void*), "block must fit free list link");
+                static_assert(thread_cache_limit >= 2, "thread cache must hold at least two blocks");
+                struct node{
+                    node* next;
+                };
+                //counters written only by owner thread, atomics just to allow reading from stats
+                struct counters{
+                    std::atomic_size_t allocated = 0;
+                    std::atomic_size_t reused = 0;
+                    std::atomic_size_t recycled = 0;
+                    std::atomic_size_t released = 0;
+                    static void inc(std::atomic_size_t& c){
+                        add(c, 1);
+                    }
+                    static void add(std::atomic_size_t& c, size_t count){
+                        c.store(c.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+                    }
+                };
+                struct shared_state{
+                    std::mutex lock;
+                    node* depot = nullptr;
+                    size_t depot_size = 0;
+                    std::list<counters*> live;
+                    object_pool_stats retired;
+                    std::atomic_size_t trim_epoch = 0;//thread caches freed on next use when changed
+                };
+                static shared_state& shared(){
+                    static shared_state state;
+                    return state;
+                }
+                //trivially destructible, so stays readable after thread_cache destructor
+                static bool& cache_closed(){
+                    thread_local bool closed = false;
+                    return closed;
+                }
+                //returns count of freed blocks
+                static size_t free_list(node* first){
+                    size_t count = 0;
+                    while(first){
+                        node* next = first->next;
+                        ::operator delete(first);
+                        count++;
+                        first = next;
+                    }
+                    return count;
+                }
+                struct thread_cache{
+                    node* head = nullptr;
+                    size_t size = 0;
+                    size_t seen_epoch;
+                    counters stat;
+                    thread_cache(){
+                        std::lock_guard guard(shared().lock);
+                        shared().live.push_back(&stat);
+                        seen_epoch = shared().trim_epoch.load(std::memory_order_relaxed);
+                    }
+                    ~thread_cache(){
+                        flush(0);
+                        cache_closed() = true;
+                        auto& state = shared();
+                        std::lock_guard guard(state.lock);
+                        state.live.remove(&stat);
+                        state.retired.allocated += stat.allocated;
+                        state.retired.reused += stat.reused;
+                        state.retired.recycled += stat.recycled;
+                        state.retired.released += stat.released;
+                    }
+                    //keep only keep_count blocks, rest moved to depot or freed when depot full
+                    void flush(size_t keep_count){
+                        if(size <= keep_count)
+                            return;
+                        size_t move_count = size - keep_count;
+                        node* first = head;
+                        node* last = head;
+                        for(size_t i = 1; i < move_count; i++)
+                            last = last->next;
+                        head = last->next;
+                        size = keep_count;
+                        auto& state = shared();
+                        {
+                            std::lock_guard guard(state.lock);
+                            if(state.depot_size + move_count <= depot_limit){
+                                last->next = state.depot;
+                                state.depot = first;
+                                state.depot_size += move_count;
+                                return;
+                            }
+                        }
+                        last->next = nullptr;
+                        counters::add(stat.released, free_list(first));
+                    }
+                    //trim requested by other thread, cached blocks returned to global allocator
+                    void check_trim(){
+                        size_t epoch = shared().trim_epoch.load(std::memory_order_relaxed);
+                        if(epoch == seen_epoch)
+                            return;
+                        seen_epoch = epoch;
+                        counters::add(stat.released, free_list(head));
+                        head = nullptr;
+                        size = 0;
+                    }
+                    bool refill(){
+                        auto& state = shared();
+                        std::lock_guard guard(state.lock);
+                        if(!state.depot)
+                            return false;
+                        size_t take = thread_cache_limit / 2;
+                        node* first = state.depot;
+                        node* last = first;
+                        size_t taken = 1;
+                        while(taken < take && last->next){
+                            last = last->next;
+                            taken++;
+                        }
+                        state.depot = last->next;
+                        state.depot_size -= taken;
+                        last->next = head;
+                        head = first;
+                        size += taken;
+                        return true;
+                    }
+                };
+                static thread_cache& cache(){
+                    thread_local thread_cache local;
+                    return local;
+                }
+                //thread cache already destroyed, block taken from depot or global allocator
+                static void* allocate_closed(){
+                    auto& state = shared();
+                    std::lock_guard guard(state.lock);
+                    if(state.depot){
+                        node* res = state.depot;
+                        state.depot = res->next;
+                        state.depot_size--;
+                        state.retired.reused++;
+                        return res;
+                    }
+                    state.retired.allocated++;
+                    return ::operator new(block_size);
+                }
+                static void deallocate_closed(node* n){
+                    auto& state = shared();
+                    {
+                        std::lock_guard guard(state.lock);
+                        if(state.depot_size < depot_limit){
+                            n->next = state.depot;
+                            state.depot = n;
+                            state.depot_size++;
+                            state.retired.recycled++;
+                            return;
+                        }
+                        state.retired.released++;
+                    }
+                    ::operator delete(n);
+                }
+            public:
+                static void* allocate(){
+                    if(cache_closed())
+                        return allocate_closed();
+                    thread_cache& local = cache();
+                    local.check_trim();
+                    if(local.head || local.refill()){
+                        node* res = local.head;
+                        local.head = res->next;
+                        local.size--;
+                        counters::inc(local.stat.reused);
+                        return res;
+                    }
+                    counters::inc(local.stat.allocated);
+                    return ::operator new(block_size);
+                }
+                static void deallocate(void* ptr){
+                    if(!ptr)
+                        return;
+                    node* n = (node*)ptr;
+                    if(cache_closed())
+                        return deallocate_closed(n);
+                    thread_cache& local = cache();
+                    local.check_trim();
+                    n->next = local.head;
+                    local.head = n;
+                    local.size++;
+                    counters::inc(local.stat.recycled);
+                    if(local.size > thread_cache_limit)
+                        local.flush(thread_cache_limit / 2);
+                }
+                //frees blocks cached by current thread and depot at once,
+                //other threads caches owned by them without lock, so they free own blocks on next allocate or deallocate
+                static void trim(){
+                    auto& state = shared();
+                    state.trim_epoch.fetch_add(1, std::memory_order_relaxed);
+                    node* depot;
+                    {
+                        std::lock_guard guard(state.lock);
+                        depot = state.depot;
+                        state.depot = nullptr;
+                        state.depot_size = 0;
+                    }
+                    size_t released = free_list(depot);
+                    if(cache_closed()){
+                        std::lock_guard guard(state.lock);
+                        state.retired.released += released;
+                        return;
+                    }
+                    thread_cache& local = cache();
+                    local.check_trim();
+                    counters::add(local.stat.released, released);
+                }
+                static object_pool_stats stats(){
+                    auto& state = shared();
+                    std::lock_guard guard(state.lock);
+                    object_pool_stats res = state.retired;
+                    for(counters* it : state.live){
+                        res.allocated += it->allocated.load(std::memory_order_relaxed);
+                        res.reused += it->reused.load(std::memory_order_relaxed);
+                        res.recycled += it->recycled.load(std::memory_order_relaxed);
+                        res.released += it->released.load(std::memory_order_relaxed);
+                    }
+                    return res;
+                }
+            };
+        }
+    }
+}
+#endif /* RUN_TIME_TASKS_UTIL_OBJECT_POOL */
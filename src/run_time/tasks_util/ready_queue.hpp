@@ -0,0 +1,219 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RUN_TIME_TASKS_UTIL_READY_QUEUE
+#define RUN_TIME_TASKS_UTIL_READY_QUEUE
+//ready queue with priority lanes, lane 0 served first
+//entries with deadline ordered by earliest deadline first inside own lane, others kept in fifo order
+//fifo head served after it waited one aging step, without aging when it was queued before every waiting deadline entry
+//clock read on push only when aging enabled, entries pushed without aging count as longest waiting if aging enabled later
+//anti starvation: each aging step of waiting lifts entry by one lane, so lower lanes still progress under saturating load
+//aged entries can reach lane 0 rank but ties resolved to higher lane, so lane 0 work is never delayed by aged entries
+//not thread safe, caller must synchronize access, only urgent() can be read without lock
+//T must provide ->priority (convertible to size_t) and ->deadline (time_point::min() when not set)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+namespace run_time{
+    namespace tasks{
+        namespace util{
+            template<class T, size_t levels, size_t normal_level>
+            class ready_queue{
+                static_assert(levels > 0 && normal_level < levels, "normal_level must be one of levels");
+                using clock = std::chrono::high_resolution_clock;
+                struct entry{
+                    T value;
+                    uint64_t order;
+                    clock::time_point queued;//time_point::min() when pushed without aging
+                };
+                struct deadline_entry{
+                    clock::time_point deadline;
+                    entry item;
+                };
+                //min heap by deadline, order keeps fifo for equal deadlines
+                struct deadline_later{
+                    bool operator()(const deadline_entry& a, const deadline_entry& b) const{
+                        if(a.deadline != b.deadline)
+                            return a.deadline > b.deadline;
+                        return a.item.order > b.item.order;
+                    }
+                };
+                struct lane{
+                    std::deque<entry> fifo;
+                    std::vector<deadline_entry> edf;
+                    //deadline entries in push order, heap front is earliest deadline, not longest waiting
+                    std::deque<std::pair<uint64_t, clock::time_point>> edf_arrivals;
+                    std::vector<uint64_t> edf_taken;//min heap of orders taken while older arrivals still wait
+                    bool empty() const{
+                        return fifo.empty() && edf.empty();
+                    }
+                    uint64_t edf_first_order() const{
+                        return edf_arrivals.front().first;
+                    }
+                    clock::time_point edf_oldest() const{
+                        return edf_arrivals.front().second;
+                    }
+                    clock::time_point oldest() const{
+                        if(fifo.empty())
+                            return edf_oldest();
+                        if(edf.empty())
+                            return fifo.front().queued;
+                        return fifo.front().queued < edf_oldest() ? fifo.front().queued : edf_oldest();
+                    }
+                    void edf_push(deadline_entry&& item){
+                        edf_arrivals.push_back({item.item.order, item.item.queued});
+                        edf.push_back(std::move(item));
+                        std::push_heap(edf.begin(), edf.end(), deadline_later());
+                    }
+                    T edf_pop(){
+                        std::pop_heap(edf.begin(), edf.end(), deadline_later());
+                        T res = std::move(edf.back().item.value);
+                        edf_taken.push_back(edf.back().item.order);
+                        std::push_heap(edf_taken.begin(), edf_taken.end(), std::greater<uint64_t>());
+                        edf.pop_back();
+                        //arrivals sorted by order, so taken ones leave from front only
+                        while(!edf_taken.empty() && edf_arrivals.front().first == edf_taken.front()){
+                            std::pop_heap(edf_taken.begin(), edf_taken.end(), std::greater<uint64_t>());
+                            edf_taken.pop_back();
+                            edf_arrivals.pop_front();
+                        }
+                        return res;
+                    }
+                    void swap(lane& other){
+                        fifo.swap(other.fifo);
+                        edf.swap(other.edf);
+                        edf_arrivals.swap(other.edf_arrivals);
+                        edf_taken.swap(other.edf_taken);
+                    }
+                    void clear(){
+                        std::deque<entry>().swap(fifo);
+                        std::vector<deadline_entry>().swap(edf);
+                        std::deque<std::pair<uint64_t, clock::time_point>>().swap(edf_arrivals);
+                        std::vector<uint64_t>().swap(edf_taken);
+                    }
+                };
+                lane lanes[levels];
+                size_t count = 0;
+                uint64_t order = 0;
+                std::atomic_size_t urgent_count = 0;//entries above normal_level or with deadline
+
+                static size_t level_of(const T& value){
+                    size_t level = (size_t)value->priority;
+                    return level < levels ? level : levels - 1;
+                }
+                static bool is_urgent(size_t level, bool has_deadline){
+                    return level < normal_level || has_deadline;
+                }
+                static clock::duration waited(clock::time_point now, clock::time_point queued){
+                    return queued == clock::time_point::min() ? clock::duration::max() : now - queued;
+                }
+                static int64_t rank_of(size_t level, clock::duration waited, std::chrono::nanoseconds aging_step){
+                    int64_t rank = int64_t(level) - int64_t(waited / aging_step);
+                    return rank < 0 ? 0 : rank;
+                }
+                //aged rank = lane - waited / aging_step, lowest rank wins, ties keep higher lane
+                size_t select_lane(std::chrono::nanoseconds aging_step, clock::time_point& now) const{
+                    size_t best = 0;
+                    while(lanes[best].empty())
+                        best++;
+                    if(aging_step.count() <= 0)
+                        return best;
+                    bool has_lower = false;
+                    for(size_t i = best + 1; i < levels && !has_lower; i++)
+                        has_lower = !lanes[i].empty();
+                    if(!has_lower)
+                        return best;
+                    now = clock::now();
+                    int64_t best_rank = rank_of(best, waited(now, lanes[best].oldest()), aging_step);
+                    for(size_t i = best + 1; i < levels; i++){
+                        if(lanes[i].empty())
+                            continue;
+                        int64_t rank = rank_of(i, waited(now, lanes[i].oldest()), aging_step);
+                        if(rank < best_rank){
+                            best_rank = rank;
+                            best = i;
+                        }
+                    }
+                    return best;
+                }
+            public:
+                //aging_step must match one passed to take, zero skips clock read
+                void push(T value, std::chrono::nanoseconds aging_step = std::chrono::nanoseconds(0)){
+                    size_t level = level_of(value);
+                    clock::time_point deadline = value->deadline;
+                    bool has_deadline = deadline != clock::time_point::min();
+                    clock::time_point queued = aging_step.count() > 0 ? clock::now() : clock::time_point::min();
+                    lane& target = lanes[level];
+                    if(has_deadline)
+                        target.edf_push({deadline, {std::move(value), order++, queued}});
+                    else
+                        target.fifo.push_back({std::move(value), order++, queued});
+                    if(is_urgent(level, has_deadline))
+                        urgent_count.fetch_add(1, std::memory_order_relaxed);
+                    ++count;
+                }
+                //queue must not be empty, aging_step zero disables aging
+                T take(std::chrono::nanoseconds aging_step = std::chrono::nanoseconds(0)){
+                    clock::time_point now = clock::time_point::min();
+                    size_t level = select_lane(aging_step, now);
+                    lane& source = lanes[level];
+                    //deadline entries go first, fifo head gets turn after it waited one aging step
+                    //without aging fifo head goes when it is older than every waiting deadline entry, so it can not starve
+                    bool use_fifo = source.edf.empty();
+                    if(!use_fifo && !source.fifo.empty()){
+                        if(aging_step.count() > 0){
+                            if(now == clock::time_point::min())
+                                now = clock::now();
+                            use_fifo = waited(now, source.fifo.front().queued) >= aging_step;
+                        }else
+                            use_fifo = source.fifo.front().order < source.edf_first_order();
+                    }
+                    T res;
+                    if(use_fifo){
+                        res = std::move(source.fifo.front().value);
+                        source.fifo.pop_front();
+                    }else
+                        res = source.edf_pop();
+                    if(is_urgent(level, !use_fifo))
+                        urgent_count.fetch_sub(1, std::memory_order_relaxed);
+                    --count;
+                    return res;
+                }
+                bool empty() const{
+                    return !count;
+                }
+                size_t size() const{
+                    return count;
+                }
+                //count of ready entries that should not wait behind normal work, safe to read without lock
+                size_t urgent() const{
+                    return urgent_count.load(std::memory_order_relaxed);
+                }
+                void swap(ready_queue& other){
+                    for(size_t i = 0; i < levels; i++)
+                        lanes[i].swap(other.lanes[i]);
+                    std::swap(count, other.count);
+                    std::swap(order, other.order);
+                    size_t tmp = urgent_count.load(std::memory_order_relaxed);
+                    urgent_count.store(other.urgent_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    other.urgent_count.store(tmp, std::memory_order_relaxed);
+                }
+                void clear(){
+                    for(size_t i = 0; i < levels; i++)
+                        lanes[i].clear();
+                    count = 0;
+                    urgent_count.store(0, std::memory_order_relaxed);
+                }
+            };
+        }
+    }
+}
+#endif /* RUN_TIME_TASKS_UTIL_READY_QUEUE */
@@ -0,0 +1,61 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RUN_TIME_TASKS_UTIL_SPIN_WAIT
+#define RUN_TIME_TASKS_UTIL_SPIN_WAIT
+//bounded spinning before parking, used by task synchronization primitives
+#include <atomic>
+#include <cstdint>
+#if defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+#include <intrin.h>
+#endif
+namespace run_time{
+    namespace tasks{
+        namespace util{
+            inline void cpu_relax(){
+#if defined(_M_X64) || defined(_M_IX86)
+                _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#elif defined(_M_ARM64)
+                __yield();
+#elif defined(__aarch64__)
+                __asm__ __volatile__("yield");
+#endif
+            }
+
+            //spin limit follows how long acquiring took recently, like adaptive pthread mutex
+            //short critical sections grow limit up to max_spin, owners that hold lock long shrink it to few iterations
+            template<uint32_t max_spin = 1024>
+            class adaptive_spin{
+                std::atomic_int32_t estimate = 16;
+                void learn(int32_t spins){
+                    int32_t current = estimate.load(std::memory_order_relaxed);
+                    estimate.store(current + (spins - current) / 8, std::memory_order_relaxed);
+                }
+            public:
+                //returns true if try_acquire succeeded during spin
+                template<class F>
+                bool spin(F&& try_acquire){
+                    int32_t current = estimate.load(std::memory_order_relaxed);
+                    int32_t limit = current * 2 + 10;
+                    if(limit > int32_t(max_spin))
+                        limit = int32_t(max_spin);
+                    for(int32_t i = 0; i < limit; i++){
+                        cpu_relax();
+                        if(try_acquire()){
+                            learn(i);
+                            return true;
+                        }
+                    }
+                    learn(0);
+                    return false;
+                }
+            };
+        }
+    }
+}
+#endif /* RUN_TIME_TASKS_UTIL_SPIN_WAIT */
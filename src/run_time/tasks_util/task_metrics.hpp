@@ -0,0 +1,189 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RUN_TIME_TASKS_UTIL_TASK_METRICS
+#define RUN_TIME_TASKS_UTIL_TASK_METRICS
+//scheduler counters kept per thread and written only by owner thread, readers sum them under registry lock
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <list>
+#include <mutex>
+namespace run_time{
+    namespace tasks{
+        namespace util{
+            //owner thread writes, any thread reads, so no locked instructions on hot path
+            inline void metric_add(std::atomic_uint64_t& counter, uint64_t value = 1){
+                counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            }
+            //log linear buckets, 8 sub buckets per power of two, relative error 12.5%
+            class latency_histogram{
+            public:
+                static constexpr size_t sub_bucket_bits = 3;
+                static constexpr size_t sub_buckets = size_t(1) << sub_bucket_bits;
+                static constexpr size_t buckets_count = (64 - sub_bucket_bits + 1) * sub_buckets;
+                static size_t index_of(uint64_t value){
+                    if(value < sub_buckets)
+                        return value;
+                    size_t shift = 63 - std::countl_zero(value) - sub_bucket_bits;
+                    return (shift + 1) * sub_buckets + ((value >> shift) & (sub_buckets - 1));
+                }
+                //largest value that falls into bucket
+                static uint64_t upper_bound_of(size_t index){
+                    if(index < sub_buckets)
+                        return index;
+                    size_t shift = index / sub_buckets - 1;
+                    uint64_t sub = index % sub_buckets;
+                    return ((sub_buckets + sub + 1) << shift) - 1;
+                }
+                std::atomic_uint64_t buckets[buckets_count] = {};
+                std::atomic_uint64_t count = 0;
+                std::atomic_uint64_t sum = 0;
+                std::atomic_uint64_t max = 0;
+                void record(uint64_t value){
+                    metric_add(buckets[index_of(value)]);
+                    metric_add(count);
+                    metric_add(sum, value);
+                    if(max.load(std::memory_order_relaxed) < value)
+                        max.store(value, std::memory_order_relaxed);
+                }
+            };
+            struct histogram_snapshot{
+                uint64_t buckets[latency_histogram::buckets_count] = {};
+                uint64_t count = 0;
+                uint64_t sum = 0;
+                uint64_t max = 0;
+                void add(const latency_histogram& histogram){
+                    for(size_t i = 0; i < latency_histogram::buckets_count; i++)
+                        buckets[i] += histogram.buckets[i].load(std::memory_order_relaxed);
+                    count += histogram.count.load(std::memory_order_relaxed);
+                    sum += histogram.sum.load(std::memory_order_relaxed);
+                    uint64_t other_max = histogram.max.load(std::memory_order_relaxed);
+                    if(max < other_max)
+                        max = other_max;
+                }
+                void add(const histogram_snapshot& histogram){
+                    for(size_t i = 0; i < latency_histogram::buckets_count; i++)
+                        buckets[i] += histogram.buckets[i];
+                    count += histogram.count;
+                    sum += histogram.sum;
+                    if(max < histogram.max)
+                        max = histogram.max;
+                }
+                //quantile in range [0, 1], returns upper bound of bucket
+                uint64_t percentile(double quantile) const{
+                    if(!count)
+                        return 0;
+                    uint64_t target = uint64_t(quantile * count);
+                    if(target >= count)
+                        target = count - 1;
+                    uint64_t seen = 0;
+                    for(size_t i = 0; i < latency_histogram::buckets_count; i++){
+                        seen += buckets[i];
+                        if(seen > target){
+                            uint64_t bound = latency_histogram::upper_bound_of(i);
+                            return bound < max ? bound : max;
+                        }
+                    }
+                    return max;
+                }
+            };
+
+            struct worker_metrics{
+                uint64_t thread_id = 0;
+                std::atomic_uint64_t tasks_executed = 0;
+                std::atomic_uint64_t context_resumes = 0;
+                std::atomic_uint64_t steals = 0;
+                std::atomic_uint64_t local_pushes = 0;
+                std::atomic_uint64_t injections = 0;
+                latency_histogram ready_wait;//ns between task queued and taken by worker
+                latency_histogram mutex_wait;//ns task blocked on TaskMutex
+                latency_histogram condition_wait;//ns task blocked on TaskConditionVariable
+            };
+            struct worker_metrics_snapshot{
+                uint64_t thread_id = 0;
+                uint64_t tasks_executed = 0;
+                uint64_t context_resumes = 0;
+                uint64_t steals = 0;
+                uint64_t local_pushes = 0;
+                uint64_t injections = 0;
+                histogram_snapshot ready_wait;
+                histogram_snapshot mutex_wait;
+                histogram_snapshot condition_wait;
+                void add(const worker_metrics& metrics){
+                    tasks_executed += metrics.tasks_executed.load(std::memory_order_relaxed);
+                    context_resumes += metrics.context_resumes.load(std::memory_order_relaxed);
+                    steals += metrics.steals.load(std::memory_order_relaxed);
+                    local_pushes += metrics.local_pushes.load(std::memory_order_relaxed);
+                    injections += metrics.injections.load(std::memory_order_relaxed);
+                    ready_wait.add(metrics.ready_wait);
+                    mutex_wait.add(metrics.mutex_wait);
+                    condition_wait.add(metrics.condition_wait);
+                }
+                void add(const worker_metrics_snapshot& metrics){
+                    tasks_executed += metrics.tasks_executed;
+                    context_resumes += metrics.context_resumes;
+                    steals += metrics.steals;
+                    local_pushes += metrics.local_pushes;
+                    injections += metrics.injections;
+                    ready_wait.add(metrics.ready_wait);
+                    mutex_wait.add(metrics.mutex_wait);
+                    condition_wait.add(metrics.condition_wait);
+                }
+            };
+
+            class task_metrics{
+                struct shared_state{
+                    std::mutex lock;
+                    std::list<worker_metrics*> live;
+                    worker_metrics_snapshot retired;
+                };
+                static shared_state& shared(){
+                    static shared_state state;
+                    return state;
+                }
+                struct thread_metrics{
+                    worker_metrics metrics;
+                    thread_metrics(){
+                        std::lock_guard guard(shared().lock);
+                        shared().live.push_back(&metrics);
+                    }
+                    ~thread_metrics(){
+                        auto& state = shared();
+                        std::lock_guard guard(state.lock);
+                        state.live.remove(&metrics);
+                        state.retired.add(metrics);
+                    }
+                };
+            public:
+                static worker_metrics& local(){
+                    thread_local thread_metrics metrics;
+                    return metrics.metrics;
+                }
+                //all threads that touched scheduler, finished threads merged to totals only
+                static std::list<worker_metrics_snapshot> workers(){
+                    std::list<worker_metrics_snapshot> res;
+                    auto& state = shared();
+                    std::lock_guard guard(state.lock);
+                    for(worker_metrics* it : state.live){
+                        res.emplace_back().thread_id = it->thread_id;
+                        res.back().add(*it);
+                    }
+                    return res;
+                }
+                static worker_metrics_snapshot totals(){
+                    auto& state = shared();
+                    std::lock_guard guard(state.lock);
+                    worker_metrics_snapshot res = state.retired;
+                    for(worker_metrics* it : state.live)
+                        res.add(*it);
+                    return res;
+                }
+            };
+        }
+    }
+}
+#endif /* RUN_TIME_TASKS_UTIL_TASK_METRICS */
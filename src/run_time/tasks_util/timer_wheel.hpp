@@ -0,0 +1,138 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RUN_TIME_TASKS_UTIL_TIMER_WHEEL
+#define RUN_TIME_TASKS_UTIL_TIMER_WHEEL
+//hashed hierarchical timer wheel, 4 levels by 256 slots with 1 ms tick, covers ~49 days, farther entries kept in overflow
+//insert is O(1), entries moved to lower level when wheel reaches their slot
+//not thread safe, caller must synchronize access
+#include <chrono>
+#include <cstdint>
+#include <vector>
+namespace run_time{
+    namespace tasks{
+        namespace util{
+            template<class T>
+            class timer_wheel{
+                using clock = std::chrono::high_resolution_clock;
+                static constexpr uint64_t slot_bits = 8;
+                static constexpr uint64_t slots = 1 << slot_bits;
+                static constexpr uint64_t slot_mask = slots - 1;
+                static constexpr size_t levels = 4;
+                struct entry{
+                    uint64_t tick;
+                    T value;
+                };
+                std::vector<entry> wheel[levels][slots];
+                std::vector<entry> overflow;
+                clock::time_point epoch;
+                uint64_t current = 0;
+                size_t count = 0;
+
+                uint64_t to_tick_ceil(clock::time_point time_point) const{
+                    if(time_point <= epoch)
+                        return 0;
+                    uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(time_point - epoch).count();
+                    return (nanos + 999999) / 1000000;
+                }
+                uint64_t to_tick_floor(clock::time_point time_point) const{
+                    if(time_point <= epoch)
+                        return 0;
+                    return std::chrono::duration_cast<std::chrono::milliseconds>(time_point - epoch).count();
+                }
+                clock::time_point to_time_point(uint64_t tick) const{
+                    return epoch + std::chrono::milliseconds(tick);
+                }
+                void place(entry&& item){
+                    uint64_t diff = item.tick - current;
+                    if(diff < (uint64_t(1) << slot_bits))
+                        wheel[0][item.tick & slot_mask].push_back(std::move(item));
+                    else if(diff < (uint64_t(1) << (slot_bits * 2)))
+                        wheel[1][(item.tick >> slot_bits) & slot_mask].push_back(std::move(item));
+                    else if(diff < (uint64_t(1) << (slot_bits * 3)))
+                        wheel[2][(item.tick >> (slot_bits * 2)) & slot_mask].push_back(std::move(item));
+                    else if(diff < (uint64_t(1) << (slot_bits * 4)))
+                        wheel[3][(item.tick >> (slot_bits * 3)) & slot_mask].push_back(std::move(item));
+                    else
+                        overflow.push_back(std::move(item));
+                }
+                void cascade(std::vector<entry>& slot){
+                    std::vector<entry> moved;
+                    moved.swap(slot);
+                    for(entry& item : moved)
+                        place(std::move(item));
+                }
+            public:
+                timer_wheel() : epoch(clock::now()) {}
+
+                void insert(clock::time_point time_point, T&& value){
+                    uint64_t tick = to_tick_ceil(time_point);
+                    if(tick <= current)
+                        tick = current + 1;
+                    place(entry{tick, std::move(value)});
+                    count++;
+                }
+                //calls on_expire(T&&) for every entry with time point less or equal than now
+                template<class F>
+                void advance(clock::time_point now, F&& on_expire){
+                    uint64_t target = to_tick_floor(now);
+                    if(!count){
+                        if(target > current)
+                            current = target;
+                        return;
+                    }
+                    while(current < target && count){
+                        uint64_t tick = ++current;
+                        if((tick & slot_mask) == 0){
+                            if(((tick >> slot_bits) & slot_mask) == 0){
+                                if(((tick >> (slot_bits * 2)) & slot_mask) == 0){
+                                    cascade(wheel[3][(tick >> (slot_bits * 3)) & slot_mask]);
+                                    cascade(overflow);
+                                }
+                                cascade(wheel[2][(tick >> (slot_bits * 2)) & slot_mask]);
+                            }
+                            cascade(wheel[1][(tick >> slot_bits) & slot_mask]);
+                        }
+                        std::vector<entry>& slot = wheel[0][tick & slot_mask];
+                        if(slot.empty())
+                            continue;
+                        std::vector<entry> expired;
+                        expired.swap(slot);
+                        count -= expired.size();
+                        for(entry& item : expired)
+                            on_expire(std::move(item.value));
+                    }
+                    if(target > current)
+                        current = target;
+                }
+                //returns time point when advance should be called next, can be earlier than real expiration
+                clock::time_point next_time_point() const{
+                    if(!count)
+                        return clock::time_point::max();
+                    for(uint64_t i = 1; i <= slots; i++){
+                        uint64_t tick = current + i;
+                        if(!wheel[0][tick & slot_mask].empty() || (tick & slot_mask) == 0)
+                            return to_time_point(tick);
+                    }
+                    return to_time_point(current + slots);
+                }
+                size_t size() const{
+                    return count;
+                }
+                bool empty() const{
+                    return count == 0;
+                }
+                void shrink_to_fit(){
+                    for(auto& level : wheel)
+                        for(auto& slot : level)
+                            slot.shrink_to_fit();
+                    overflow.shrink_to_fit();
+                }
+            };
+        }
+    }
+}
+#endif /* RUN_TIME_TASKS_UTIL_TIMER_WHEEL */
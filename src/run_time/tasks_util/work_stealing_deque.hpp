@@ -0,0 +1,114 @@
+// Copyright Danyil Melnytskyi 2022-2023
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RUN_TIME_TASKS_UTIL_WORK_STEALING_DEQUE
+#define RUN_TIME_TASKS_UTIL_WORK_STEALING_DEQUE
+//Chase-Lev deque, memory orders from "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Zappa Nardelli)
+//owner thread uses push and pop from bottom, any other thread can steal from top
+#include <atomic>
+#include <cstdint>
+#include <vector>
+namespace run_time{
+    namespace tasks{
+        namespace util{
+            template<class T>
+            class work_stealing_deque{
+                struct ring{
+                    int64_t capacity;
+                    int64_t mask;
+                    std::atomic<T*>* items;
+                    ring(int64_t cap) : capacity(cap), mask(cap - 1), items(new std::atomic<T*>[cap]) {}
+                    ~ring(){
+                        delete[] items;
+                    }
+                    T* get(int64_t i) const noexcept{
+                        return items[i & mask].load(std::memory_order_relaxed);
+                    }
+                    void put(int64_t i, T* item) noexcept{
+                        items[i & mask].store(item, std::memory_order_relaxed);
+                    }
+                    ring* grow(int64_t bottom, int64_t top) const{
+                        ring* res = new ring(capacity << 1);
+                        for(int64_t i = top; i < bottom; i++)
+                            res->put(i, get(i));
+                        return res;
+                    }
+                };
+                alignas(64) std::atomic<int64_t> top;
+                alignas(64) std::atomic<int64_t> bottom;
+                alignas(64) std::atomic<ring*> array;
+                //old rings can be still readed by thieves, so they released only with deque
+                std::vector<ring*> retired;
+            public:
+                //capacity must be power of two
+                work_stealing_deque(int64_t capacity = 256) : top(0), bottom(0), array(new ring(capacity)) {}
+                work_stealing_deque(const work_stealing_deque&) = delete;
+                work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+                ~work_stealing_deque(){
+                    delete array.load(std::memory_order_relaxed);
+                    for(ring* it : retired)
+                        delete it;
+                }
+                //owner only
+                void push(T* item){
+                    int64_t b = bottom.load(std::memory_order_relaxed);
+                    int64_t t = top.load(std::memory_order_acquire);
+                    ring* a = array.load(std::memory_order_relaxed);
+                    if(b - t > a->capacity - 1){
+                        ring* grown = a->grow(b, t);
+                        retired.push_back(a);
+                        array.store(grown, std::memory_order_release);
+                        a = grown;
+                    }
+                    a->put(b, item);
+                    std::atomic_thread_fence(std::memory_order_release);
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                //owner only, returns nullptr if empty
+                T* pop() noexcept{
+                    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+                    ring* a = array.load(std::memory_order_relaxed);
+                    bottom.store(b, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    int64_t t = top.load(std::memory_order_relaxed);
+                    if(t > b){
+                        bottom.store(b + 1, std::memory_order_relaxed);
+                        return nullptr;
+                    }
+                    T* item = a->get(b);
+                    if(t == b){
+                        if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                            item = nullptr;
+                        bottom.store(b + 1, std::memory_order_relaxed);
+                    }
+                    return item;
+                }
+                //any thread, returns nullptr if empty or lost race with other thief/owner
+                T* steal() noexcept{
+                    int64_t t = top.load(std::memory_order_acquire);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    int64_t b = bottom.load(std::memory_order_acquire);
+                    if(t >= b)
+                        return nullptr;
+                    ring* a = array.load(std::memory_order_acquire);
+                    T* item = a->get(t);
+                    if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                        return nullptr;
+                    return item;
+                }
+                size_t size() const noexcept{
+                    int64_t b = bottom.load(std::memory_order_relaxed);
+                    int64_t t = top.load(std::memory_order_relaxed);
+                    return b > t ? size_t(b - t) : 0;
+                }
+                bool empty() const noexcept{
+                    return size() == 0;
+                }
+            };
+        }
+    }
+}
+#endif /* RUN_TIME_TASKS_UTIL_WORK_STEALING_DEQUE */
@@ -10,6 +10,9 @@
 #include <vector>
 #include <cassert>
 #include <unordered_map>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
 #include "run_time/standard_lib.hpp"
 #include "run_time/attacha_abi_structs.hpp"
 #include "run_time/func_enviro_builder.hpp"
@@ -19,6 +22,7 @@
 #include <Windows.h>
 #include "run_time/asm/CASM.hpp"
 #include "run_time/tasks_util/light_stack.hpp"
+#include "run_time/tasks_util/numa.hpp"
 #include "run_time/library/console.hpp"
 #include "run_time/AttachA_CXX.hpp"
 struct test_struct {
@@ -103,6 +107,76 @@ void lgr_loop_test() {
 	typed_lgr tlgr(new test_lgr());
 	tlgr->self = tlgr;
 }
+struct lgr_alloc_test_item {
+	size_t value = 0;
+};
+//create, copy 4 times and destroy, separate counters vs single allocation
+void lgr_alloc_test() {
+	const size_t iterations = 1000000;
+	for (bool single : {false, true}) {
+		auto started = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < iterations; i++) {
+			typed_lgr<lgr_alloc_test_item> item = single ? make_lgr<lgr_alloc_test_item>() : typed_lgr<lgr_alloc_test_item>(new lgr_alloc_test_item());
+			typed_lgr<lgr_alloc_test_item> copies[4] = { item, item, item, item };
+		}
+		uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		ValueItem msq(std::string(single ? "make_lgr" : "new + lgr") + " ns per create/copy/destroy: " + std::to_string(time / iterations));
+		console::printLine(&msq, 1);
+	}
+}
+
+ValueItem* task_pool_test_0(ValueItem*, uint32_t) {
+	return nullptr;
+}
+//many tiny tasks, blocks must be reused after first round
+ValueItem* task_pool_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(task_pool_test_0, true, false);
+	ValueItem noting;
+	const size_t rounds = 10;
+	const size_t per_round = 10000;
+	auto started = std::chrono::high_resolution_clock::now();
+	for (size_t r = 0; r < rounds; r++) {
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < per_round; i++)
+			tasks.push_back(make_lgr<Task>(func, noting));
+		Task::await_multiple(tasks);
+	}
+	uint64_t time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - started).count();
+	auto stats = Task::allocation_stats();
+	ValueItem msq(
+		"tasks per second: " + std::to_string(rounds * per_round * 1000000 / (time ? time : 1))
+		+ ", allocated: " + std::to_string(stats.allocated)
+		+ ", reused: " + std::to_string(stats.reused)
+		+ ", recycled: " + std::to_string(stats.recycled)
+		+ ", released: " + std::to_string(stats.released)
+	);
+	console::printLine(&msq, 1);
+	return nullptr;
+}
+
+//fork-join of 10k empty tasks, started one by one and as one batch
+ValueItem* batch_start_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(task_pool_test_0, true, false);
+	ValueItem noting;
+	for (bool batch : {false, true}) {
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < 10000; i++)
+			tasks.push_back(make_lgr<Task>(func, noting));
+		auto started = std::chrono::high_resolution_clock::now();
+		if (batch)
+			Task::start(tasks);
+		else {
+			for (auto& it : tasks)
+				Task::start(it);
+		}
+		uint64_t submit_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		Task::await_multiple(tasks, true);
+		uint64_t time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		ValueItem msq(std::string(batch ? "batch" : "one by one") + " submit: " + std::to_string(submit_time) + " us, fork-join: " + std::to_string(time) + " us");
+		console::printLine(&msq, 1);
+	}
+	return nullptr;
+}
 
 ValueItem* paralelize_test_0_0(ValueItem*,uint32_t) {
 	for (size_t i = 0; i < 100; i++) {
@@ -127,6 +201,398 @@ ValueItem* paralelize_test_0(ValueItem*, uint32_t) {
 	return nullptr;
 }
 
+//run contended tasks and print scheduler counters
+ValueItem* task_metrics_test(ValueItem*, uint32_t) {
+	ValueItem* res = paralelize_test_0(nullptr, 0);
+	delete res;
+	ValueItem metrics = Task::metrics();
+	console::printLine(&metrics, 1);
+	return nullptr;
+}
+
+TaskMutex mutex_contention_test_mutex;
+size_t mutex_contention_test_counter = 0;
+ValueItem* mutex_contention_test_0(ValueItem* args, uint32_t) {
+	size_t iterations = (size_t)args[0];
+	for (size_t i = 0; i < iterations; i++) {
+		art::lock_guard guard(mutex_contention_test_mutex);
+		mutex_contention_test_counter++;
+	}
+	return nullptr;
+}
+//1 to 64 tasks hammer one mutex with 100k lock/unlock pairs in total
+ValueItem* mutex_contention_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(mutex_contention_test_0, false, false);
+	const size_t total = 100000;
+	for (size_t contenders = 1; contenders <= 64; contenders *= 2) {
+		mutex_contention_test_counter = 0;
+		auto started = std::chrono::high_resolution_clock::now();
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < contenders; i++)
+			tasks.push_back(new Task(func, ValueItem(total / contenders)));
+		Task::await_multiple(tasks);
+		uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		ValueItem msq(
+			std::to_string(contenders) + " tasks: " + std::to_string(time / (mutex_contention_test_counter ? mutex_contention_test_counter : 1)) + " ns per lock"
+			+ (mutex_contention_test_counter == total / contenders * contenders ? "" : ", counter mismatch")
+		);
+		console::printLine(&msq, 1);
+	}
+	return nullptr;
+}
+
+TaskSharedMutex shared_mutex_test_rw;
+TaskMutex shared_mutex_test_exclusive;
+std::atomic_size_t shared_mutex_test_reads = 0;
+ValueItem* shared_mutex_test_0(ValueItem* args, uint32_t) {
+	bool shared = (bool)args[0];
+	size_t iterations = (size_t)args[1];
+	bool writer = (bool)args[2];
+	for (size_t i = 0; i < iterations; i++) {
+		if (writer && i % 100 == 0) {
+			if (shared) {
+				art::lock_guard guard(shared_mutex_test_rw);
+				Task::yield();
+			}
+			else {
+				art::lock_guard guard(shared_mutex_test_exclusive);
+				Task::yield();
+			}
+		}
+		else if (shared) {
+			shared_mutex_test_rw.lock_shared();
+			shared_mutex_test_reads++;
+			Task::yield();
+			shared_mutex_test_rw.unlock_shared();
+		}
+		else {
+			art::lock_guard guard(shared_mutex_test_exclusive);
+			shared_mutex_test_reads++;
+			Task::yield();
+		}
+	}
+	return nullptr;
+}
+//1 to 64 readers with one writer, reads hold lock across yield, TaskMutex serializes readers while TaskSharedMutex lets them overlap
+ValueItem* shared_mutex_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(shared_mutex_test_0, false, false);
+	const size_t total = 20000;
+	for (size_t readers = 1; readers <= 64; readers *= 2) {
+		for (bool shared : {false, true}) {
+			shared_mutex_test_reads = 0;
+			auto started = std::chrono::high_resolution_clock::now();
+			list_array<typed_lgr<Task>> tasks;
+			for (size_t i = 0; i < readers; i++)
+				tasks.push_back(new Task(func, ValueItem{ValueItem(shared), ValueItem(total / readers), ValueItem(false)}));
+			tasks.push_back(new Task(func, ValueItem{ValueItem(shared), ValueItem(total / readers), ValueItem(true)}));
+			Task::await_multiple(tasks);
+			uint64_t time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - started).count();
+			ValueItem msq(std::to_string(readers) + (shared ? " readers, shared_mutex: " : " readers, mutex: ") + std::to_string(time) + " us, reads: " + std::to_string(shared_mutex_test_reads.load()));
+			console::printLine(&msq, 1);
+		}
+	}
+	return nullptr;
+}
+
+ValueItem* priority_latency_test_low(ValueItem*, uint32_t) {
+	auto until = std::chrono::high_resolution_clock::now() + std::chrono::microseconds(200);
+	while (std::chrono::high_resolution_clock::now() < until);
+	return nullptr;
+}
+TaskMutex priority_latency_test_safety;
+std::vector<uint64_t> priority_latency_test_samples;
+ValueItem* priority_latency_test_high(ValueItem* args, uint32_t) {
+	uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+	art::lock_guard guard(priority_latency_test_safety);
+	priority_latency_test_samples.push_back(now - (uint64_t)args[0]);
+	return nullptr;
+}
+//flood of 200 us tasks saturates workers, latency of sparse tasks measured with same and with high priority
+ValueItem* priority_latency_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> low_func = new FuncEnvironment(priority_latency_test_low, true, false);
+	typed_lgr<FuncEnvironment> high_func = new FuncEnvironment(priority_latency_test_high, true, false);
+	ValueItem noting;
+	for (bool prioritized : {false, true}) {
+		priority_latency_test_samples.clear();
+		list_array<typed_lgr<Task>> low_tasks;
+		for (size_t i = 0; i < 50000; i++) {
+			low_tasks.push_back(make_lgr<Task>(low_func, noting));
+			low_tasks.back()->set_priority(prioritized ? TaskPriority::low : TaskPriority::avg);
+		}
+		Task::start(low_tasks);
+		list_array<typed_lgr<Task>> high_tasks;
+		for (size_t i = 0; i < 500; i++) {
+			uint64_t queued = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+			high_tasks.push_back(make_lgr<Task>(high_func, ValueItem(queued)));
+			high_tasks.back()->set_priority(prioritized ? TaskPriority::high : TaskPriority::avg);
+			Task::start(high_tasks.back());
+			Task::sleep(2);
+		}
+		Task::await_multiple(high_tasks, true);
+		Task::await_multiple(low_tasks, true);
+		std::sort(priority_latency_test_samples.begin(), priority_latency_test_samples.end());
+		size_t count = priority_latency_test_samples.size();
+		ValueItem msq(
+			std::string(prioritized ? "high priority" : "same priority")
+			+ " p50: " + std::to_string(priority_latency_test_samples[count / 2] / 1000) + " us"
+			+ ", p99: " + std::to_string(priority_latency_test_samples[count * 99 / 100] / 1000) + " us"
+		);
+		console::printLine(&msq, 1);
+	}
+	return nullptr;
+}
+
+ValueItem* blocking_compensation_test_io(ValueItem* args, uint32_t) {
+	if ((bool)args[0]) {
+		TaskBlockingRegion blocking;
+		art::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+	else
+		art::this_thread::sleep_for(std::chrono::milliseconds(200));
+	return nullptr;
+}
+//every worker stuck in 200 ms blocking call while 2000 short cpu tasks wait, with markers compensating workers take cpu tasks
+ValueItem* blocking_compensation_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> io_func = new FuncEnvironment(blocking_compensation_test_io, false, false);
+	typed_lgr<FuncEnvironment> cpu_func = new FuncEnvironment(priority_latency_test_low, false, false);
+	ValueItem noting;
+	size_t executors = Task::total_executors();
+	for (bool marked : {false, true}) {
+		list_array<typed_lgr<Task>> io_tasks;
+		for (size_t i = 0; i < executors; i++)
+			io_tasks.push_back(make_lgr<Task>(io_func, ValueItem(marked)));
+		Task::start(io_tasks);
+		auto started = std::chrono::high_resolution_clock::now();
+		list_array<typed_lgr<Task>> cpu_tasks;
+		for (size_t i = 0; i < 2000; i++)
+			cpu_tasks.push_back(make_lgr<Task>(cpu_func, noting));
+		Task::start(cpu_tasks);
+		Task::await_multiple(cpu_tasks, true);
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		Task::await_multiple(io_tasks, true);
+		ValueItem msq(std::string(marked ? "marked" : "unmarked") + " blocking, cpu tasks done in: " + std::to_string(time) + " ms");
+		console::printLine(&msq, 1);
+	}
+	return nullptr;
+}
+
+ValueItem* task_group_test_replica(ValueItem* args, uint32_t) {
+	size_t delay = (size_t)args[0];
+	for (size_t i = 0; i < delay; i += 10) {
+		Task::sleep(10);
+		Task::check_cancelation();
+	}
+	return new ValueItem(delay);
+}
+//scatter gather, one fast replica and 1000 slow, first_result returns fast one and cancels rest instead of waiting 2 sec
+ValueItem* task_group_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(task_group_test_replica, false, false);
+	auto started = std::chrono::high_resolution_clock::now();
+	TaskGroup group;
+	group.add(make_lgr<Task>(func, ValueItem((size_t)20)));
+	for (size_t i = 0; i < 1000; i++)
+		group.add(make_lgr<Task>(func, ValueItem((size_t)2000)));
+	ValueItem result = group.first_result();
+	uint64_t first_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+	group.wait_all();
+	uint64_t all_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+	ValueItem msq("task group first result: " + std::to_string((size_t)result) + " in " + std::to_string(first_time) + " ms, rest cancelled in: " + std::to_string(all_time) + " ms");
+	console::printLine(&msq, 1);
+	return nullptr;
+}
+
+ValueItem* native_task_group_test_job(ValueItem* args, uint32_t) {
+	size_t delay = (size_t)args[0];
+	art::this_thread::sleep_for(std::chrono::milliseconds(delay));
+	return new ValueItem(delay);
+}
+//native tasks finished by native worker must be accounted by group too, else wait_all never returns
+ValueItem* native_task_group_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(native_task_group_test_job, false, false);
+	TaskGroup group;
+	for (size_t i = 0; i < 4; i++)
+		group.add(Task::create_native_task(func, ValueItem((size_t)10)));
+	group.wait_all();
+	size_t sum = 0;
+	for (auto& result : group.results())
+		sum += (size_t)result;
+	ValueItem msq("native task group results sum: " + std::to_string(sum));
+	console::printLine(&msq, 1);
+	return nullptr;
+}
+
+ValueItem* symbol_call_bench_fn(ValueItem*, uint32_t) {
+	return nullptr;
+}
+//calls that jit code emits for reloadable symbol: old lookup by name, new symbol cell, and direct call of pinned symbol
+ValueItem* symbol_call_bench(ValueItem*, uint32_t) {
+	if (!FuncEnvironment::Exists("symbol_call_bench_reloadable")) {
+		FuncEnvironment::AddNative(symbol_call_bench_fn, "symbol_call_bench_reloadable", true);
+		FuncEnvironment::AddNative(symbol_call_bench_fn, "symbol_call_bench_pinned", false);
+	}
+	constexpr size_t calls = 1000000;
+	FuncSymbolCell* cell = FuncEnvironment::symbolCell("symbol_call_bench_reloadable");
+	typed_lgr<FuncEnvironment> pinned = FuncEnvironment::enviropment("symbol_call_bench_pinned");
+	auto measure = [](const char* name, auto&& call) {
+		auto started = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < calls; i++)
+			call();
+		uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		ValueItem msq(std::string(name) + ": " + std::to_string(time / calls) + " ns per call");
+		console::printLine(&msq, 1);
+	};
+	measure("reloadable by name", [] { FuncEnvironment::callFunc("symbol_call_bench_reloadable", nullptr, 0, false); });
+	measure("reloadable by cell", [cell] { FuncEnvironment::callCell(cell, nullptr, 0, false); });
+	measure("pinned", [&pinned] { pinned->syncWrapper(nullptr, 0); });
+	//cell follows hot path without recompiling callers
+	typed_lgr<FuncEnvironment> replacement = new FuncEnvironment(symbol_call_bench_fn, true);
+	FuncEnvironment::fastHotPath("symbol_call_bench_reloadable", replacement);
+	measure("reloadable by cell after hot path", [cell] { FuncEnvironment::callCell(cell, nullptr, 0, false); });
+	return nullptr;
+}
+
+std::atomic_size_t symbol_reload_stress_calls = 0;
+ValueItem* symbol_reload_stress_caller(ValueItem* args, uint32_t) {
+	FuncSymbolCell* cell = FuncEnvironment::symbolCell("symbol_reload_stress");
+	bool by_cell = (bool)args[0];
+	for (size_t i = 0; i < 100000; i++) {
+		if (by_cell)
+			FuncEnvironment::callCell(cell, nullptr, 0, false);
+		else
+			FuncEnvironment::callFunc("symbol_reload_stress", nullptr, 0, false);
+	}
+	symbol_reload_stress_calls += 100000;
+	return nullptr;
+}
+//every worker calls symbol while native thread hot paths it in loop, calls must never miss symbol or touch released function
+ValueItem* symbol_reload_stress(ValueItem*, uint32_t) {
+	if (!FuncEnvironment::Exists("symbol_reload_stress"))
+		FuncEnvironment::AddNative(symbol_call_bench_fn, "symbol_reload_stress", true);
+	typed_lgr<FuncEnvironment> caller = new FuncEnvironment(symbol_reload_stress_caller, false, false);
+	for (bool by_cell : {false, true}) {
+		symbol_reload_stress_calls = 0;
+		std::atomic_bool done = false;
+		std::atomic_size_t reloads = 0;
+		art::thread reloader([&done, &reloads] {
+			while (!done) {
+				typed_lgr<FuncEnvironment> replacement = new FuncEnvironment(symbol_call_bench_fn, true);
+				FuncEnvironment::fastHotPath("symbol_reload_stress", replacement);
+				reloads++;
+			}
+		});
+		auto started = std::chrono::high_resolution_clock::now();
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < Task::total_executors() * 4; i++)
+			tasks.push_back(make_lgr<Task>(caller, ValueItem(by_cell)));
+		Task::await_multiple(tasks);
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		done = true;
+		reloader.join();
+		ValueItem msq(std::string(by_cell ? "by cell" : "by name") + ": " + std::to_string(symbol_reload_stress_calls) + " calls with " + std::to_string(reloads) + " reloads in " + std::to_string(time) + " ms");
+		console::printLine(&msq, 1);
+	}
+	return nullptr;
+}
+
+//compiles every loaded symbol on background executor, prints warm up cost per function
+ValueItem* background_compile_test(ValueItem*, uint32_t) {
+	auto started = std::chrono::high_resolution_clock::now();
+	FuncEnvironment::enqueueCompileAll();
+	FuncEnvironment::awaitCompileQueue();
+	uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+	uint64_t total_ns = 0;
+	auto stats = FuncEnvironment::compileStats();
+	for (auto& stat : stats) {
+		total_ns += stat.compile_ns;
+		ValueItem msq(stat.symbol + ": " + std::to_string(stat.compile_ns / 1000) + " us" + (stat.in_background ? "" : " (on call)"));
+		console::printLine(&msq, 1);
+	}
+	ValueItem msq("compiled " + std::to_string(stats.size()) + " functions, compile time: " + std::to_string(total_ns / 1000000) + " ms, wall: " + std::to_string(time) + " ms");
+	console::printLine(&msq, 1);
+	return nullptr;
+}
+
+#include "run_time/asm/code_cache.hpp"
+//compiles same functions twice, second run should take code from persistent cache
+ValueItem* code_cache_test(ValueItem*, uint32_t) {
+	std::string directory = std::filesystem::temp_directory_path().string() + "/attacha_code_cache_test";
+	std::filesystem::remove_all(directory);
+	code_cache::set_directory(directory);
+	std::vector<std::vector<uint8_t>> codes;
+	for (uint16_t i = 0; i < 5000; i++) {
+		FuncEviroBuilder build;
+		for (uint16_t bit = 0; bit < 13; bit++) {
+			if (i & (1 << bit))
+				build.sum(ValueIndexPos{ bit }, ValueIndexPos{ uint16_t(bit + 1) });
+			else
+				build.sum(ValueIndexPos{ uint16_t(bit + 1) }, ValueIndexPos{ bit });
+		}
+		build.ret();
+		codes.push_back(build.O_build_func());
+	}
+	auto run = [&codes](const char* name) {
+		auto started = std::chrono::high_resolution_clock::now();
+		for (auto& code : codes)
+			typed_lgr<FuncEnvironment>(new FuncEnvironment(code))->preCompile();
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		code_cache::stats stats = code_cache::get_stats();
+		ValueItem msq(std::string(name) + ": " + std::to_string(time) + " ms, hits: " + std::to_string(stats.hits) + ", misses: " + std::to_string(stats.misses) + ", stored: " + std::to_string(stats.stored) + ", not relocatable: " + std::to_string(stats.not_relocatable) + ", invalidated: " + std::to_string(stats.invalidated) + ", store failed: " + std::to_string(stats.store_failed));
+		console::printLine(&msq, 1);
+	};
+	run("cold");
+	run("warm");
+	code_cache::set_directory("");
+	std::filesystem::remove_all(directory);
+	return nullptr;
+}
+
+//loop with one dynamic operation per iteration, runs 10 million iterations
+typed_lgr<FuncEnvironment> arithmetic_bench_fn(void(FuncEviroBuilder::*op)(ValueIndexPos, ValueIndexPos), const ValueItem& acc, const ValueItem& operand) {
+	FuncEviroBuilder build;
+	build.set_constant(0_env, int64_t(0));
+	build.set_constant(1_env, int64_t(10000000));
+	build.set_constant(2_env, int64_t(1));
+	build.set_constant(3_env, acc);
+	build.set_constant(4_env, operand);
+	build.bind_pos("loop");
+	(build.*op)(3_env, 4_env);
+	build.sum(0_env, 2_env);
+	build.compare(0_env, 1_env);
+	build.jump(JumpCondition::is_lower, "loop");
+	build.ret(3_env);
+	return build.O_prepare_func();
+}
+ValueItem* arithmetic_bench(ValueItem*, uint32_t) {
+	struct bench_case {
+		const char* name;
+		void(FuncEviroBuilder::*op)(ValueIndexPos, ValueIndexPos);
+		ValueItem acc;
+		ValueItem operand;
+	};
+	bench_case cases[] = {
+		{ "i64 sum", &FuncEviroBuilder::sum, int64_t(0), int64_t(3) },
+		{ "i64 minus", &FuncEviroBuilder::minus, int64_t(0), int64_t(3) },
+		{ "i64 mul", &FuncEviroBuilder::mul, int64_t(1), int64_t(3) },
+		{ "i64 div", &FuncEviroBuilder::div, int64_t(INT64_MAX), int64_t(1) },
+		{ "i32 sum", &FuncEviroBuilder::sum, int32_t(0), int32_t(3) },
+		{ "doub sum", &FuncEviroBuilder::sum, 0.0, 0.5 },
+		{ "doub mul", &FuncEviroBuilder::mul, 1.0, 1.0000001 },
+		{ "doub div", &FuncEviroBuilder::div, 1.0, 1.0000001 },
+		{ "i64 sum i32 (guard miss)", &FuncEviroBuilder::sum, int64_t(0), int32_t(3) },
+	};
+	for (auto& it : cases) {
+		typed_lgr<FuncEnvironment> fn = arithmetic_bench_fn(it.op, it.acc, it.operand);
+		fn->preCompile();
+		auto started = std::chrono::high_resolution_clock::now();
+		ValueItem* res = fn->syncWrapper(nullptr, 0);
+		uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		delete res;
+		ValueItem msq(std::string(it.name) + ": " + std::to_string(time / 1000000) + " ms, " + std::to_string(time / 10000000) + " ns per iteration");
+		console::printLine(&msq, 1);
+	}
+	return nullptr;
+}
+
 ValueItem* paralelize_test_1_0(ValueItem*, uint32_t) {
 	Task::sleep(1000);
 	return nullptr;
@@ -163,6 +629,193 @@ ValueItem* timeout_test(ValueItem*, uint32_t) {
 	return nullptr;
 }
 
+ValueItem* work_stealing_test_0_1(ValueItem*, uint32_t) {
+	return nullptr;
+}
+typed_lgr<FuncEnvironment> work_stealing_test_child = new FuncEnvironment(work_stealing_test_0_1, false, false);
+//children started from worker, so with work stealing they land in local queue
+ValueItem* work_stealing_test_0_0(ValueItem*, uint32_t) {
+	list_array<typed_lgr<Task>> tasks;
+	ValueItem noting;
+	for (size_t i = 0; i < 100; i++)
+		tasks.push_back(new Task(work_stealing_test_child, noting));
+	Task::await_multiple(tasks);
+	return nullptr;
+}
+ValueItem* work_stealing_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(work_stealing_test_0_0, false, false);
+	ValueItem noting;
+	bool old_mode = Task::enable_work_stealing;
+	for (bool stealing : {false, true}) {
+		Task::enable_work_stealing = stealing;
+		auto started = std::chrono::high_resolution_clock::now();
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < 1000; i++)
+			tasks.push_back(new Task(func, noting));
+		Task::await_multiple(tasks);
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		uint64_t per_second = 101000 * 1000 / (time ? time : 1);
+		ValueItem msq(std::string(stealing ? "local queues" : "global queue") + " tasks per second: " + std::to_string(per_second));
+		console::printLine(&msq, 1);
+	}
+	Task::enable_work_stealing = old_mode;
+	return nullptr;
+}
+
+TaskMutex affinity_test_mutex;
+TaskConditionVariable affinity_test_notifier;
+size_t affinity_test_turn = 0;
+ValueItem* affinity_test_0(ValueItem* args, uint32_t) {
+	size_t id = (size_t)args[0];
+	size_t players = (size_t)args[1];
+	MutexUnify unify(affinity_test_mutex);
+	art::unique_lock lock(unify);
+	for (size_t i = 0; i < 1000; i++) {
+		while (affinity_test_turn % players != id)
+			affinity_test_notifier.wait(lock);
+		affinity_test_turn++;
+		affinity_test_notifier.notify_all();
+	}
+	return nullptr;
+}
+//tasks pass turn through condition variable, with affinity woken task resumed on worker that ran it
+ValueItem* affinity_test(ValueItem*, uint32_t) {
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(affinity_test_0, false, false);
+	bool old_affinity = Task::enable_task_affinity;
+	const size_t players = 8;
+	for (bool affinity : {false, true}) {
+		Task::enable_task_affinity = affinity;
+		affinity_test_turn = 0;
+		auto started = std::chrono::high_resolution_clock::now();
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < players; i++)
+			tasks.push_back(new Task(func, ValueItem{ValueItem(i), ValueItem(players)}));
+		Task::await_multiple(tasks);
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		ValueItem msq(std::string(affinity ? "with" : "without") + " affinity, numa nodes: " + std::to_string(run_time::tasks::numa::nodes_count()) + ", 8000 turns: " + std::to_string(time) + " ms");
+		console::printLine(&msq, 1);
+	}
+	Task::enable_task_affinity = old_affinity;
+	return nullptr;
+}
+
+ValueItem* timer_wheel_test_0(ValueItem* args, uint32_t) {
+	Task::sleep((size_t)args[0]);
+	return nullptr;
+}
+//100k tasks sleeps from 1 to 1000 ms at same time, ideal time is 1000 ms
+ValueItem* timer_wheel_test(ValueItem*, uint32_t) {
+	auto started = std::chrono::high_resolution_clock::now();
+	list_array<typed_lgr<Task>> tasks;
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(timer_wheel_test_0, false, false);
+	for (size_t i = 0; i < 100000; i++)
+		tasks.push_back(new Task(func, ValueItem(i % 1000 + 1)));
+
+	Task::await_multiple(tasks);
+	uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+	ValueItem msq("100k sleeping tasks: " + std::to_string(time) + " ms, overhead: " + std::to_string((int64_t)time - 1000) + " ms");
+	console::printLine(&msq, 1);
+	return nullptr;
+}
+
+#include "run_time/library/chanel.hpp"
+const size_t chanel_test_messages = 250000;
+ValueItem* chanel_test_producer(ValueItem* args, uint32_t) {
+	chanel::Chanel* ch = (chanel::Chanel*)args[0].getSourcePtr();
+	ValueItem batch[64];
+	for (size_t i = 0; i < chanel_test_messages; i += 64) {
+		for (size_t j = 0; j < 64; j++)
+			batch[j] = ValueItem(i + j);
+		ch->notify(batch, 64);
+	}
+	return nullptr;
+}
+ValueItem* bounded_chanel_test_producer(ValueItem* args, uint32_t) {
+	chanel::BoundedChanel* ch = (chanel::BoundedChanel*)args[0].getSourcePtr();
+	ValueItem batch[64];
+	for (size_t i = 0; i < chanel_test_messages; i += 64) {
+		for (size_t j = 0; j < 64; j++)
+			batch[j] = ValueItem(i + j);
+		ch->notify(batch, 64);
+	}
+	return nullptr;
+}
+//4 producers and one consumer, messages sended in batches of 64
+ValueItem* chanel_test(ValueItem*, uint32_t) {
+	const size_t total = chanel_test_messages * 4;
+	{
+		typed_lgr<FuncEnvironment> func = new FuncEnvironment(chanel_test_producer, false, false);
+		chanel::Chanel ch;
+		typed_lgr<chanel::ChanelHandler> handle = ch.create_handle();
+		auto started = std::chrono::high_resolution_clock::now();
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < 4; i++)
+			tasks.push_back(new Task(func, ValueItem((void*)&ch, VType::undefined_ptr)));
+		Task::start(tasks);
+		for (size_t i = 0; i < total; i++)
+			handle->get();
+		Task::await_multiple(tasks);
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		ValueItem msq("chanel messages per second: " + std::to_string(total * 1000 / (time ? time : 1)));
+		console::printLine(&msq, 1);
+	}
+	{
+		typed_lgr<FuncEnvironment> func = new FuncEnvironment(bounded_chanel_test_producer, false, false);
+		chanel::BoundedChanel ch(4096);
+		auto started = std::chrono::high_resolution_clock::now();
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < 4; i++)
+			tasks.push_back(new Task(func, ValueItem((void*)&ch, VType::undefined_ptr)));
+		Task::start(tasks);
+		for (size_t i = 0; i < total;)
+			i += ch.get_many(256).size();
+		Task::await_multiple(tasks);
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		ValueItem msq("bounded chanel messages per second: " + std::to_string(total * 1000 / (time ? time : 1)));
+		console::printLine(&msq, 1);
+	}
+	return nullptr;
+}
+
+#include "run_time/tasks_util/native_workers_singleton.hpp"
+struct native_workers_test_manager : public NativeWorkerManager {
+	std::atomic_size_t completed = 0;
+	void handle(void* data, NativeWorkerHandle* overlapped, unsigned long dwBytesTransferred, bool status) override {
+		delete overlapped;
+		completed++;
+	}
+};
+//posted completions per second, IOCP on windows and io_uring on linux
+void native_workers_test() {
+	native_workers_test_manager manager;
+	auto started = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < 100000; i++)
+		NativeWorkersSingleton::post_work(new NativeWorkerHandle(&manager));
+	while (manager.completed != 100000)
+		art::this_thread::yield();
+	uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+	ValueItem msq("native completions per second: " + std::to_string(100000 * 1000 / (time ? time : 1)));
+	console::printLine(&msq, 1);
+}
+#ifndef _WIN64
+//deferred sqes without flush call, idle dispatchers must be woken and submit them
+void native_workers_deferred_submit_test() {
+	native_workers_test_manager manager;
+	io_uring_sqe sqe;
+	memset(&sqe, 0, sizeof(sqe));
+	sqe.opcode = IORING_OP_NOP;
+	for (size_t i = 0; i < 1000; i++) {
+		NativeWorkerHandle* handle = new NativeWorkerHandle(&manager);
+		NativeWorkersSingleton::submit(handle, handle, sqe, false);
+	}
+	auto deadline = std::chrono::high_resolution_clock::now() + std::chrono::seconds(5);
+	while (manager.completed != 1000 && std::chrono::high_resolution_clock::now() < deadline)
+		art::this_thread::yield();
+	ValueItem msq(manager.completed == 1000 ? "deferred submit completed without flush" : "deferred submit stalled, completed: " + std::to_string(manager.completed.load()));
+	console::printLine(&msq, 1);
+}
+#endif
+
 
 
 
@@ -432,6 +1085,48 @@ void test_stack(){
 	msq = light_stack::used_size();
 	console::printLine(&msq, 1);
 }
+//committed part of task stack must grow after deep use and drop after shrink
+ValueItem* stack_residency_test(ValueItem*, uint32_t) {
+	ValueItem msq("allocated: " + std::to_string(light_stack::allocated_size()) + ", free: " + std::to_string(light_stack::free_size()));
+	console::printLine(&msq, 1);
+	light_stack::prepare(4096 * 64);
+	msq = "after prepare allocated: " + std::to_string(light_stack::allocated_size());
+	console::printLine(&msq, 1);
+	light_stack::shrink_current();
+	msq = "after shrink allocated: " + std::to_string(light_stack::allocated_size());
+	console::printLine(&msq, 1);
+	light_stack::dump_current_out();
+	return nullptr;
+}
+ValueItem* stack_class_test_0(ValueItem*, uint32_t) {
+	Task::sleep(100);
+	return nullptr;
+}
+//suspended tasks with small stack hint, then same count with learned size
+ValueItem* stack_class_test(ValueItem*, uint32_t) {
+	const size_t count = 100000;
+	typed_lgr<FuncEnvironment> func = new FuncEnvironment(stack_class_test_0, true, false);
+	ValueItem noting;
+	for (size_t hint : {size_t(0), size_t(16384)}) {
+		func->setStackHint(hint);
+		auto started = std::chrono::high_resolution_clock::now();
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < count; i++)
+			tasks.push_back(make_lgr<Task>(func, noting));
+		Task::await_multiple(tasks);
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		ValueItem msq("stack hint " + std::to_string(hint) + ": " + std::to_string(time) + " ms, buffered stacks: " + std::to_string(light_stack::buffered_stacks()));
+		console::printLine(&msq, 1);
+	}
+	func->setStackHint(0);
+	light_stack::learn_stack_size = true;
+	typed_lgr<Task> learn_task = make_lgr<Task>(func, noting);
+	Task::await_task(learn_task);
+	ValueItem msq("learned high water: " + std::to_string(func->stackHighWater()) + ", class: " + std::to_string(light_stack::size_class(func->stackHighWater())));
+	console::printLine(&msq, 1);
+	light_stack::learn_stack_size = false;
+	return nullptr;
+}
 int mmain(){
 	ValueItem msq;
 	test_stack();
@@ -641,6 +1336,237 @@ int nmain(){
 	return 0;
 }
 
+ValueItem* network_echo_test_write_delayed(ValueItem* args, uint32_t argc) {
+	Structure& proxy = (Structure&)args[0];
+	while(!AttachA::Interface::makeCall(ClassAccess::pub, proxy, "is_closed")){
+		ValueItem readed = AttachA::Interface::makeCall(ClassAccess::pub, proxy, "read_available_ref");
+		if(!readed.meta.val_len)
+			break;
+		AttachA::Interface::makeCall(ClassAccess::pub, proxy, "write", readed);
+	}
+	return nullptr;
+}
+ValueItem* network_echo_test_blocking(ValueItem* args, uint32_t argc) {
+	Structure& proxy = (Structure&)args[0];
+	while(!AttachA::Interface::makeCall(ClassAccess::pub, proxy, "is_closed")){
+		ValueItem readed = AttachA::Interface::makeCall(ClassAccess::pub, proxy, "read", (uint32_t)64);
+		if(readed.meta.vtype == VType::noting)
+			break;
+		AttachA::Interface::makeCall(ClassAccess::pub, proxy, "write", readed);
+	}
+	return nullptr;
+}
+TaskMutex network_echo_test_mutex;
+std::vector<uint64_t> network_echo_test_latencies;
+//connects, makes 10 round trips by 64 bytes and closes
+ValueItem* network_echo_test_client(ValueItem* args, uint32_t argc) {
+	std::unique_ptr<TcpClientSocket> client(TcpClientSocket::connect(args[0]));
+	uint8_t message[64] = {0};
+	uint8_t answer[64];
+	std::vector<uint64_t> latencies;
+	for (size_t i = 0; i < 10; i++) {
+		auto started = std::chrono::high_resolution_clock::now();
+		if (!client->send(message, 64))
+			break;
+		int32_t received = 0;
+		while (received < 64) {
+			int32_t readed = client->recv(answer + received, 64 - received);
+			if (readed <= 0)
+				break;
+			received += readed;
+		}
+		latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - started).count());
+	}
+	client->close();
+	std::lock_guard lock(network_echo_test_mutex);
+	network_echo_test_latencies.insert(network_echo_test_latencies.end(), latencies.begin(), latencies.end());
+	return nullptr;
+}
+//loopback echo server, 1000 clients at once, prints connections per second and p99 round trip latency
+void network_echo_test() {
+	init_networking();
+	typed_lgr<FuncEnvironment> client = new FuncEnvironment(network_echo_test_client, false, false);
+	for (TcpNetworkServer::ManageType manage_type : {TcpNetworkServer::ManageType::write_delayed, TcpNetworkServer::ManageType::blocking}) {
+		bool blocking = manage_type == TcpNetworkServer::ManageType::blocking;
+		ValueItem address(blocking ? "127.0.0.1:40124" : "127.0.0.1:40123");
+		TcpNetworkServer server(new FuncEnvironment(blocking ? network_echo_test_blocking : network_echo_test_write_delayed, false, false), address, manage_type, 20);
+		server.start();
+		network_echo_test_latencies.clear();
+		auto started = std::chrono::high_resolution_clock::now();
+		list_array<typed_lgr<Task>> tasks;
+		for (size_t i = 0; i < 1000; i++)
+			tasks.push_back(new Task(client, address));
+		Task::await_multiple(tasks);
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		server.stop();
+		uint64_t p99 = 0;
+		if (!network_echo_test_latencies.empty()) {
+			std::sort(network_echo_test_latencies.begin(), network_echo_test_latencies.end());
+			p99 = network_echo_test_latencies[network_echo_test_latencies.size() * 99 / 100];
+		}
+		ValueItem msq(std::string(blocking ? "blocking" : "write_delayed") + " connections per second: " + std::to_string(1000 * 1000 / (time ? time : 1)) + ", p99 echo: " + std::to_string(p99) + " us");
+		console::printLine(&msq, 1);
+	}
+}
+
+std::atomic_uint64_t network_send_file_test_received = 0;
+ValueItem* network_send_file_test_sink(ValueItem* args, uint32_t argc) {
+	Structure& proxy = (Structure&)args[0];
+	while(!AttachA::Interface::makeCall(ClassAccess::pub, proxy, "is_closed")){
+		ValueItem readed = AttachA::Interface::makeCall(ClassAccess::pub, proxy, "read_available_ref");
+		if(!readed.meta.val_len)
+			break;
+		network_send_file_test_received += readed.meta.val_len;
+	}
+	return nullptr;
+}
+//64 MB file sended to loopback sink with send_file and with copy loop through user buffer
+ValueItem* network_send_file_test(ValueItem*, uint32_t) {
+	init_networking();
+	const uint64_t file_size = 64 * 1024 * 1024;
+	const char* path = "network_send_file_test.bin";
+	{
+		std::ofstream file(path, std::ios::binary);
+		std::vector<char> block(1024 * 1024, 'a');
+		for (uint64_t i = 0; i < file_size / block.size(); i++)
+			file.write(block.data(), block.size());
+	}
+	ValueItem address("127.0.0.1:40125");
+	TcpNetworkServer server(new FuncEnvironment(network_send_file_test_sink, false, false), address, TcpNetworkServer::ManageType::write_delayed, 20, 0, 65536);
+	server.start();
+	for (bool zero_copy : {false, true}) {
+		network_send_file_test_received = 0;
+		std::unique_ptr<TcpClientSocket> client(TcpClientSocket::connect(address));
+		auto started = std::chrono::high_resolution_clock::now();
+		if (zero_copy)
+			client->send_file(path, strlen(path), file_size, 0, 65536);
+		else {
+			std::ifstream file(path, std::ios::binary);
+			std::vector<char> chunk(65536);
+			for (uint64_t sended = 0; sended < file_size; sended += chunk.size()) {
+				file.read(chunk.data(), chunk.size());
+				client->send((uint8_t*)chunk.data(), (int32_t)chunk.size());
+			}
+		}
+		while (network_send_file_test_received < file_size)
+			Task::sleep(1);
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		client->close();
+		ValueItem msq(std::string(zero_copy ? "send_file" : "copy loop") + " bytes per second: " + std::to_string(file_size * 1000 / (time ? time : 1)));
+		console::printLine(&msq, 1);
+	}
+	server.stop();
+	std::remove(path);
+	return nullptr;
+}
+
+
+
+#include "run_time/cxx_library/files.hpp"
+ValueItem* file_io_test(ValueItem*, uint32_t) {
+	const uint32_t chunk_size = 1024 * 1024;
+	const uint32_t chunks = 64;
+	const char* path = "file_io_test.bin";
+	std::vector<uint8_t> chunk(chunk_size, 'a');
+	auto print_speed = [&](const char* name, std::chrono::high_resolution_clock::time_point started) {
+		uint64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count();
+		ValueItem msq(std::string(name) + " bytes per second: " + std::to_string((uint64_t)chunk_size * chunks * 1000 / (time ? time : 1)));
+		console::printLine(&msq, 1);
+	};
+	{
+		files::_sync_flags flags;
+		flags.value = 0;
+		flags.sequential_scan = true;
+		files::BlockingFileHandle file(path, strlen(path), files::open_mode::write, files::on_open_action::always_new, flags);
+		auto started = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < chunks; i++)
+			file.write(chunk.data(), chunk_size);
+		file.flush();
+		print_speed("blocking write", started);
+	}
+	{
+		files::_async_flags flags;
+		flags.value = 0;
+		flags.sequential_scan = true;
+		files::FileHandle file(path, strlen(path), files::open_mode::write, files::on_open_action::always_new, flags);
+		auto started = std::chrono::high_resolution_clock::now();
+		//all chunks in flight at once, worker threads stay free while kernel writes
+		std::vector<ValueItem> pending;
+		for (uint32_t i = 0; i < chunks; i++)
+			pending.push_back(file.write(chunk.data(), chunk_size));
+		for (auto& it : pending)
+			it.getAsync();
+		file.flush();
+		print_speed("async write", started);
+	}
+	{
+		files::_sync_flags flags;
+		flags.value = 0;
+		flags.sequential_scan = true;
+		files::BlockingFileHandle file(path, strlen(path), files::open_mode::read, files::on_open_action::open_exists, flags);
+		auto started = std::chrono::high_resolution_clock::now();
+		while (file.read(chunk.data(), chunk_size) > 0);
+		print_speed("blocking read", started);
+	}
+	{
+		files::_async_flags flags;
+		flags.value = 0;
+		flags.sequential_scan = true;
+		files::FileHandle file(path, strlen(path), files::open_mode::read, files::on_open_action::open_exists, flags);
+		auto started = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < chunks; i++)
+			file.read(chunk.data(), chunk_size);
+		print_speed("async read", started);
+	}
+	std::remove(path);
+	return nullptr;
+}
+
+
+ValueItem* mapped_file_test(ValueItem*, uint32_t) {
+	const uint32_t chunk_size = 1024 * 1024;
+	const uint32_t chunks = 64;
+	const char* path = "mapped_file_test.bin";
+	{
+		std::ofstream file(path, std::ios::binary);
+		std::vector<char> block(chunk_size, 'a');
+		for (uint32_t i = 0; i < chunks; i++)
+			file.write(block.data(), block.size());
+	}
+	uint64_t sum = 0;
+	{
+		files::_async_flags flags;
+		flags.value = 0;
+		flags.sequential_scan = true;
+		files::FileHandle file(path, strlen(path), files::open_mode::read, files::on_open_action::open_exists, flags);
+		auto started = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < chunks; i++) {
+			ValueItem item = file.read(chunk_size);
+			item.getAsync();
+			uint8_t* data = (uint8_t*)item.getSourcePtr();
+			for (uint32_t j = 0; j < item.meta.val_len; j++)
+				sum += data[j];
+		}
+		ValueItem msq("read scan: " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count()) + "ms");
+		console::printLine(&msq, 1);
+	}
+	{
+		typed_lgr<files::MappedFile> file(new files::MappedFile(path, strlen(path)));
+		auto started = std::chrono::high_resolution_clock::now();
+		file->advise(0, file->size(), files::MappedFile::access_hint::sequential);
+		for (uint32_t i = 0; i < chunks; i++) {
+			ValueItem item = files::MappedView::reference(files::MappedFile::view(file, (uint64_t)i * chunk_size, chunk_size));
+			uint8_t* data = (uint8_t*)item.getSourcePtr();
+			for (uint32_t j = 0; j < item.meta.val_len; j++)
+				sum -= data[j];
+		}
+		ValueItem msq("mapped scan: " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - started).count()) + "ms");
+		console::printLine(&msq, 1);
+	}
+	assert(sum == 0);
+	std::remove(path);
+	return nullptr;
+}
 
 
 void table_jump(){